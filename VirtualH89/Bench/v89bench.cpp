@@ -0,0 +1,957 @@
+/// \file v89bench.cpp
+///
+/// Microbenchmarks for the emulator's hot paths, run by "make bench".
+///
+/// Each benchmark does a fixed amount of work on fixed data, so runs can be compared
+/// from build to build; the best of several repetitions is reported, as ns per
+/// operation and millions of operations per second (MIPS, for the CPU benchmarks).
+/// The CPU benchmarks also report the guest clock rate reached, in MHz.
+///
+///     v89bench [-r <repetitions>] [<name prefix> ...]
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#include "AddressBus.h"
+#include "ClockUser.h"
+#include "GenericFloppyDrive.h"
+#include "GenericFloppyFormat.h"
+#include "H89.h"
+#include "HostFileBdos.h"
+#include "IOBus.h"
+#include "IODevice.h"
+#include "MemoryDecoder.h"
+#include "NetworkServer.h"
+#include "RawFloppyImage.h"
+#include "SectorFloppyImage.h"
+#include "SystemMemory8K.h"
+#include "WallClock.h"
+#include "h19.h"
+#include "logger.h"
+#include "z80.h"
+
+/// \cond
+#include <chrono>
+#include <map>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+/// \endcond
+
+using namespace std;
+
+// normally defined by main.cpp.
+H89         h89;
+Console*    console     = nullptr;
+FILE*       log_out     = 0;
+FILE*       console_out = 0;
+const char* getopts     = "";
+
+/// keeps the compiler from discarding the work being timed.
+static volatile unsigned long long sink;
+
+/// scratch directory for the disk images and host files.
+static string                      tmpDir;
+
+/// decoders register with the GPP for good, so they have to stay around.
+static vector<MemoryDecoder_ptr>   decoders;
+
+struct Benchmark
+{
+    const char*          name;
+    /// does the work, returns the number of operations, 0 on failure.
+    unsigned long long (*run)();
+    /// guest cycles of the last run, for the CPU benchmarks.
+    bool                 cpu;
+};
+
+static unsigned long long lastCycles;
+
+//
+// Z80 instruction dispatch, running loops of mostly one kind of instruction out of
+// RAM in the H89's ORG-0 layout.
+//
+
+static const BYTE aluProgram[] =
+{
+    0x31, 0x00, 0x80,       // 0000  LD SP,8000h
+    0x3e, 0x55,             // 0003  LD A,55h
+    0x0e, 0x34,             //       LD C,34h
+    0x16, 0x56,             //       LD D,56h
+    0x1e, 0x78,             //       LD E,78h
+    0x21, 0x00, 0x40,       //       LD HL,4000h
+    0x06, 0x10,             // 000e  LD B,10h
+    0x80,                   // 0010  ADD A,B
+    0x91,                   //       SUB C
+    0xa2,                   //       AND D
+    0xb3,                   //       OR E
+    0xac,                   //       XOR H
+    0xbd,                   //       CP L
+    0x3c,                   //       INC A
+    0xce, 0x12,             //       ADC A,12h
+    0x99,                   //       SBC A,C
+    0x86,                   //       ADD A,(HL)
+    0x07,                   //       RLCA
+    0x27,                   //       DAA
+    0x2f,                   //       CPL
+    0x23,                   //       INC HL
+    0xed, 0x52,             //       SBC HL,DE
+    0xcb, 0x11,             //       RL C
+    0xcb, 0x3a,             //       SRL D
+    0x10, 0xe9,             //       DJNZ 0010h
+    0xc3, 0x0e, 0x00        //       JP 000eh
+};
+
+static const BYTE blockProgram[] =
+{
+    0x31, 0x00, 0x80,       // 0000  LD SP,8000h
+    0x21, 0x00, 0x40,       // 0003  LD HL,4000h
+    0x11, 0x00, 0x60,       //       LD DE,6000h
+    0x01, 0x00, 0x01,       //       LD BC,0100h
+    0xed, 0xb0,             //       LDIR
+    0x21, 0xff, 0x40,       //       LD HL,40ffh
+    0x11, 0xff, 0x60,       //       LD DE,60ffh
+    0x01, 0x00, 0x01,       //       LD BC,0100h
+    0xed, 0xb8,             //       LDDR
+    0x21, 0x00, 0x40,       //       LD HL,4000h
+    0x01, 0x00, 0x01,       //       LD BC,0100h
+    0x3e, 0x77,             //       LD A,77h
+    0xed, 0xb1,             //       CPIR
+    0xc3, 0x03, 0x00        //       JP 0003h
+};
+
+static const BYTE indexProgram[] =
+{
+    0x31, 0x00, 0x80,       // 0000  LD SP,8000h
+    0xdd, 0x21, 0x00, 0x50, // 0003  LD IX,5000h
+    0xfd, 0x21, 0x00, 0x58, //       LD IY,5800h
+    0xdd, 0x7e, 0x05,       //       LD A,(IX+5)
+    0xfd, 0x86, 0x03,       //       ADD A,(IY+3)
+    0xdd, 0x77, 0x07,       //       LD (IX+7),A
+    0xfd, 0x34, 0x01,       //       INC (IY+1)
+    0xdd, 0xcb, 0x02, 0x5e, //       BIT 3,(IX+2)
+    0xfd, 0xcb, 0x04, 0xce, //       SET 1,(IY+4)
+    0xdd, 0x23,             //       INC IX
+    0xfd, 0x2b,             //       DEC IY
+    0xdd, 0xe5,             //       PUSH IX
+    0xfd, 0xe1,             //       POP IY
+    0xdd, 0x09,             //       ADD IX,BC
+    0xdd, 0x7e, 0xfe,       //       LD A,(IX-2)
+    0xc3, 0x03, 0x00        //       JP 0003h
+};
+
+static unsigned long long
+runZ80(const BYTE* program,
+       size_t      len)
+{
+    static const unsigned int chunk_c  = 50000;
+    static const unsigned int chunks_c = 20;
+
+    shared_ptr<SystemMemory8K> sysMem  = make_shared<SystemMemory8K>();
+    MemoryDecoder_ptr          decoder = MemoryDecoder::createMemoryDecoder("H89", sysMem,
+                                                                            MemoryLayout::Mem_64k);
+    decoders.push_back(decoder);
+
+    AddressBus                 ab(nullptr);
+    IOBus                      io;
+
+    ab.installMemory(decoder);
+    // ORG-0, RAM at 0.
+    GppListener::notifyListeners(0x20, 0x20);
+
+    for (size_t x = 0; x < len; ++x)
+    {
+        ab.writeByte(x, program[x]);
+    }
+
+    // never runs out of cycles within a chunk, so never waits for a timer tick.
+    Z80                cpu(&h89, 1000000000, 1);
+
+    cpu.setAddressBus(&ab);
+    cpu.setIOBus(&io);
+
+    unsigned long long start = WallClock::instance()->getClock();
+
+    for (unsigned int x = 0; x < chunks_c; ++x)
+    {
+        cpu.addClockTicks();
+        cpu.execute(chunk_c);
+    }
+
+    lastCycles = WallClock::instance()->getClock() - start;
+
+    return (unsigned long long) chunk_c * chunks_c;
+}
+
+static unsigned long long
+benchZ80Alu()
+{
+    return runZ80(aluProgram, sizeof(aluProgram));
+}
+
+static unsigned long long
+benchZ80Block()
+{
+    return runZ80(blockProgram, sizeof(blockProgram));
+}
+
+static unsigned long long
+benchZ80Index()
+{
+    return runZ80(indexProgram, sizeof(indexProgram));
+}
+
+//
+// Memory accesses through the AddressBus, as the CPU makes them, for each decoder.
+//
+
+static const unsigned long memOps_c = 4 * 1024 * 1024;
+
+static AddressBus*
+memoryBus(string type)
+{
+    static map<string, AddressBus*> buses;
+
+    if (buses.count(type) == 0)
+    {
+        MemoryDecoder_ptr decoder = MemoryDecoder::createMemoryDecoder(type,
+                                                                       make_shared<SystemMemory8K>(),
+                                                                       MemoryLayout::Mem_64k);
+        decoders.push_back(decoder);
+
+        buses[type] = new AddressBus(nullptr);
+        buses[type]->installMemory(decoder);
+    }
+
+    return buses[type];
+}
+
+static unsigned long long
+memoryRead(string type)
+{
+    AddressBus*        ab   = memoryBus(type);
+    WORD               addr = 0;
+    unsigned long long sum  = 0;
+
+    for (unsigned long x = 0; x < memOps_c; ++x)
+    {
+        sum  += ab->readByte(addr);
+        addr += 0x0107;
+    }
+
+    sink = sum;
+
+    return memOps_c;
+}
+
+static unsigned long long
+memoryWrite(string type)
+{
+    AddressBus* ab   = memoryBus(type);
+    WORD        addr = 0;
+
+    for (unsigned long x = 0; x < memOps_c; ++x)
+    {
+        ab->writeByte(addr, x);
+        addr += 0x0107;
+    }
+
+    return memOps_c;
+}
+
+static unsigned long long
+benchReadH88()
+{
+    return memoryRead("H88");
+}
+
+static unsigned long long
+benchWriteH88()
+{
+    return memoryWrite("H88");
+}
+
+static unsigned long long
+benchReadH89()
+{
+    return memoryRead("H89");
+}
+
+static unsigned long long
+benchWriteH89()
+{
+    return memoryWrite("H89");
+}
+
+static unsigned long long
+benchReadMMS77318()
+{
+    return memoryRead("MMS77318");
+}
+
+static unsigned long long
+benchWriteMMS77318()
+{
+    return memoryWrite("MMS77318");
+}
+
+//
+// IOBus dispatch, to a device's in()/out(), to its own handler, and to nothing.
+//
+
+class BenchDevice: public IODevice
+{
+  public:
+    BenchDevice(BYTE base,
+                bool handlers): IODevice(base, 2),
+                                handlers_m(handlers),
+                                val_m(0)
+    {
+
+    }
+
+    virtual BYTE in(BYTE addr) override
+    {
+        return val_m + addr;
+    }
+
+    virtual void out(BYTE addr,
+                     BYTE val) override
+    {
+        val_m = val;
+    }
+
+    virtual void getPortHandlers(BYTE               offset,
+                                 IOBus::InHandler&  in,
+                                 IOBus::OutHandler& out) override
+    {
+        IODevice::getPortHandlers(offset, in, out);
+
+        if (handlers_m)
+        {
+            in  = handlerIn;
+            out = handlerOut;
+        }
+    }
+
+    virtual void reset() override
+    {
+        val_m = 0;
+    }
+
+  private:
+    static BYTE handlerIn(IODevice* device,
+                          BYTE      addr)
+    {
+        return static_cast<BenchDevice*>(device)->val_m + addr;
+    }
+
+    static void handlerOut(IODevice* device,
+                           BYTE      addr,
+                           BYTE      val)
+    {
+        static_cast<BenchDevice*>(device)->val_m = val;
+    }
+
+    bool handlers_m;
+    BYTE val_m;
+};
+
+static const unsigned long ioOps_c = 8 * 1024 * 1024;
+
+static IOBus*
+ioBus()
+{
+    static IOBus* io = nullptr;
+
+    if (!io)
+    {
+        io = new IOBus();
+        io->addDevice(new BenchDevice(0xe0, false));
+        io->addDevice(new BenchDevice(0xe8, true));
+    }
+
+    return io;
+}
+
+static unsigned long long
+ioIn(BYTE port)
+{
+    IOBus*             io  = ioBus();
+    unsigned long long sum = 0;
+
+    for (unsigned long x = 0; x < ioOps_c; ++x)
+    {
+        sum += io->in(port + (x & 1));
+    }
+
+    sink = sum;
+
+    return ioOps_c;
+}
+
+static unsigned long long
+ioOut(BYTE port)
+{
+    IOBus* io = ioBus();
+
+    for (unsigned long x = 0; x < ioOps_c; ++x)
+    {
+        io->out(port + (x & 1), x);
+    }
+
+    return ioOps_c;
+}
+
+static unsigned long long
+benchIoInDevice()
+{
+    return ioIn(0xe0);
+}
+
+static unsigned long long
+benchIoOutDevice()
+{
+    return ioOut(0xe0);
+}
+
+static unsigned long long
+benchIoInHandler()
+{
+    return ioIn(0xe8);
+}
+
+static unsigned long long
+benchIoOutHandler()
+{
+    return ioOut(0xe8);
+}
+
+static unsigned long long
+benchIoInUnmapped()
+{
+    return ioIn(0xf0);
+}
+
+//
+// WallClock notifications, made after every instruction, to 1 and to 8 ClockUsers.
+//
+
+class BenchClockUser: public ClockUser
+{
+  public:
+    BenchClockUser(): cycles_m(0)
+    {
+
+    }
+
+    virtual void notification(unsigned int cycleCount) override
+    {
+        cycles_m += cycleCount;
+    }
+
+  private:
+    unsigned long long cycles_m;
+};
+
+static unsigned long long
+clockFanOut(unsigned int users)
+{
+    static const unsigned long clockOps_c = 4 * 1024 * 1024;
+
+    vector<unique_ptr<BenchClockUser> > clockUsers;
+
+    for (unsigned int x = 0; x < users; ++x)
+    {
+        clockUsers.push_back(unique_ptr<BenchClockUser>(new BenchClockUser()));
+    }
+
+    WallClock* clock = WallClock::instance();
+
+    for (unsigned long x = 0; x < clockOps_c; ++x)
+    {
+        clock->addTicks(4);
+    }
+
+    return clockOps_c;
+}
+
+static unsigned long long
+benchClock1()
+{
+    return clockFanOut(1);
+}
+
+static unsigned long long
+benchClock8()
+{
+    return clockFanOut(8);
+}
+
+//
+// H19 escape sequence parsing and screen updates, per character received.
+//
+
+static unsigned long long
+benchH19()
+{
+    static const unsigned int passes_c = 200;
+
+    string                    stream;
+
+    for (unsigned int line = 0; line < 48; ++line)
+    {
+        // position the cursor, erase to end of line, some reverse video.
+        stream += "\033Y";
+        stream += (char) (' ' + line % 24);
+        stream += (char) (' ' + line % 8);
+        stream += "\033K";
+        stream += "A>DIR B:\033pSTAT\033q  PIP     COM : ASM     COM : DDT     COM";
+
+        if (line % 12 == 11)
+        {
+            stream += "\033E";
+        }
+
+        stream += "\r\n";
+    }
+
+    unique_ptr<H19> h19(new H19());
+
+    for (unsigned int x = 0; x < passes_c; ++x)
+    {
+        for (size_t y = 0; y < stream.size(); ++y)
+        {
+            h19->receiveData(stream[y]);
+        }
+    }
+
+    return (unsigned long long) passes_c * stream.size();
+}
+
+//
+// Sector reads from floppy images, in order around each track of a 5.25" SS SD
+// disk, 10 sectors of 256 bytes.
+//
+
+static const int          numTracks_c  = 40;
+static const int          numSectors_c = 10;
+static const int          secSize_c    = 256;
+
+static GenericFloppyDrive*
+floppyDrive()
+{
+    static GenericFloppyDrive* drive = GenericFloppyDrive::getInstance("FDD_5_25_SS_ST");
+
+    return drive;
+}
+
+static string
+makeSectorImage()
+{
+    string            path = tmpDir + "/sector.img";
+    vector<BYTE>      image(numTracks_c * numSectors_c * secSize_c + 128, 0);
+    const char*       hdr  = "5m 256z 10p 1s 40t 0d 0i 0l\n";
+
+    for (size_t x = 0; x < image.size() - 128; ++x)
+    {
+        image[x] = x * 7;
+    }
+
+    memcpy(&image[image.size() - 128], hdr, strlen(hdr));
+
+    FILE* file = fopen(path.c_str(), "w");
+
+    if (file)
+    {
+        fwrite(&image[0], 1, image.size(), file);
+        fclose(file);
+    }
+
+    return path;
+}
+
+/// a raw track image: marks, ID fields and data fields, filled out with gap bytes.
+static string
+makeRawImage()
+{
+    string       path   = tmpDir + "/raw.img";
+    int          trkLen = floppyDrive()->getRawBytesPerTrack();
+    vector<BYTE> image;
+
+    for (int track = 0; track < numTracks_c; ++track)
+    {
+        vector<BYTE> trk;
+
+        trk.push_back(GenericFloppyFormat::INDEX_AM_BYTE);
+        trk.insert(trk.end(), 16, 0x4e);
+
+        for (int sector = 1; sector <= numSectors_c; ++sector)
+        {
+            BYTE id[] = {GenericFloppyFormat::ID_AM_BYTE, (BYTE) track, 0, (BYTE) sector, 1, 0, 0};
+
+            trk.insert(trk.end(), id, id + sizeof(id));
+            trk.insert(trk.end(), 11, 0x4e);
+            trk.push_back(GenericFloppyFormat::DATA_AM_BYTE);
+
+            for (int x = 0; x < secSize_c; ++x)
+            {
+                trk.push_back((x * 7) & 0x7f);
+            }
+
+            trk.insert(trk.end(), 2, 0);
+            trk.insert(trk.end(), 15, 0x4e);
+        }
+
+        trk.resize(trkLen, 0x4e);
+        image.insert(image.end(), trk.begin(), trk.end());
+    }
+
+    FILE* file = fopen(path.c_str(), "w");
+
+    if (file)
+    {
+        fwrite(&image[0], 1, image.size(), file);
+        fclose(file);
+    }
+
+    return path;
+}
+
+/// \retval number of sectors read, 0 if any couldn't be.
+static unsigned long long
+readSectors(GenericFloppyDisk* disk)
+{
+    static const unsigned int passes_c = 40;
+
+    unsigned long long        sum      = 0;
+
+    for (unsigned int pass = 0; pass < passes_c; ++pass)
+    {
+        for (int track = 0; track < numTracks_c; ++track)
+        {
+            for (int sector = 1; sector <= numSectors_c; ++sector)
+            {
+                int data  = 0;
+                int tries = 0;
+
+                // as a controller would, waiting for the sector to come round.
+                while (!(disk->readData(track, 0, sector, -1, data) &&
+                         data == GenericFloppyFormat::DATA_AM))
+                {
+                    if (++tries > numSectors_c)
+                    {
+                        return 0;
+                    }
+                }
+
+                for (int x = 0; x < secSize_c; ++x)
+                {
+                    disk->readData(track, 0, sector, x, data);
+                    sum += data;
+                }
+            }
+        }
+    }
+
+    sink = sum;
+
+    return (unsigned long long) passes_c * numTracks_c * numSectors_c;
+}
+
+static unsigned long long
+benchSectorImage()
+{
+    static shared_ptr<GenericFloppyDisk> disk;
+
+    if (!disk)
+    {
+        disk = make_shared<SectorFloppyImage>(floppyDrive(),
+                                              vector<string> {makeSectorImage()});
+    }
+
+    return disk->isReady() ? readSectors(disk.get()) : 0;
+}
+
+static unsigned long long
+benchRawImage()
+{
+    static shared_ptr<GenericFloppyDisk> disk;
+
+    if (!disk)
+    {
+        disk = make_shared<RawFloppyImage>(floppyDrive(), vector<string> {makeRawImage()});
+    }
+
+    return disk->isReady() ? readSectors(disk.get()) : 0;
+}
+
+//
+// HostFileBdos sequential reads, the CP/Net requests for a 64 record file, reread
+// from the start each time it's done.
+//
+
+enum
+{
+    bdosSelect = 14,
+    bdosOpen   = 15,
+    bdosClose  = 16,
+    bdosRead   = 20,
+    bdosWrite  = 21,
+    bdosCreate = 22
+};
+
+static int
+bdosCall(HostFileBdos* bdos,
+         BYTE*         msg,
+         BYTE          func)
+{
+    NetworkServer::ndos* hdr = (NetworkServer::ndos*) msg;
+
+    hdr->mcode = 0;
+    hdr->mfunc = func;
+    // user 0, then the FCB and any record.
+    msg[sizeof(*hdr)] = 0;
+
+    bdos->sendMsg(msg, sizeof(*hdr) + 1 + 36 + 128);
+
+    return msg[sizeof(*hdr)];
+}
+
+static unsigned long long
+benchReadSeq()
+{
+    static const unsigned int records_c = 64;
+    static const unsigned int passes_c  = 2000;
+
+    static HostFileBdos*      bdos = nullptr;
+    static BYTE               msg[sizeof(NetworkServer::ndos) + 1 + 36 + 128];
+    BYTE*                     fcb  = &msg[sizeof(NetworkServer::ndos) + 1];
+    BYTE*                     rec  = fcb + 36;
+
+    if (!bdos)
+    {
+        PropertyUtil::PropertyMapT props;
+
+        bdos   = new HostFileBdos(props, vector<string> {"HostFileBdos", tmpDir + "/bdos"}, 0, 1);
+        fcb[0] = 1; // A:
+        memcpy(&fcb[1], "BENCH   DAT", 11);
+
+        // user 0 is also drive A:
+        bdosCall(bdos, msg, bdosSelect);
+
+        if (bdosCall(bdos, msg, bdosCreate) != 0)
+        {
+            return 0;
+        }
+
+        for (unsigned int x = 0; x < records_c; ++x)
+        {
+            memset(rec, x, 128);
+            bdosCall(bdos, msg, bdosWrite);
+        }
+
+        bdosCall(bdos, msg, bdosClose);
+        memset(fcb + 12, 0, 24);
+
+        if (bdosCall(bdos, msg, bdosOpen) != 0)
+        {
+            return 0;
+        }
+    }
+
+    unsigned long long sum = 0;
+
+    for (unsigned int pass = 0; pass < passes_c; ++pass)
+    {
+        // back to the start, ext and cr.
+        fcb[12] = 0;
+        fcb[32] = 0;
+
+        for (unsigned int x = 0; x < records_c; ++x)
+        {
+            if (bdosCall(bdos, msg, bdosRead) != 0)
+            {
+                return 0;
+            }
+
+            sum += rec[x];
+        }
+    }
+
+    sink = sum;
+
+    return (unsigned long long) passes_c * records_c;
+}
+
+static const Benchmark benchmarks[] =
+{
+    {"z80.alu",          benchZ80Alu,        true},
+    {"z80.block",        benchZ80Block,      true},
+    {"z80.indexed",      benchZ80Index,      true},
+    {"mem.read.H88",     benchReadH88,       false},
+    {"mem.write.H88",    benchWriteH88,      false},
+    {"mem.read.H89",     benchReadH89,       false},
+    {"mem.write.H89",    benchWriteH89,      false},
+    {"mem.read.MMS77318", benchReadMMS77318, false},
+    {"mem.write.MMS77318", benchWriteMMS77318, false},
+    {"io.in.device",     benchIoInDevice,    false},
+    {"io.out.device",    benchIoOutDevice,   false},
+    {"io.in.handler",    benchIoInHandler,   false},
+    {"io.out.handler",   benchIoOutHandler,  false},
+    {"io.in.unmapped",   benchIoInUnmapped,  false},
+    {"clock.users.1",    benchClock1,        false},
+    {"clock.users.8",    benchClock8,        false},
+    {"h19.parse",        benchH19,           false},
+    {"floppy.sector",    benchSectorImage,   false},
+    {"floppy.raw",       benchRawImage,      false},
+    {"bdos.readseq",     benchReadSeq,       false},
+};
+
+static bool
+selected(const char*           name,
+         const vector<string>& prefixes)
+{
+    if (prefixes.empty())
+    {
+        return true;
+    }
+
+    for (const string& prefix : prefixes)
+    {
+        if (strncmp(name, prefix.c_str(), prefix.size()) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void
+removeTree(string path)
+{
+    string cmd = "rm -rf '" + path + "'";
+
+    if (system(cmd.c_str()) != 0)
+    {
+        fprintf(stderr, "unable to remove %s\n", path.c_str());
+    }
+}
+
+int
+main(int   argc,
+     char* argv[])
+{
+    int            reps = 3;
+    int            c;
+    vector<string> prefixes;
+
+    while ((c = getopt(argc, argv, "r:")) != EOF)
+    {
+        switch (c)
+        {
+            case 'r':
+                reps = atoi(optarg);
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-r <repetitions>] [<name prefix> ...]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    for (int x = optind; x < argc; ++x)
+    {
+        prefixes.push_back(argv[x]);
+    }
+
+    if (reps < 1)
+    {
+        reps = 1;
+    }
+
+    setDebugLevel();
+    log_out     = fopen("/dev/null", "w");
+    console_out = log_out;
+
+    char tmpl[] = "/tmp/v89bench.XXXXXX";
+
+    if (mkdtemp(tmpl) == nullptr)
+    {
+        fprintf(stderr, "unable to create a scratch directory\n");
+        return 1;
+    }
+
+    tmpDir = tmpl;
+
+    int failed = 0;
+
+    printf("%-20s %12s %10s %10s %10s\n", "benchmark", "ops", "ns/op", "MIPS", "MHz");
+
+    for (const Benchmark& bench : benchmarks)
+    {
+        if (!selected(bench.name, prefixes))
+        {
+            continue;
+        }
+
+        double             best   = 0.0;
+        unsigned long long ops    = 0;
+        unsigned long long cycles = 0;
+
+        for (int rep = 0; rep < reps; ++rep)
+        {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+            ops = bench.run();
+
+            double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            if (rep == 0 || secs < best)
+            {
+                best   = secs;
+                cycles = lastCycles;
+            }
+
+            if (ops == 0)
+            {
+                break;
+            }
+        }
+
+        if (ops == 0)
+        {
+            printf("%-20s %12s\n", bench.name, "failed");
+            ++failed;
+            continue;
+        }
+
+        double nsPerOp = best * 1e9 / ops;
+
+        printf("%-20s %12llu %10.2f %10.2f", bench.name, ops, nsPerOp, 1e3 / nsPerOp);
+
+        if (bench.cpu)
+        {
+            printf(" %10.2f", cycles / best / 1e6);
+        }
+        else
+        {
+            printf(" %10s", "-");
+        }
+
+        printf("\n");
+        fflush(stdout);
+    }
+
+    removeTree(tmpDir);
+    fflush(stdout);
+
+    // h89 was never built, its destructor can't run.
+    _exit(failed ? 1 : 0);
+}
@@ -55,6 +55,12 @@ AddressBus::installMemory(MemoryDecoder_ptr memory)
     mem_m = memory;
 }
 
+int
+AddressBus::getCurrentLayoutNum()
+{
+    return (mem_m != nullptr) ? mem_m->getCurrentLayoutNum() : 0;
+}
+
 void
 AddressBus::reset()
 {
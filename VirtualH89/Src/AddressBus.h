@@ -42,6 +42,9 @@ class AddressBus
     // setup memory
     void installMemory(std::shared_ptr<MemoryDecoder> mem);
 
+    /// number of the memory layout (bank) now mapped, 0 if there's only one.
+    int getCurrentLayoutNum();
+
     BYTE readByte(WORD addr,
                   bool interruptAck = false);
     void writeByte(WORD addr,
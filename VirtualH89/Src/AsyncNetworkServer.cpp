@@ -0,0 +1,201 @@
+/// \file AsyncNetworkServer.cpp
+///
+///  Runs a NetworkServer on its own thread, so slow host operations
+///  don't stop the CPU.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#include "AsyncNetworkServer.h"
+
+#include "logger.h"
+
+/// \cond
+#include <algorithm>
+#include <string.h>
+/// \endcond
+
+
+AsyncNetworkServer::AsyncNetworkServer(NetworkServer* server): server_m(server),
+                                                                thread_m(0),
+                                                                running_m(false),
+                                                                exit_m(false),
+                                                                inProgress_m(false),
+                                                                cancelled_m(false),
+                                                                numResponses_m(0)
+{
+    pthread_mutex_init(&mutex_m, nullptr);
+    pthread_cond_init(&cond_m, nullptr);
+
+    // signals are already blocked in main(), so the worker never sees SIGALRM.
+    running_m = (pthread_create(&thread_m, nullptr, threadFunc, this) == 0);
+
+    if (!running_m)
+    {
+        debugss(ssCPNetDevice, ERROR, "Unable to start server thread, running synchronously\n");
+    }
+}
+
+AsyncNetworkServer::~AsyncNetworkServer()
+{
+    if (running_m)
+    {
+        pthread_mutex_lock(&mutex_m);
+        exit_m = true;
+        pthread_cond_signal(&cond_m);
+        pthread_mutex_unlock(&mutex_m);
+        pthread_join(thread_m, nullptr);
+    }
+
+    pthread_cond_destroy(&cond_m);
+    pthread_mutex_destroy(&mutex_m);
+
+    delete server_m;
+}
+
+void*
+AsyncNetworkServer::threadFunc(void* arg)
+{
+    ((AsyncNetworkServer*) arg)->run();
+
+    return (nullptr);
+}
+
+int
+AsyncNetworkServer::sendMsg(uint8_t* msgbuf, int len)
+{
+    if (!running_m)
+    {
+        return server_m->sendMsg(msgbuf, len);
+    }
+
+    pthread_mutex_lock(&mutex_m);
+
+    bool ok = (requests_m.size() + (inProgress_m ? 1 : 0) + responses_m.size() < maxPending_c);
+
+    if (ok)
+    {
+        requests_m.push_back(std::string((const char*) msgbuf, len));
+        pthread_cond_signal(&cond_m);
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    if (!ok)
+    {
+        debugss(ssCPNetDevice, ERROR, "Too many requests outstanding\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+///
+/// Polled by CPNetDevice from the CPU thread, must not block.
+///
+int
+AsyncNetworkServer::checkRecvMsg(uint8_t clientId, uint8_t* msgbuf, int len)
+{
+    if (numResponses_m == 0)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&mutex_m);
+
+    std::string resp = responses_m.front();
+    responses_m.pop_front();
+    --numResponses_m;
+
+    pthread_mutex_unlock(&mutex_m);
+
+    if ((int) resp.length() > len)
+    {
+        resp.resize(len);
+    }
+
+    memcpy(msgbuf, resp.data(), resp.length());
+
+    return resp.length();
+}
+
+///
+/// Called on the CPU thread. The request in progress still runs, but its
+/// response is dropped with the others.
+///
+void
+AsyncNetworkServer::cancelMsgs()
+{
+    pthread_mutex_lock(&mutex_m);
+
+    requests_m.clear();
+    responses_m.clear();
+    numResponses_m = 0;
+    cancelled_m    = inProgress_m;
+
+    pthread_mutex_unlock(&mutex_m);
+}
+
+void
+AsyncNetworkServer::run()
+{
+    uint8_t                     msg[256 + ndosLen];
+    struct NetworkServer::ndos* hdr = (struct NetworkServer::ndos*) msg;
+
+    pthread_mutex_lock(&mutex_m);
+
+    while (true)
+    {
+        while (requests_m.empty() && !exit_m)
+        {
+            pthread_cond_wait(&cond_m, &mutex_m);
+        }
+
+        if (exit_m)
+        {
+            break;
+        }
+
+        std::string req = requests_m.front();
+
+        requests_m.pop_front();
+        inProgress_m = true;
+
+        pthread_mutex_unlock(&mutex_m);
+
+        memcpy(msg, req.data(), std::min(req.length(), sizeof(msg)));
+
+        int len = server_m->sendMsg(msg, req.length());
+
+        // build the response just as CPNetDevice does for synchronous servers.
+        if (len <= 0)
+        {
+            debugss(ssCPNetDevice, ERROR, "Unexpected failure in sendMsg()\n");
+            msg[ndosLen] = 0xff;
+            len          = 1;
+        }
+
+        uint8_t tmp = hdr->mdid;
+        hdr->mdid   = hdr->msid;
+        hdr->msid   = tmp;
+        hdr->mcode |= 0x01;
+        hdr->msize  = len - 1;
+
+        pthread_mutex_lock(&mutex_m);
+
+        inProgress_m = false;
+
+        if (cancelled_m)
+        {
+            cancelled_m = false;
+        }
+        else
+        {
+            responses_m.push_back(std::string((const char*) msg, ndosLen + len));
+            ++numResponses_m;
+        }
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+}
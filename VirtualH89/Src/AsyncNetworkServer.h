@@ -0,0 +1,66 @@
+/// \file AsyncNetworkServer.h
+///
+///  Runs a NetworkServer on its own thread, so slow host operations
+///  don't stop the CPU.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#ifndef ASYNCNETWORKSERVER_H_
+#define ASYNCNETWORKSERVER_H_
+
+#include "NetworkServer.h"
+
+/// \cond
+#include <atomic>
+#include <deque>
+#include <pthread.h>
+#include <string>
+/// \endcond
+
+///
+/// \class AsyncNetworkServer
+///
+/// \brief Adapter that executes another NetworkServer's requests on a worker thread.
+///
+/// sendMsg() queues the request and returns 0 (response pending). The requests
+/// are executed in order, and each response, including the CP/Net header, is
+/// returned by checkRecvMsg() once the wrapped server has finished it.
+///
+class AsyncNetworkServer: public NetworkServer
+{
+  public:
+    AsyncNetworkServer(NetworkServer* server);
+    virtual ~AsyncNetworkServer() override;
+
+    virtual int checkRecvMsg(uint8_t clientId, uint8_t* msgbuf, int len) override;
+    virtual int sendMsg(uint8_t* msgbuf, int len) override;
+    virtual void cancelMsgs() override;
+
+  private:
+    static void* threadFunc(void* arg);
+    void run();
+
+    static const int    ndosLen      = sizeof(struct NetworkServer::ndos);
+    static const size_t maxPending_c = 16;
+
+    NetworkServer*          server_m;
+    pthread_t               thread_m;
+    pthread_mutex_t         mutex_m;
+    pthread_cond_t          cond_m;
+    bool                    running_m;
+    bool                    exit_m;
+
+    /// requests not yet started by the worker.
+    std::deque<std::string> requests_m;
+    /// the worker is executing a request.
+    bool                    inProgress_m;
+    /// the request in progress was cancelled, its response is dropped.
+    bool                    cancelled_m;
+    /// complete responses, not yet collected.
+    std::deque<std::string> responses_m;
+    std::atomic_uint        numResponses_m;
+};
+
+#endif // ASYNCNETWORKSERVER_H_
@@ -0,0 +1,315 @@
+/// \file BlockCache.cpp
+///
+///  Write-back cache of fixed size blocks of a media file.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#include "BlockCache.h"
+
+#include "propertyutil.h"
+#include "logger.h"
+
+/// \cond
+#include <algorithm>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+/// \endcond
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+BlockCache::BlockCache(int           fd,
+                       off_t         start,
+                       size_t        blockSize,
+                       unsigned long numBlocks): fd_m(fd),
+                                                 start_m(start),
+                                                 blockSize_m(blockSize),
+                                                 numBlocks_m(numBlocks),
+                                                 slots_m(numSlots_c),
+                                                 data_m(numSlots_c * blockSize),
+                                                 useCount_m(0),
+                                                 nextBlock_m(0),
+                                                 numDirty_m(0),
+                                                 readBuf_m(readAhead_c * blockSize),
+                                                 hits_m(0),
+                                                 misses_m(0),
+                                                 reads_m(0),
+                                                 writes_m(0)
+{
+    for (int x = 0; x < numSlots_c; ++x)
+    {
+        slots_m[x].block   = 0;
+        slots_m[x].lastUse = 0;
+        slots_m[x].used    = false;
+        slots_m[x].dirty   = false;
+    }
+}
+
+BlockCache::~BlockCache()
+{
+    flush();
+}
+
+BYTE*
+BlockCache::slotData(int slot)
+{
+    return &data_m[slot * blockSize_m];
+}
+
+int
+BlockCache::findSlot(unsigned long block)
+{
+    std::unordered_map<unsigned long, int>::iterator it = index_m.find(block);
+
+    return (it == index_m.end()) ? -1 : it->second;
+}
+
+///
+/// Takes the least recently used slot, writing out the dirty blocks first
+/// if that is the only kind left.
+///
+int
+BlockCache::allocSlot(unsigned long block)
+{
+    int victim = -1;
+
+    for (int x = 0; x < numSlots_c; ++x)
+    {
+        if (!slots_m[x].used)
+        {
+            victim = x;
+            break;
+        }
+
+        if (!slots_m[x].dirty && (victim < 0 || slots_m[x].lastUse < slots_m[victim].lastUse))
+        {
+            victim = x;
+        }
+    }
+
+    if (victim < 0)
+    {
+        if (!flush())
+        {
+            return -1;
+        }
+
+        return allocSlot(block);
+    }
+
+    if (slots_m[victim].used)
+    {
+        index_m.erase(slots_m[victim].block);
+    }
+
+    slots_m[victim].block   = block;
+    slots_m[victim].lastUse = ++useCount_m;
+    slots_m[victim].used    = true;
+    slots_m[victim].dirty   = false;
+    index_m[block]          = victim;
+
+    return victim;
+}
+
+bool
+BlockCache::read(unsigned long block,
+                 BYTE*         buf,
+                 unsigned long count)
+{
+    if (block >= numBlocks_m)
+    {
+        return false;
+    }
+
+    bool sequential = (block == nextBlock_m);
+    int  slot       = findSlot(block);
+
+    nextBlock_m = block + 1;
+
+    if (slot >= 0)
+    {
+        ++hits_m;
+        slots_m[slot].lastUse = ++useCount_m;
+        memcpy(buf, slotData(slot), blockSize_m);
+        return true;
+    }
+
+    ++misses_m;
+
+    unsigned long num = std::max(count, sequential ? (unsigned long) readAhead_c : 1UL);
+
+    num = std::min(num, (unsigned long) readAhead_c);
+    num = std::min(num, numBlocks_m - block);
+
+    // stop short of anything already cached, it may be newer than the file.
+    for (unsigned long x = 1; x < num; ++x)
+    {
+        if (findSlot(block + x) >= 0)
+        {
+            num = x;
+            break;
+        }
+    }
+
+    ssize_t len;
+
+    do
+    {
+        len = pread(fd_m, &readBuf_m[0], num * blockSize_m, start_m + block * blockSize_m);
+    }
+    while (len < 0 && errno == EINTR);
+
+    ++reads_m;
+
+    if (len < (ssize_t) blockSize_m)
+    {
+        return false;
+    }
+
+    memcpy(buf, &readBuf_m[0], blockSize_m);
+
+    for (unsigned long x = 0; x < len / blockSize_m; ++x)
+    {
+        slot = allocSlot(block + x);
+
+        if (slot < 0)
+        {
+            break;
+        }
+
+        memcpy(slotData(slot), &readBuf_m[x * blockSize_m], blockSize_m);
+    }
+
+    return true;
+}
+
+bool
+BlockCache::write(unsigned long block,
+                  const BYTE*   buf)
+{
+    if (block >= numBlocks_m)
+    {
+        return false;
+    }
+
+    int slot = findSlot(block);
+
+    if (slot < 0)
+    {
+        slot = allocSlot(block);
+
+        if (slot < 0)
+        {
+            return false;
+        }
+    }
+
+    memcpy(slotData(slot), buf, blockSize_m);
+    slots_m[slot].lastUse = ++useCount_m;
+
+    if (!slots_m[slot].dirty)
+    {
+        slots_m[slot].dirty = true;
+        ++numDirty_m;
+    }
+
+    return true;
+}
+
+bool
+BlockCache::flush()
+{
+    if (numDirty_m == 0)
+    {
+        return true;
+    }
+
+    std::vector<std::pair<unsigned long, int> > dirty;
+
+    for (int x = 0; x < numSlots_c; ++x)
+    {
+        if (slots_m[x].dirty)
+        {
+            dirty.push_back(std::make_pair(slots_m[x].block, x));
+        }
+    }
+
+    std::sort(dirty.begin(), dirty.end());
+
+    bool   ok  = true;
+    size_t pos = 0;
+
+    while (pos < dirty.size())
+    {
+        std::vector<struct iovec> iov;
+        size_t                    end = pos;
+
+        do
+        {
+            struct iovec v;
+
+            v.iov_base = slotData(dirty[end].second);
+            v.iov_len  = blockSize_m;
+            iov.push_back(v);
+            ++end;
+        }
+        while (end < dirty.size() && dirty[end].first == dirty[end - 1].first + 1 &&
+               iov.size() < IOV_MAX);
+
+        ssize_t len;
+
+        do
+        {
+            len = pwritev(fd_m, &iov[0], iov.size(), start_m + dirty[pos].first * blockSize_m);
+        }
+        while (len < 0 && errno == EINTR);
+
+        ++writes_m;
+
+        if (len != (ssize_t) (iov.size() * blockSize_m))
+        {
+            debugss(ssGenericSASIDrive, ERROR, "Unable to write blocks %lu-%lu (%d)\n",
+                    dirty[pos].first, dirty[end - 1].first, errno);
+            ok = false;
+        }
+        else
+        {
+            for (size_t x = pos; x < end; ++x)
+            {
+                slots_m[dirty[x].second].dirty = false;
+                --numDirty_m;
+            }
+        }
+
+        pos = end;
+    }
+
+    return ok;
+}
+
+bool
+BlockCache::sync()
+{
+    bool ok = flush();
+
+    if (fdatasync(fd_m) < 0)
+    {
+        debugss(ssGenericSASIDrive, ERROR, "Unable to sync media (%d)\n", errno);
+        ok = false;
+    }
+
+    return ok;
+}
+
+std::string
+BlockCache::getStats()
+{
+    return PropertyUtil::sprintf("hits=%llu misses=%llu reads=%llu writes=%llu",
+                                 hits_m, misses_m, reads_m, writes_m);
+}
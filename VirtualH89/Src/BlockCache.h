@@ -0,0 +1,92 @@
+/// \file BlockCache.h
+///
+///  Write-back cache of fixed size blocks of a media file.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#ifndef BLOCKCACHE_H_
+#define BLOCKCACHE_H_
+
+#include "h89Types.h"
+
+/// \cond
+#include <sys/types.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+/// \endcond
+
+///
+/// \class BlockCache
+///
+/// \brief Caches the blocks of a hard disk image.
+///
+/// A miss on the block after the previous one read is taken as a sequential
+/// scan and reads readAhead_c blocks with a single pread(). Written blocks
+/// are held until flush(), which writes each run of adjacent dirty blocks
+/// with one pwritev().
+///
+class BlockCache
+{
+  public:
+    /// blocks start at offset start in fd, which stays owned by the caller.
+    BlockCache(int           fd,
+               off_t         start,
+               size_t        blockSize,
+               unsigned long numBlocks);
+    ~BlockCache();
+
+    BlockCache(const BlockCache&)            = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    /// count is how many blocks, starting with this one, the caller is
+    /// about to read.
+    bool read(unsigned long block,
+              BYTE*         buf,
+              unsigned long count = 1);
+    bool write(unsigned long block,
+               const BYTE*   buf);
+    /// writes all dirty blocks to the file.
+    bool flush();
+    /// flush(), then forces the file to the host disk.
+    bool sync();
+
+    std::string getStats();
+
+  private:
+    struct Slot
+    {
+        unsigned long block;
+        unsigned long lastUse;
+        bool          used;
+        bool          dirty;
+    };
+
+    int  findSlot(unsigned long block);
+    int  allocSlot(unsigned long block);
+    BYTE* slotData(int slot);
+
+    int                                fd_m;
+    off_t                              start_m;
+    size_t                             blockSize_m;
+    unsigned long                      numBlocks_m;
+    std::vector<Slot>                  slots_m;
+    std::vector<BYTE>                  data_m;
+    std::unordered_map<unsigned long, int> index_m;
+    unsigned long                      useCount_m;
+    unsigned long                      nextBlock_m;
+    int                                numDirty_m;
+    std::vector<BYTE>                  readBuf_m;
+
+    unsigned long long                 hits_m;
+    unsigned long long                 misses_m;
+    unsigned long long                 reads_m;
+    unsigned long long                 writes_m;
+
+    static const int                   numSlots_c  = 256;
+    static const int                   readAhead_c = 32;
+};
+
+#endif // BLOCKCACHE_H_
@@ -8,7 +8,12 @@
 
 #include "CPNetDevice.h"
 
+#include "AsyncNetworkServer.h"
 #include "HostFileBdos.h"
+#include "InputJournal.h"
+#include "SocketServer.h"
+#include "H89.h"
+#include "AddressBus.h"
 #include "logger.h"
 
 /// \cond
@@ -61,6 +66,17 @@
 ///     RZ              ; message OK
 ///     ; error case
 ///
+/// Optional DMA ports (cpnetdevice_dma = yes), the message moves
+/// in one step, at dmaCyclesPerByte:
+///     LXI H,msgbuf
+///     MOV A,L
+///     OUT dmaAddrPort ; address, low byte first
+///     MOV A,H
+///     OUT dmaAddrPort
+///     MVI A,01h       ; 01 = send msgbuf, 02 = receive into msgbuf
+///     OUT dmaCmdPort
+///     ; then check statusPort as above
+///
 /// For reference, standard CP/Net message header is:
 /// +0  format code (00 = CP/Net send, 01 = response)
 /// +1  dest node ID (server or this client, depending on direction)
@@ -71,14 +87,17 @@
 ///
 
 
-CPNetDevice::CPNetDevice(int base, int cid):
-    IODevice(base, 2),
+CPNetDevice::CPNetDevice(int base, int cid, bool dmaPorts):
+    IODevice(base, dmaPorts ? 4 : 2),
     clientId(cid),
     header((struct NetworkServer::ndos*) buffer),
     bufIx(0),
     msgLen(0),
     respLen(0),
-    initDev(false)
+    initDev(false),
+    dma(dmaPorts),
+    dmaAddr(0),
+    dmaAddrIx(0)
 {
 }
 
@@ -126,9 +145,13 @@ CPNetDevice::install_CPNetDevice(PropertyUtil::PropertyMapT& props)
             debugss(ssCPNetDevice, ERROR, "Invalid CP/Net client ID \"%s\"\n", s.c_str());
         }
     }
-    debugss(ssCPNetDevice, ERROR, "Creating CPNetDevice device at port %02x, client ID %02x\n",
-            port, cid);
-    CPNetDevice*                         cpnd = new CPNetDevice(port, cid);
+    // run servers on their own threads, the CPU keeps running while they work.
+    bool async = (props["cpnetdevice_async"] == "yes");
+    // block transfer ports, needs a matching SNIOS.
+    bool dma   = (props["cpnetdevice_dma"] == "yes");
+    debugss(ssCPNetDevice, ERROR, "Creating CPNetDevice device at port %02x, client ID %02x%s%s\n",
+            port, cid, async ? ", async" : "", dma ? ", dma" : "");
+    CPNetDevice*                         cpnd = new CPNetDevice(port, cid, dma);
     PropertyUtil::PropertyMapT::iterator it   = props.begin();
     for (; it != props.end(); ++it)
     {
@@ -155,13 +178,22 @@ CPNetDevice::install_CPNetDevice(PropertyUtil::PropertyMapT& props)
             if (args[0].compare("HostFileBdos") == 0)
             {
                 NetworkServer* nws = new HostFileBdos(props, args, sid, cid);
+                if (async)
+                {
+                    nws = new AsyncNetworkServer(nws);
+                }
                 cpnd->addServer(sid, nws);
             }
-
-//		} else if args[0].compare("Socket") == 0)
-//		{
-//			NetworkServer *nws = new SocketServer(props, args, sid, cid);
-//			cpnd->addServer(sid, nws);
+            else if (args[0].compare("Socket") == 0)
+            {
+                // already asynchronous.
+                NetworkServer* nws = new SocketServer(props, args, sid, cid);
+                cpnd->addServer(sid, nws);
+            }
+            else
+            {
+                debugss(ssCPNetDevice, ERROR, "Unknown server type %s\n", args[0].c_str());
+            }
         }
     }
 
@@ -171,10 +203,12 @@ CPNetDevice::install_CPNetDevice(PropertyUtil::PropertyMapT& props)
 void
 CPNetDevice::reset()
 {
-    initDev = false;
-    bufIx   = 0;
-    msgLen  = 0;
-    respLen = 0;
+    initDev   = false;
+    cancelMsgs();
+    bufIx     = 0;
+    msgLen    = 0;
+    respLen   = 0;
+    dmaAddrIx = 0;
 }
 
 BYTE
@@ -206,7 +240,7 @@ CPNetDevice::in(BYTE adr)
             return val;
         }
         // must be waiting for a response, check and see...
-        // Should never get here for synchronous server handlers (e.g. CPNetDevice).
+        // Should never get here for synchronous server handlers (e.g. HostFileBdos).
         int len = checkRecvMsg(clientId, buffer, sizeof(buffer));
         if (len > 0)
         {
@@ -273,6 +307,7 @@ CPNetDevice::out(BYTE adr, BYTE val)
     {
         // reset / resync. other functions needed?
         initDev = true; // send clientId on next input data port.
+        cancelMsgs();
         bufIx   = 0;
         msgLen  = 0;
         respLen = 0;
@@ -306,50 +341,7 @@ CPNetDevice::out(BYTE adr, BYTE val)
             buffer[bufIx++] = val;
             if (bufIx >= msgLen)
             {
-                // we have something to do...
-                debugss(ssCPNetDevice, INFO, "Command: %02x %02x %02x %02x %02x : %02x\n",
-                        buffer[0], buffer[1], buffer[2], buffer[3], buffer[4], buffer[5]);
-
-                if (header->mcode != 0)
-                {
-                    // We only handle CP/Net messages, but not sure how to indicate
-                    // an error to client for others...
-                    debugss(ssCPNetDevice, ERROR, "Not a CP/Net message\n");
-                    header->mcode |= 0x01;
-                    swapIds(header);
-                    buffer[5]      = 0xff;
-                    header->msize  = 1 - 1;
-                }
-                else
-                {
-                    int len = sendMsg(buffer, msgLen);
-
-                    if (len == 0)
-                    {
-                        // indicates async message sent - wait for recv later.
-                        // but currently we don't support that.
-                        bufIx  = 0;
-                        msgLen = 0;
-                        return;
-                    }
-                    else if (len < 0)
-                    {
-                        debugss(ssCPNetDevice, ERROR, "Unexpected failure in sendMsg()\n");
-                        // no response is coming, do something...
-                        header->mcode |= 0x01;
-                        swapIds(header);
-                        buffer[5]      = 0xff;
-                        header->msize  = 1 - 1;
-                    }
-                    header->msize  = len - 1;
-                    header->mcode |= 0x01;
-                    swapIds(header);
-                }
-                bufIx   = 0;
-                msgLen  = 0;
-                respLen = sizeof(*header) + header->msize + 1;
-                debugss(ssCPNetDevice, INFO, "Response: %02x %02x %02x %02x %02x : %02x\n",
-                        buffer[0], buffer[1], buffer[2], buffer[3], buffer[4], buffer[5]);
+                processMsg();
             }
             // don't do anything, just wait for receiver to execute command?
             return;
@@ -360,23 +352,199 @@ CPNetDevice::out(BYTE adr, BYTE val)
         msgLen = BUFFER_OVERRUN;
         return;
     }
+    if (dma && off == dmaAddrPortOffset)
+    {
+        if (dmaAddrIx == 0)
+        {
+            dmaAddr = (dmaAddr & 0xff00) | val;
+        }
+        else
+        {
+            dmaAddr = (dmaAddr & 0x00ff) | (val << 8);
+        }
+        dmaAddrIx ^= 1;
+        return;
+    }
+    if (dma && off == dmaCmdPortOffset)
+    {
+        dmaAddrIx = 0;
+        if (val == dmaCmd_Send)
+        {
+            dmaSend();
+        }
+        else if (val == dmaCmd_Recv)
+        {
+            dmaRecv();
+        }
+        else
+        {
+            debugss(ssCPNetDevice, ERROR, "Invalid DMA command %02x\n", val);
+        }
+        return;
+    }
     debugss(ssCPNetDevice, ERROR, "Invalid port address %02x\n", adr);
 }
 
+// buffer[] holds a complete message, run it and set up the response.
+void
+CPNetDevice::processMsg()
+{
+    // we have something to do...
+    debugss(ssCPNetDevice, INFO, "Command: %02x %02x %02x %02x %02x : %02x\n",
+            buffer[0], buffer[1], buffer[2], buffer[3], buffer[4], buffer[5]);
+
+    if (header->mcode != 0)
+    {
+        // We only handle CP/Net messages, but not sure how to indicate
+        // an error to client for others...
+        debugss(ssCPNetDevice, ERROR, "Not a CP/Net message\n");
+        header->mcode |= 0x01;
+        swapIds(header);
+        buffer[5]      = 0xff;
+        header->msize  = 1 - 1;
+    }
+    else
+    {
+        int len = sendMsg(buffer, msgLen);
+
+        if (len == 0)
+        {
+            // indicates async message sent - status port reports
+            // not ready until checkRecvMsg() has the response.
+            bufIx  = 0;
+            msgLen = 0;
+            return;
+        }
+        else if (len < 0)
+        {
+            debugss(ssCPNetDevice, ERROR, "Unexpected failure in sendMsg()\n");
+            // no response is coming, do something...
+            header->mcode |= 0x01;
+            swapIds(header);
+            buffer[5]      = 0xff;
+            header->msize  = 1 - 1;
+        }
+        else
+        {
+            header->msize  = len - 1;
+            header->mcode |= 0x01;
+            swapIds(header);
+        }
+    }
+    bufIx   = 0;
+    msgLen  = 0;
+    respLen = sizeof(*header) + header->msize + 1;
+    debugss(ssCPNetDevice, INFO, "Response: %02x %02x %02x %02x %02x : %02x\n",
+            buffer[0], buffer[1], buffer[2], buffer[3], buffer[4], buffer[5]);
+}
+
+// Copy a whole message from memory at dmaAddr, as if sent to the data port.
+void
+CPNetDevice::dmaSend()
+{
+    AddressBus& ab = h89.getAddressBus();
+
+    if (respLen > 0 || bufIx != 0)
+    {
+        // response not consumed, or a byte-wise message in progress.
+        msgLen = BUFFER_OVERRUN;
+        return;
+    }
+    for (bufIx = 0; bufIx < ndosLen; ++bufIx)
+    {
+        buffer[bufIx] = ab.readByte(dmaAddr + bufIx);
+    }
+    msgLen = ndosLen + header->msize + 1;
+    for (; bufIx < msgLen; ++bufIx)
+    {
+        buffer[bufIx] = ab.readByte(dmaAddr + bufIx);
+    }
+    h89.addWaitStates(msgLen * dmaCyclesPerByte);
+    processMsg();
+}
+
+// Copy the response to memory at dmaAddr, as if read from the data port.
+void
+CPNetDevice::dmaRecv()
+{
+    AddressBus& ab = h89.getAddressBus();
+
+    if (respLen <= 0)
+    {
+        // checkRecvMsg() is only done by the status port.
+        debugss(ssCPNetDevice, INFO, "DMA response underrun\n");
+        respLen = -1;
+        return;
+    }
+    for (int x = 0; x < respLen; ++x)
+    {
+        ab.writeByte(dmaAddr + x, buffer[x]);
+    }
+    h89.addWaitStates(respLen * dmaCyclesPerByte);
+    respLen = 0;
+    bufIx   = 0;
+}
+
+// Asynchronous servers return the complete response, header included.
 int
 CPNetDevice::checkRecvMsg(BYTE clientId, BYTE* msgbuf, int len)
 {
-    // TODO: interate over servers and call checkRecvMsg on each...
-    // server message should include these already? but clientId may not be
-    // known to servers.
-    //      header->mcode = 1; // CP/Net response
-    //      header->mdid = clientId;
-    //      header->msid = serverId;
-    //      header->mfunc = 0; // TODO: save last func? get from
-    //      header->msize = len - 1;
+    InputJournal* journal = InputJournal::active();
+    int           rlen    = 0;
+
+    if (journal && journal->replayResult(InputJournal::et_netRecv, msgbuf, len, rlen))
+    {
+        return rlen;
+    }
+    for (int x = 0; x < pending.size(); ++x)
+    {
+        rlen = pending[x]->checkRecvMsg(clientId, msgbuf, len);
+        if (rlen != 0)
+        {
+            pending.erase(pending.begin() + x);
+            if (journal)
+            {
+                journal->recordResult(InputJournal::et_netRecv, msgbuf, rlen);
+            }
+            return rlen;
+        }
+    }
     return 0;
 }
 
+// When replaying, the guest gets the recorded response, but the server still has
+// to run the request, so its open files and searches are right once the machine
+// goes live. Its own response is waited for and dropped.
+void
+CPNetDevice::replayMsg(NetworkServer* nws, BYTE* msgbuf, int len)
+{
+    if (nws->sendMsg(msgbuf, len) != 0)
+    {
+        return;
+    }
+    while (nws->checkRecvMsg(clientId, msgbuf, sizeof(buffer)) == 0)
+    {
+        usleep(100);
+    }
+}
+
+// the client gave up on its requests, responses still to come would be taken
+// as the replies to its next ones.
+void
+CPNetDevice::cancelMsgs()
+{
+    std::map<BYTE, NetworkServer*>::iterator it = servers.begin();
+
+    for (; it != servers.end(); ++it)
+    {
+        if (it->second != nullptr)
+        {
+            it->second->cancelMsgs();
+        }
+    }
+    pending.clear();
+}
+
 int
 CPNetDevice::sendMsg(BYTE* msgbuf, int len)
 {
@@ -391,5 +559,30 @@ CPNetDevice::sendMsg(BYTE* msgbuf, int len)
     }
     debugss(ssCPNetDevice, INFO, "Message: %02x %02x %02x %02x %02x : %02x\n",
             msgbuf[0], msgbuf[1], msgbuf[2], msgbuf[3], msgbuf[4], msgbuf[5]);
-    return nws->sendMsg(msgbuf, len);
+    // the response comes from the host, so it's part of the input journal.
+    InputJournal* journal = InputJournal::active();
+    BYTE*         resp    = msgbuf + sizeof(*hdr);
+    BYTE          request[sizeof(buffer)];
+    int           rc;
+
+    if (journal && journal->replaying())
+    {
+        memcpy(request, msgbuf, len);
+    }
+    if (journal && journal->replayResult(InputJournal::et_netSend, resp,
+                                         sizeof(buffer) - sizeof(*hdr), rc))
+    {
+        replayMsg(nws, request, len);
+        return rc;
+    }
+    rc = nws->sendMsg(msgbuf, len);
+    if (rc == 0)
+    {
+        pending.push_back(nws);
+    }
+    if (journal)
+    {
+        journal->recordResult(InputJournal::et_netSend, resp, rc);
+    }
+    return rc;
 }
@@ -16,7 +16,9 @@
 
 /// \cond
 #include <dirent.h>
+#include <map>
 #include <string>
+#include <vector>
 /// \endcond
 
 
@@ -24,7 +26,7 @@
 class CPNetDevice: public IODevice
 {
   public:
-    CPNetDevice(int base, int clientId);
+    CPNetDevice(int base, int clientId, bool dma = false);
     virtual ~CPNetDevice();
     static CPNetDevice* install_CPNetDevice(PropertyUtil::PropertyMapT& props);
 
@@ -37,16 +39,26 @@ class CPNetDevice: public IODevice
     void swapIds(struct NetworkServer::ndos* header);
     int sendMsg(BYTE* msgbuf, int len);
     int checkRecvMsg(BYTE clientId, BYTE* msgbuf, int len);
+    void cancelMsgs();
+    void replayMsg(NetworkServer* nws, BYTE* msgbuf, int len);
+    void processMsg();
+    void dmaSend();
+    void dmaRecv();
 
     static const int  ndosLen = sizeof(struct NetworkServer::ndos);
     BYTE              clientId;
     const char*       dir;
     BYTE              buffer[256 + ndosLen];
     struct            NetworkServer::ndos* header;
+    /// servers that still owe a response to an asynchronous request.
+    std::vector<NetworkServer*> pending;
     int               bufIx;
     int               msgLen;
     int               respLen;
     bool              initDev;
+    bool              dma;
+    WORD              dmaAddr;
+    int               dmaAddrIx;
 
     static const BYTE serverId         = 0;
 
@@ -54,6 +66,13 @@ class CPNetDevice: public IODevice
 
     static const int  dataPortOffset   = 0;
     static const int  statusPortOffset = 1;
+    static const int  dmaAddrPortOffset = 2;
+    static const int  dmaCmdPortOffset  = 3;
+
+    static const BYTE dmaCmd_Send       = 0x01;
+    static const BYTE dmaCmd_Recv       = 0x02;
+    /// burst mode, one memory and one internal cycle per byte.
+    static const int  dmaCyclesPerByte  = 4;
 
     static const BYTE sts_DataReady    = 0x01;
     static const BYTE sts_CmdOverrun   = 0x02;
@@ -11,12 +11,25 @@
 
 #include "WallClock.h"
 
-ClockUser::ClockUser()
+ClockUser::ClockUser(): ClockUser(false)
 {
-    WallClock::instance()->registerUser(this);
+
+}
+
+ClockUser::ClockUser(bool hostWork)
+{
+    if (hostWork)
+    {
+        WallClock::instance()->registerHostUser(this);
+    }
+    else
+    {
+        WallClock::instance()->registerUser(this);
+    }
 }
 
 ClockUser::~ClockUser()
 {
     WallClock::instance()->unregisterUser(this);
+    WallClock::instance()->unregisterHostUser(this);
 }
@@ -18,6 +18,11 @@ class ClockUser
 
     virtual void notification(unsigned int cycleCount) = 0;
 
+  protected:
+    /// with hostWork, notified only after WallClock::requestHostWork(), not on every
+    /// instruction.
+    explicit ClockUser(bool hostWork);
+
   private:
 
 };
@@ -9,6 +9,8 @@
 
 #include "DiskController.h"
 
+#include "GenericDiskDrive.h"
+
 /// \cond
 #include <sstream>
 /// \endcond
@@ -33,3 +35,17 @@ DiskController::getDriveName(int index)
     name << getDeviceName() << '-' << (index + 1);
     return name.str();
 }
+
+void
+DiskController::sync()
+{
+    std::vector<GenericDiskDrive*> drives = getDiskDrives();
+
+    for (int x = 0; x < drives.size(); ++x)
+    {
+        if (drives[x] != nullptr)
+        {
+            drives[x]->sync();
+        }
+    }
+}
@@ -60,6 +60,10 @@ class DiskController: public IODevice
 
     virtual std::string dumpDebug()             = 0;
 
+    // Flush modified media on all drives to the host files.
+    // Default calls sync() on each drive from getDiskDrives().
+    virtual void sync();
+
   protected:
 
   private:
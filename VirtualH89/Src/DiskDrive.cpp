@@ -86,6 +86,15 @@ DiskDrive::ejectDisk(const char* name)
     disk_m = nullptr;
 }
 
+void
+DiskDrive::sync()
+{
+    if (disk_m)
+    {
+        disk_m->sync();
+    }
+}
+
 void
 DiskDrive::loadHead()
 {
@@ -30,6 +30,7 @@ class DiskDrive
 
     virtual void insertDisk(std::shared_ptr<FloppyDisk> disk);
     virtual void ejectDisk(const char* name);
+    virtual void sync();
 
 
     virtual void getControlInfo(unsigned long pos,
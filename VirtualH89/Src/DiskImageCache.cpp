@@ -0,0 +1,278 @@
+/// \file DiskImageCache.cpp
+///
+///  On-disk cache of decoded soft-sectored disk images.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#include "DiskImageCache.h"
+
+#include "SectorArena.h"
+#include "SectorJournal.h"
+#include "Track.h"
+#include "Sector.h"
+#include "logger.h"
+
+/// \cond
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/stat.h>
+/// \endcond
+
+const char  DiskImageCache::magic_c[8] = {'V', 'H', '8', '9', 'I', 'M', 'C', '1'};
+
+std::string DiskImageCache::cacheDir_m;
+
+void
+DiskImageCache::setCacheDir(const std::string& dir)
+{
+    cacheDir_m = dir;
+
+    if (!dir.empty() && mkdir(dir.c_str(), 0755) < 0 && errno != EEXIST)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to create image cache %s (%d)\n", dir.c_str(), errno);
+        cacheDir_m.clear();
+    }
+}
+
+DiskImageCache::DiskImageCache(const std::string& imageName): hash_m(0),
+                                                              size_m(0)
+{
+    if (cacheDir_m.empty())
+    {
+        return;
+    }
+
+    int fd = open(imageName.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat st;
+    void*       image = MAP_FAILED;
+
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        image = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    close(fd);
+
+    if (image == MAP_FAILED)
+    {
+        return;
+    }
+
+    // FNV-1a, quick enough to be small next to decoding the image.
+    const BYTE* data = (const BYTE*) image;
+    uint64_t    hash = 0xcbf29ce484222325ULL;
+
+    for (off_t x = 0; x < st.st_size; ++x)
+    {
+        hash ^= data[x];
+        hash *= 0x100000001b3ULL;
+    }
+
+    munmap(image, st.st_size);
+
+    hash_m = hash;
+    size_m = st.st_size;
+
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.vhc", (unsigned long long) hash_m);
+    path_m = cacheDir_m + name;
+}
+
+DiskImageCache::~DiskImageCache()
+{
+
+}
+
+bool
+DiskImageCache::load(Geometry&                             geom,
+                     std::vector<std::shared_ptr<Track> >& tracks,
+                     std::vector<SourceRef>&               refs,
+                     SectorArena&                          arena)
+{
+    if (path_m.empty())
+    {
+        return false;
+    }
+
+    int fd = open(path_m.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    void*       entry = MAP_FAILED;
+
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(CacheHeader))
+    {
+        entry = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    close(fd);
+
+    if (entry == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const CacheHeader* hdr  = (const CacheHeader*) entry;
+    size_t             len  = st.st_size;
+    bool               good = (memcmp(hdr->magic, magic_c, sizeof(magic_c)) == 0 &&
+                               hdr->byteOrder == byteOrder_c &&
+                               hdr->sourceHash == hash_m && hdr->sourceSize == size_m &&
+                               sizeof(CacheHeader) + hdr->numTracks * sizeof(CacheTrack) +
+                               hdr->numSectors * sizeof(CacheSector) + hdr->dataLen == len);
+
+    const CacheTrack*  trks = (const CacheTrack*) (hdr + 1);
+    const CacheSector* secs = (const CacheSector*) (trks + (good ? hdr->numTracks : 0));
+    const BYTE*        data = (const BYTE*) (secs + (good ? hdr->numSectors : 0));
+
+    // written so the sums can't wrap around on a corrupt entry.
+    for (uint32_t x = 0; good && x < hdr->numTracks; ++x)
+    {
+        good = (trks[x].numSectors <= hdr->numSectors &&
+                trks[x].firstSector <= hdr->numSectors - trks[x].numSectors);
+    }
+
+    for (uint32_t x = 0; good && x < hdr->numSectors; ++x)
+    {
+        good = (secs[x].length <= hdr->dataLen &&
+                secs[x].dataOffset <= hdr->dataLen - secs[x].length);
+    }
+
+    if (!good)
+    {
+        debugss(ssFloppyDisk, WARNING, "Ignoring invalid cache entry %s\n", path_m.c_str());
+        munmap(entry, len);
+        return false;
+    }
+
+    geom.numSides      = hdr->numSides;
+    geom.numTracks     = hdr->numCylinders;
+    geom.doubleDensity = (hdr->doubleDensity != 0);
+
+    tracks.clear();
+    refs.clear();
+    arena.reserve(hdr->dataLen);
+
+    for (uint32_t x = 0; x < hdr->numTracks; ++x)
+    {
+        std::shared_ptr<Track> trk = std::make_shared<Track>(trks[x].head, trks[x].cylinder);
+        trk->setDensity((Track::Density) trks[x].density);
+        trk->setDataRate((Track::DataRate) trks[x].dataRate);
+
+        for (uint32_t y = trks[x].firstSector; y < trks[x].firstSector + trks[x].numSectors; ++y)
+        {
+            Sector sect(secs[y].head, secs[y].cylinder, secs[y].sector, secs[y].length,
+                        data + secs[y].dataOffset, arena);
+            sect.setDeletedDataAddressMark((secs[y].flags & 0x01) != 0);
+            sect.setReadError((secs[y].flags & 0x02) != 0);
+            trk->addSector(std::move(sect));
+            refs.push_back({secs[y].srcOffset, secs[y].srcLength});
+        }
+
+        tracks.push_back(trk);
+    }
+
+    munmap(entry, len);
+
+    debugss(ssFloppyDisk, INFO, "Loaded image from cache %s\n", path_m.c_str());
+
+    return true;
+}
+
+void
+DiskImageCache::store(const Geometry&                             geom,
+                      const std::vector<std::shared_ptr<Track> >& tracks,
+                      const std::vector<SourceRef>&               refs)
+{
+    if (path_m.empty())
+    {
+        return;
+    }
+
+    std::vector<CacheTrack>  trks;
+    std::vector<CacheSector> secs;
+    std::vector<BYTE>        data;
+
+    for (size_t x = 0; x < tracks.size(); ++x)
+    {
+        std::vector<Sector>& sectors = tracks[x]->getSectors();
+        CacheTrack           ct;
+
+        ct.head        = tracks[x]->getSideNumber();
+        ct.cylinder    = tracks[x]->getTrackNumber();
+        ct.density     = tracks[x]->getDensity();
+        ct.dataRate    = tracks[x]->getDataRate();
+        ct.firstSector = secs.size();
+        ct.numSectors  = sectors.size();
+        trks.push_back(ct);
+
+        for (size_t y = 0; y < sectors.size(); ++y)
+        {
+            CacheSector cs;
+            size_t      ix = secs.size();
+
+            cs.head       = sectors[y].getHeadNum();
+            cs.cylinder   = sectors[y].getTrackNum();
+            cs.sector     = sectors[y].getSectorNum();
+            cs.flags      = (sectors[y].getDeletedDataAddressMark() ? 0x01 : 0) |
+                            (sectors[y].getReadError() ? 0x02 : 0);
+            cs.length     = sectors[y].getSectorLength();
+            cs.dataOffset = data.size();
+            cs.srcOffset  = (ix < refs.size()) ? refs[ix].offset : 0;
+            cs.srcLength  = (ix < refs.size()) ? refs[ix].length : 0;
+            secs.push_back(cs);
+
+            data.insert(data.end(), sectors[y].getData(), sectors[y].getData() + cs.length);
+        }
+    }
+
+    CacheHeader hdr;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, magic_c, sizeof(magic_c));
+    hdr.byteOrder     = byteOrder_c;
+    hdr.numTracks     = trks.size();
+    hdr.numSectors    = secs.size();
+    hdr.dataLen       = data.size();
+    hdr.sourceHash    = hash_m;
+    hdr.sourceSize    = size_m;
+    hdr.numSides      = geom.numSides;
+    hdr.numCylinders  = geom.numTracks;
+    hdr.doubleDensity = geom.doubleDensity;
+
+    std::vector<BYTE> entry((BYTE*) &hdr, (BYTE*) (&hdr + 1));
+
+    if (!trks.empty())
+    {
+        entry.insert(entry.end(), (BYTE*) &trks[0], (BYTE*) (&trks[0] + trks.size()));
+    }
+
+    if (!secs.empty())
+    {
+        entry.insert(entry.end(), (BYTE*) &secs[0], (BYTE*) (&secs[0] + secs.size()));
+    }
+
+    entry.insert(entry.end(), data.begin(), data.end());
+
+    // never leave a partial entry for another instance to find.
+    if (SectorJournal::replaceFile(path_m, &entry[0], entry.size()))
+    {
+        debugss(ssFloppyDisk, INFO, "Saved %s\n", path_m.c_str());
+    }
+}
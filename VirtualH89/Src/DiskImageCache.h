@@ -0,0 +1,120 @@
+/// \file DiskImageCache.h
+///
+///  On-disk cache of decoded soft-sectored disk images.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#ifndef DISKIMAGECACHE_H_
+#define DISKIMAGECACHE_H_
+
+#include "h89Types.h"
+
+/// \cond
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+/// \endcond
+
+class SectorArena;
+class Track;
+
+///
+/// \class DiskImageCache
+///
+/// \brief Saves the decoded form of an IMD or TD0 image, so it doesn't have to
+/// be parsed (or decompressed) again.
+///
+/// Entries are named after a hash of the image file contents, so renamed or
+/// copied images still hit and modified ones never return stale data. Each
+/// entry is a flat file: header, track table, sector table, then the sector
+/// data, loaded with a single mmap. Entries are in host byte order.
+///
+/// Disabled unless a directory is given with the 'image_cache' property.
+///
+class DiskImageCache
+{
+  public:
+    /// disk-wide values that aren't part of the tracks.
+    struct Geometry
+    {
+        int  numSides;
+        int  numTracks;
+        bool doubleDensity;
+    };
+
+    /// where a sector came from in the image file, for formats that rewrite it.
+    struct SourceRef
+    {
+        unsigned long offset;
+        unsigned long length;
+    };
+
+    DiskImageCache(const std::string& imageName);
+    ~DiskImageCache();
+
+    /// fills in the decoded image, returning false on a miss. The sector data
+    /// goes into a single block of arena.
+    bool load(Geometry&                             geom,
+              std::vector<std::shared_ptr<Track> >& tracks,
+              std::vector<SourceRef>&               refs,
+              SectorArena&                          arena);
+    /// refs is either empty, or has one entry per sector in track order.
+    void store(const Geometry&                             geom,
+               const std::vector<std::shared_ptr<Track> >& tracks,
+               const std::vector<SourceRef>&               refs);
+
+    static void setCacheDir(const std::string& dir);
+
+  private:
+    struct CacheHeader
+    {
+        char     magic[8];
+        uint32_t byteOrder;
+        uint32_t numTracks;
+        uint32_t numSectors;
+        uint32_t dataLen;
+        uint64_t sourceHash;
+        uint64_t sourceSize;
+        uint8_t  numSides;
+        uint8_t  numCylinders;
+        uint8_t  doubleDensity;
+        uint8_t  pad[5];
+    };
+
+    struct CacheTrack
+    {
+        uint8_t  head;
+        uint8_t  cylinder;
+        uint8_t  density;
+        uint8_t  dataRate;
+        uint32_t firstSector;
+        uint32_t numSectors;
+    };
+
+    struct CacheSector
+    {
+        uint8_t  head;
+        uint8_t  cylinder;
+        uint8_t  sector;
+        uint8_t  flags;
+        uint32_t length;
+        uint32_t dataOffset;
+        uint32_t srcOffset;
+        uint32_t srcLength;
+    };
+
+    static const char        magic_c[8];
+    static const uint32_t    byteOrder_c = 0x01020304;
+
+    static std::string       cacheDir_m;
+
+    /// empty when caching is disabled or the image can't be read.
+    std::string              path_m;
+    uint64_t                 hash_m;
+    uint64_t                 size_m;
+};
+
+#endif // DISKIMAGECACHE_H_
@@ -45,7 +45,7 @@ DiskSide::addTrack(std::shared_ptr<Track> track)
     return true;
 }
 
-std::shared_ptr<Sector>
+Sector*
 DiskSide::findSector(BYTE trackNum, BYTE sectorNum)
 {
 
@@ -27,7 +27,7 @@ class DiskSide
     ~DiskSide();
 
     bool addTrack(std::shared_ptr<Track> track);
-    std::shared_ptr<Sector> findSector(BYTE trackNum, BYTE sectorNum);
+    Sector* findSector(BYTE trackNum, BYTE sectorNum);
 
   private:
     BYTE                                   sideNum_m;
@@ -38,6 +38,12 @@ FloppyDisk::checkWriteProtect(void)
     return (writeProtect_m);
 }
 
+void
+FloppyDisk::sync(void)
+{
+
+}
+
 void
 FloppyDisk::setMaxTrack(BYTE maxTrack)
 {
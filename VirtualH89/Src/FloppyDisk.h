@@ -45,6 +45,8 @@ class FloppyDisk
                                 BYTE& data) = 0;
 
     virtual void eject(const char* name)    = 0;
+    /// writes modified data back to the host, default does nothing.
+    virtual void sync(void);
 
     virtual void dump(void)                 = 0;
 
@@ -18,3 +18,14 @@ GenericDiskDrive::GenericDiskDrive()
 GenericDiskDrive::~GenericDiskDrive()
 {
 }
+
+void
+GenericDiskDrive::sync()
+{
+}
+
+std::shared_ptr<GenericFloppyDisk>
+GenericDiskDrive::getDisk()
+{
+    return nullptr;
+}
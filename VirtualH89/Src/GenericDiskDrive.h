@@ -39,6 +39,10 @@ class GenericDiskDrive
     virtual int getNumTracks()                                       = 0;
     virtual bool isReady()                                           = 0;
     virtual bool isWriteProtect()                                    = 0;
+    /// flush modified media data to the host, default does nothing.
+    virtual void sync();
+    /// the mounted media, default is none.
+    virtual std::shared_ptr<GenericFloppyDisk> getDisk();
 
   private:
 };
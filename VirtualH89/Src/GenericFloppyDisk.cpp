@@ -148,6 +148,11 @@ GenericFloppyDisk::getRealTrackNumber(BYTE track)
     return track;
 }
 
+void
+GenericFloppyDisk::sync()
+{
+
+}
 
 string
 GenericFloppyDisk::getMediaName()
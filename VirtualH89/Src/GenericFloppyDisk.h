@@ -66,6 +66,8 @@ class GenericFloppyDisk
 
     virtual bool isReady()                     = 0;
     virtual void eject(const std::string name) = 0;
+    /// write any modified data back to the image file, default does nothing.
+    virtual void sync();
     virtual void dump(void)                    = 0;
     virtual std::string getMediaName();
 
@@ -358,6 +358,21 @@ GenericFloppyDrive::getMediaName()
     return (disk_m != nullptr ? disk_m->getMediaName() : "");
 }
 
+shared_ptr<GenericFloppyDisk>
+GenericFloppyDrive::getDisk()
+{
+    return disk_m;
+}
+
+void
+GenericFloppyDrive::sync()
+{
+    if (disk_m != nullptr)
+    {
+        disk_m->sync();
+    }
+}
+
 void
 GenericFloppyDrive::startTrackFormat(BYTE trackNum)
 {
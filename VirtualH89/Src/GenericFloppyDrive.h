@@ -93,6 +93,8 @@ class GenericFloppyDrive: public GenericDiskDrive, public ClockUser
     bool isWriteProtect() override;
 
     std::string getMediaName() override;
+    void sync() override;
+    std::shared_ptr<GenericFloppyDisk> getDisk() override;
 
     void startTrackFormat(BYTE trackNum);
 
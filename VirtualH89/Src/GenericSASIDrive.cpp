@@ -18,6 +18,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <errno.h>
 /// \endcond
 
@@ -131,9 +132,12 @@ GenericSASIDrive::checkHeader(BYTE* buf, int n)
 GenericSASIDrive::GenericSASIDrive(DriveType   type,
                                    std::string media,
                                    int         cnum,
-                                   int         sectorSize):
+                                   int         sectorSize,
+                                   std::string delta,
+                                   SyncPolicy  policy):
     curState(IDLE),
     driveFd(-1),
+    syncPolicy(policy),
     driveSecLen(0),
     sectorsPerTrack(0),
     capacity(0),
@@ -185,7 +189,23 @@ GenericSASIDrive::GenericSASIDrive(DriveType   type,
     dataBuf    = new BYTE[sectorSize + 4]; // space for ECC for "long" commands
     dataLength = sectorSize;
 
-    driveFd    = open(driveMedia, O_RDWR | O_CREAT, 0666);
+    if (!delta.empty())
+    {
+        // the media file is shared, and only read.
+        driveOverlay.reset(new OverlayImage(driveMedia, delta));
+
+        if (!driveOverlay->isOpen())
+        {
+            driveOverlay.reset();
+            return;
+        }
+
+        driveFd = open(driveMedia, O_RDONLY);
+    }
+    else
+    {
+        driveFd = open(driveMedia, O_RDWR | O_CREAT, 0666);
+    }
 
     if (driveFd < 0)
     {
@@ -198,7 +218,15 @@ GenericSASIDrive::GenericSASIDrive(DriveType   type,
     off_t end = lseek(driveFd, (off_t) 0, SEEK_END);
 
     // special case: 0 (EOF) means new media - initialize it.
-    if (end == 0)
+    if (end == 0 && driveOverlay)
+    {
+        debugss(ssMMS77320, ERROR, "No media to overlay: %s\n", driveMedia);
+        close(driveFd);
+        driveFd = -1;
+        driveOverlay.reset();
+        return;
+    }
+    else if (end == 0)
     {
         mediaCyl  = params[type][0];
         mediaHead = params[type][1];
@@ -217,14 +245,12 @@ GenericSASIDrive::GenericSASIDrive(DriveType   type,
     else
     {
         // first, trying reading the last 128 bytes...
-        lseek(driveFd, end - sizeof(buf), SEEK_SET);
-        ssize_t x    = read(driveFd, buf, sizeof(buf));
+        ssize_t x    = readMedia(buf, sizeof(buf), end - sizeof(buf));
         bool    done = (x == sizeof(buf) && checkHeader(buf, sizeof(buf)));
 
         if (!done)
         {
-            lseek(driveFd, (off_t) 0, SEEK_SET);
-            x          = read(driveFd, buf, sizeof(buf));
+            x          = readMedia(buf, sizeof(buf), 0);
             done       = (x == sizeof(buf) && checkHeader(buf, sizeof(buf)));
             dataOffset = mediaSsz;
         }
@@ -234,6 +260,7 @@ GenericSASIDrive::GenericSASIDrive(DriveType   type,
             debugss(ssMMS77320, ERROR, "Bad media header: %s\n", driveMedia);
             close(driveFd);
             driveFd = -1;
+            driveOverlay.reset();
             return;
         }
 
@@ -244,19 +271,46 @@ GenericSASIDrive::GenericSASIDrive(DriveType   type,
             debugss(ssMMS77320, ERROR, "Media/Drive mismatch: %s\n", driveMedia);
             close(driveFd);
             driveFd = -1;
+            driveOverlay.reset();
             return;
         }
 
-        debugss(ssMMS77320, ERROR, "Mounted existing media %s as %s", driveMedia, buf);
+        debugss(ssMMS77320, ERROR, "Mounted existing media %s%s as %s", driveMedia,
+                driveOverlay ? " (cow)" : "", buf);
+    }
+
+    if (!driveOverlay)
+    {
+        driveCache.reset(new BlockCache(driveFd, dataOffset, driveSecLen,
+                                        capacity / driveSecLen));
     }
 }
 
 GenericSASIDrive*
-GenericSASIDrive::getInstance(std::string type,
-                              std::string media,
-                              int         cnum)
+GenericSASIDrive::getInstance(std::vector<std::string> argv,
+                              std::string              media,
+                              int                      cnum)
 {
-    DriveType etype;
+    DriveType   etype;
+    std::string type = argv.size() > 0 ? argv[0] : "";
+    std::string delta;
+    SyncPolicy  policy = syncNone;
+
+    for (int x = 1; x < argv.size(); ++x)
+    {
+        if (argv[x].compare("fsync=none") == 0)
+        {
+            policy = syncNone;
+        }
+        else if (argv[x].compare("fsync=command") == 0)
+        {
+            policy = syncCommand;
+        }
+        else if (!OverlayImage::isOverlayArg(argv[x], delta))
+        {
+            debugss(ssMMS77320, WARNING, "unrecognized option - %s\n", argv[x].c_str());
+        }
+    }
 
     if (type.compare("XEBEC_ST506") == 0)
     {
@@ -320,7 +374,7 @@ GenericSASIDrive::getInstance(std::string type,
 //  =   612 trk. (~16 spt, 512B ea, ?)
     // ssz = jumper_W2 ? 512 : 256; // XEBEC jumper "W2" a.k.a. "SS" pos "2" or "5"
     int ssz = 512;
-    return new GenericSASIDrive(etype, media, cnum, ssz);
+    return new GenericSASIDrive(etype, media, cnum, ssz, delta, policy);
 }
 
 GenericSASIDrive::~GenericSASIDrive()
@@ -330,10 +384,103 @@ GenericSASIDrive::~GenericSASIDrive()
         return;
     }
 
+    if (driveCache)
+    {
+        driveCache->flush();
+        debugss(ssGenericSASIDrive, INFO, "%s: %s\n", driveMedia, driveCache->getStats().c_str());
+        driveCache.reset();
+    }
+
     close(driveFd);
     driveFd = -1;
 }
 
+void
+GenericSASIDrive::sync()
+{
+    if (driveOverlay)
+    {
+        driveOverlay->sync();
+    }
+    else if (driveCache)
+    {
+        driveCache->sync();
+    }
+}
+
+bool
+GenericSASIDrive::readBlock(unsigned long block,
+                            unsigned long count)
+{
+    if (driveCache)
+    {
+        return driveCache->read(block, dataBuf, count);
+    }
+
+    return (readMedia(dataBuf, driveSecLen, block * driveSecLen + dataOffset) == driveSecLen);
+}
+
+bool
+GenericSASIDrive::writeBlock(unsigned long block)
+{
+    if (driveCache)
+    {
+        return driveCache->write(block, dataBuf);
+    }
+
+    return (writeMedia(dataBuf, driveSecLen, block * driveSecLen + dataOffset) == driveSecLen);
+}
+
+///
+/// The blocks of a write command are written together, once it is done.
+///
+bool
+GenericSASIDrive::endWrite()
+{
+    if (driveCache)
+    {
+        return (syncPolicy == syncCommand) ? driveCache->sync() : driveCache->flush();
+    }
+
+    if (driveOverlay && syncPolicy == syncCommand)
+    {
+        driveOverlay->sync();
+    }
+
+    return true;
+}
+
+ssize_t
+GenericSASIDrive::readMedia(BYTE*  buf,
+                            size_t len,
+                            off_t  off)
+{
+    if (driveOverlay)
+    {
+        return driveOverlay->pread(buf, len, off);
+    }
+
+    return pread(driveFd, buf, len, off);
+}
+
+ssize_t
+GenericSASIDrive::writeMedia(const BYTE* buf,
+                             size_t      len,
+                             off_t       off)
+{
+    if (driveOverlay)
+    {
+        ssize_t num = driveOverlay->pwrite(buf, len, off);
+
+        // as current as writing the media directly would be.
+        driveOverlay->flush();
+
+        return num;
+    }
+
+    return pwrite(driveFd, buf, len, off);
+}
+
 
 /*
    Typical sequence:
@@ -647,7 +794,6 @@ GenericSASIDrive::processCmd(BYTE& dataIn,
                              BYTE& ctrl)
 {
     off_t off;
-    long  e;
 
     if (cmdBuf[0] != cmd_ReqSense_c)
     {
@@ -696,10 +842,7 @@ GenericSASIDrive::processCmd(BYTE& dataIn,
                 break;
             }
 
-            lseek(driveFd, off + dataOffset, SEEK_SET);
-            e = read(driveFd, dataBuf, dataLength);
-
-            if (e != dataLength)
+            if (!readBlock(off / driveSecLen, std::max(cmdBuf[4] - blockCount, 1)))
             {
                 startError(ctrl, 0x94); // target sector not found + addr valid
                 ack(dataIn, dataOut, ctrl);
@@ -811,7 +954,6 @@ GenericSASIDrive::processData(BYTE& dataIn,
                               BYTE& ctrl)
 {
     off_t off;
-    long  e;
 
     switch (cmdBuf[0])
     {
@@ -826,11 +968,9 @@ GenericSASIDrive::processData(BYTE& dataIn,
                 break;
             }
 
-            lseek(driveFd, off + dataOffset, SEEK_SET);
-            e = write(driveFd, dataBuf, dataLength);
-
-            if (e != dataLength)
+            if (!writeBlock(off / driveSecLen))
             {
+                endWrite();
                 startError(ctrl, 0x94); // target sector not found + addr valid
                 ack(dataIn, dataOut, ctrl);
                 break;
@@ -838,6 +978,13 @@ GenericSASIDrive::processData(BYTE& dataIn,
 
             if (++blockCount >= cmdBuf[4])
             {
+                if (!endWrite())
+                {
+                    startError(ctrl, 0x94); // target sector not found + addr valid
+                    ack(dataIn, dataOut, ctrl);
+                    break;
+                }
+
                 startStatus(ctrl);
                 break;
             }
@@ -11,12 +11,16 @@
 #define GENERICSASIDRIVE_H_
 
 #include "GenericDiskDrive.h"
+#include "BlockCache.h"
+#include "OverlayImage.h"
 
 #include "h89Types.h"
 
 
 /// \cond
 #include <memory>
+#include <string>
+#include <vector>
 /// \endcond
 
 class GenericFloppyDisk;
@@ -47,14 +51,25 @@ class GenericSASIDrive: public GenericDiskDrive
         NUM_DRV_TYPE
     };
 
+    /// when written data is forced to the host disk, besides sync().
+    enum SyncPolicy
+    {
+        syncNone,    // left to the host
+        syncCommand  // at the end of every write command
+    };
+
     GenericSASIDrive(DriveType   type,
                      std::string media,
                      int         cnum,
-                     int         sectorSize);
+                     int         sectorSize,
+                     std::string delta = "",
+                     SyncPolicy  policy = syncNone);
     virtual ~GenericSASIDrive() override;
-    static GenericSASIDrive* getInstance(std::string type,
-                                         std::string path,
-                                         int         unitNum);
+    /// argv is the drive type, optionally followed by 'cow=<delta file>' to
+    /// use the media copy-on-write, and 'fsync=none|command'.
+    static GenericSASIDrive* getInstance(std::vector<std::string> argv,
+                                         std::string              path,
+                                         int                      unitNum);
 
     // not used:
     int getRawBytesPerTrack() override
@@ -76,6 +91,7 @@ class GenericSASIDrive: public GenericDiskDrive
     void insertDisk(std::shared_ptr<GenericFloppyDisk> disk) override
     {
     }
+    void sync() override;
 
     std::string getMediaName() override;
 
@@ -136,6 +152,16 @@ class GenericSASIDrive: public GenericDiskDrive
 
   private:
     bool checkHeader(BYTE* b, int n);
+    ssize_t readMedia(BYTE*  buf,
+                      size_t len,
+                      off_t  off);
+    ssize_t writeMedia(const BYTE* buf,
+                       size_t      len,
+                       off_t       off);
+    bool readBlock(unsigned long block,
+                   unsigned long count);
+    bool writeBlock(unsigned long block);
+    bool endWrite();
     void startStatus(BYTE& ctrl);
     void startSense(BYTE& ctrl);
     void startDataIn(BYTE& ctrl);
@@ -166,6 +192,11 @@ class GenericSASIDrive: public GenericDiskDrive
     enum State       curState;
 
     int              driveFd;
+    /// set when the media is used copy-on-write.
+    std::unique_ptr<OverlayImage> driveOverlay;
+    /// sectors of the media file, unless it is an overlay.
+    std::unique_ptr<BlockCache> driveCache;
+    SyncPolicy       syncPolicy;
     int              driveSecLen;
     int              sectorsPerTrack;
     unsigned long    capacity;
@@ -0,0 +1,267 @@
+/// \file GuestProfiler.cpp
+///
+/// Statistical profile of where the guest spends its time.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#include "GuestProfiler.h"
+
+#include "AddressBus.h"
+#include "cpu.h"
+#include "logger.h"
+#include "propertyutil.h"
+
+/// \cond
+#include <algorithm>
+#include <ctype.h>
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <utility>
+/// \endcond
+
+GuestProfiler*   GuestProfiler::_inst          = nullptr;
+std::atomic_bool GuestProfiler::tickSampling_m(false);
+std::atomic_bool GuestProfiler::inTick_m(false);
+
+GuestProfiler*
+GuestProfiler::instance(void)
+{
+    if (!_inst)
+    {
+        _inst = new GuestProfiler();
+    }
+
+    return _inst;
+}
+
+GuestProfiler::GuestProfiler(): cpu_m(nullptr),
+                                ab_m(nullptr),
+                                cycleSampler_m(nullptr),
+                                counts_m(maxLayouts_c << 16, 0),
+                                samples_m(0)
+{
+
+}
+
+GuestProfiler::~GuestProfiler()
+{
+    stop();
+}
+
+void
+GuestProfiler::start(CPU*          cpu,
+                     AddressBus*   ab,
+                     unsigned long cycles)
+{
+    stop();
+
+    cpu_m = cpu;
+    ab_m  = ab;
+
+    std::fill(counts_m.begin(), counts_m.end(), 0);
+    samples_m = 0;
+
+    if (cycles != 0)
+    {
+        cycleSampler_m = new CycleSampler(this, cycles);
+    }
+    else
+    {
+        tickSampling_m = true;
+    }
+}
+
+/// must be called with the system mutex held.
+void
+GuestProfiler::stop()
+{
+    pauseTickSampling();
+
+    if (cycleSampler_m)
+    {
+        delete cycleSampler_m;
+        cycleSampler_m = nullptr;
+    }
+}
+
+bool
+GuestProfiler::pauseTickSampling()
+{
+    bool wasOn = tickSampling_m.exchange(false);
+
+    while (inTick_m)
+    {
+        // only while a signal handler on the CPU thread finishes a sample.
+    }
+
+    return wasOn;
+}
+
+bool
+GuestProfiler::running()
+{
+    return tickSampling_m || cycleSampler_m != nullptr;
+}
+
+unsigned long long
+GuestProfiler::getSamples()
+{
+    return samples_m;
+}
+
+void
+GuestProfiler::sample()
+{
+    unsigned int layout = ab_m->getCurrentLayoutNum() & (maxLayouts_c - 1);
+
+    ++counts_m[(layout << 16) | cpu_m->getPC()];
+    ++samples_m;
+}
+
+GuestProfiler::CycleSampler::CycleSampler(GuestProfiler* profiler,
+                                          unsigned long  interval): profiler_m(profiler),
+                                                                    interval_m(interval),
+                                                                    elapsed_m(0)
+{
+
+}
+
+void
+GuestProfiler::CycleSampler::notification(unsigned int cycleCount)
+{
+    elapsed_m += cycleCount;
+
+    if (elapsed_m >= interval_m)
+    {
+        elapsed_m -= interval_m;
+        profiler_m->sample();
+    }
+}
+
+///
+/// Both formats are value/name pairs, e.g. "0100 START" or M80's "0103'   LOOP",
+/// where the value may be marked relocatable, data, common or external.
+///
+int
+GuestProfiler::loadSymbols(std::string path,
+                           WORD        bias)
+{
+    std::ifstream file(path.c_str());
+
+    if (!file.is_open())
+    {
+        debugss(ssH89, ERROR, "Unable to open symbol file %s\n", path.c_str());
+        return -1;
+    }
+
+    std::string ext     = path.substr(std::min(path.size(), path.rfind('.') + 1));
+    bool        listing = (strcasecmp(ext.c_str(), "prn") == 0);
+    bool        inTable = !listing;
+    int         count   = 0;
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        if (!inTable)
+        {
+            // the listing itself has nothing to parse.
+            inTable = (line.compare(0, 8, "Symbols:") == 0);
+            continue;
+        }
+
+        std::replace(line.begin(), line.end(), '\x1a', ' ');
+
+        std::istringstream       words(line);
+        std::vector<std::string> tokens;
+        std::string              token;
+
+        while (words >> token)
+        {
+            tokens.push_back(token);
+        }
+
+        for (size_t x = 0; x + 1 < tokens.size(); x += 2)
+        {
+            std::string value = tokens[x];
+
+            while (!value.empty() && strchr("'\"!*", value[value.size() - 1]))
+            {
+                value.erase(value.size() - 1);
+            }
+
+            char*         end;
+            unsigned long addr = strtoul(value.c_str(), &end, 16);
+
+            if (value.empty() || value.size() > 4 || *end != '\0' ||
+                !(isalpha(tokens[x + 1][0]) || strchr("?@_$.", tokens[x + 1][0])))
+            {
+                // not a table line.
+                break;
+            }
+
+            symbols_m[(WORD) (addr + bias)] = tokens[x + 1];
+            ++count;
+        }
+    }
+
+    debugss(ssH89, INFO, "Loaded %d symbols from %s\n", count, path.c_str());
+
+    return count;
+}
+
+std::string
+GuestProfiler::dump(unsigned int count)
+{
+    std::map<unsigned int, unsigned long long> totals;
+
+    // cycle sampling is on the CPU thread, kept out by the system mutex.
+    bool                                       ticks = pauseTickSampling();
+
+    for (unsigned int x = 0; x < counts_m.size(); ++x)
+    {
+        if (counts_m[x] == 0)
+        {
+            continue;
+        }
+
+        unsigned int                                key = x;
+        std::map<WORD, std::string>::const_iterator sym = symbols_m.upper_bound(x & 0xffff);
+
+        if (sym != symbols_m.begin())
+        {
+            key = (x & 0xffff0000) | (--sym)->first;
+        }
+
+        totals[key] += counts_m[x];
+    }
+
+    tickSampling_m = ticks;
+
+    std::vector<std::pair<unsigned long long, unsigned int> > order;
+
+    for (std::map<unsigned int, unsigned long long>::const_iterator it = totals.begin();
+         it != totals.end(); ++it)
+    {
+        order.push_back(std::make_pair(it->second, it->first));
+    }
+
+    std::sort(order.rbegin(), order.rend());
+
+    std::string resp = PropertyUtil::sprintf("samples=%llu", (unsigned long long) samples_m);
+
+    for (unsigned int x = 0; x < order.size() && x < count; ++x)
+    {
+        WORD                                        addr = order[x].second & 0xffff;
+        std::map<WORD, std::string>::const_iterator sym  = symbols_m.find(addr);
+
+        resp += PropertyUtil::sprintf(";%llu %u:%04x %s", order[x].first, order[x].second >> 16,
+                                      addr, (sym != symbols_m.end()) ? sym->second.c_str() : "-");
+    }
+
+    return resp;
+}
@@ -0,0 +1,123 @@
+/// \file GuestProfiler.h
+///
+/// Statistical profile of where the guest spends its time.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#ifndef GUESTPROFILER_H_
+#define GUESTPROFILER_H_
+
+#include "ClockUser.h"
+#include "h89Types.h"
+
+/// \cond
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+/// \endcond
+
+class AddressBus;
+class CPU;
+
+///
+/// \class GuestProfiler
+///
+/// \brief PC sampling profiler. This is a singleton.
+///
+/// Each sample counts the PC, in the memory layout (bank) mapped at the time, in a
+/// fixed histogram with a counter for every address of every layout, so taking one
+/// is two reads and two increments. Samples are taken on every H89Timer tick (500
+/// a second of host time), or every so many CPU cycles, which is repeatable from
+/// run to run.
+///
+/// Symbols can be loaded from CP/M .SYM files ("hhhh NAME" pairs, as from MAC,
+/// RMAC, LINK or L80) or M80 .PRN listings (the "Symbols:" table at the end); the
+/// dump then totals the samples per routine.
+///
+class GuestProfiler
+{
+  public:
+    static GuestProfiler* instance(void);
+
+    /// cycles of 0 samples on every timer tick. Clears any earlier samples.
+    void start(CPU*          cpu,
+               AddressBus*   ab,
+               unsigned long cycles);
+    void stop();
+    bool running();
+    unsigned long long getSamples();
+
+    /// called by the H89Timer on each tick, possibly from its signal handler.
+    static inline void timerTick()
+    {
+        if (tickSampling_m)
+        {
+            // checked again, so pauseTickSampling() knows when it has taken effect.
+            inTick_m = true;
+
+            if (tickSampling_m)
+            {
+                _inst->sample();
+            }
+
+            inTick_m = false;
+        }
+    }
+
+    /// \retval number of symbols loaded, -1 if the file can't be read.
+    int loadSymbols(std::string path,
+                    WORD        bias);
+
+    /// the count busiest routines (addresses, if there's no symbol for them), as
+    /// "<samples> <layout>:<address> <symbol>" entries separated by ';'.
+    /// Must be called with the system mutex held.
+    std::string dump(unsigned int count);
+
+  private:
+    GuestProfiler();
+    ~GuestProfiler();
+
+    /// use C++11 to avoid having to define copy constructor
+    GuestProfiler(GuestProfiler const&)            = delete;
+    GuestProfiler& operator=(GuestProfiler const&) = delete;
+
+    void sample();
+
+    /// stops tick sampling, and waits for any sample being taken.
+    /// \retval whether tick sampling was on.
+    bool pauseTickSampling();
+
+    /// takes a sample every interval cycles.
+    class CycleSampler: public ClockUser
+    {
+      public:
+        CycleSampler(GuestProfiler* profiler,
+                     unsigned long  interval);
+
+        virtual void notification(unsigned int cycleCount) override;
+
+      private:
+        GuestProfiler* profiler_m;
+        unsigned long  interval_m;
+        unsigned long  elapsed_m;
+    };
+
+    static const unsigned int          maxLayouts_c = 8;
+
+    static GuestProfiler*              _inst;
+    static std::atomic_bool            tickSampling_m;
+    static std::atomic_bool            inTick_m;
+
+    CPU*                               cpu_m;
+    AddressBus*                        ab_m;
+    CycleSampler*                      cycleSampler_m;
+    /// indexed by (layout << 16) | PC, allocated once, so a tick can't see it move.
+    std::vector<unsigned int>          counts_m;
+    std::atomic_ullong                 samples_m;
+    std::map<WORD, std::string>        symbols_m;
+};
+
+#endif // GUESTPROFILER_H_
@@ -20,6 +20,7 @@
 #include "NMIPort.h"
 #include "GeneralPurposePort.h"
 #include "INS8250.h"
+#include "HostSerialPort.h"
 #include "h17.h"
 #include "h37.h"
 #include "Z47Interface.h"
@@ -61,6 +62,9 @@ H89::buildSystem(Console* console, PropertyUtil::PropertyMapT props)
 
     interruptController = nullptr;
     ab                  = nullptr;
+    lpPort              = nullptr;
+    modemPort           = nullptr;
+    auxPort             = nullptr;
 
 
     cpu                 = new Z80(this, cpuClockRate_c, clockInterruptPerSecond_c);
@@ -328,6 +332,13 @@ H89::buildSystem(Console* console, PropertyUtil::PropertyMapT props)
     cpu->setAddressBus(ab);
     timer = new H89Timer(this, cpu);
 
+    // 'off' runs the guest as fast as the host allows, e.g. for benchmarks.
+    s     = props["throttle"];
+    if (s.compare("off") == 0)
+    {
+        timer->setThrottle(false);
+    }
+
     h89io->addDevice(new NMIPort(cpu, NMI_BaseAddress_1_c, NMI_NumPorts_1_c));
     h89io->addDevice(new NMIPort(cpu, NMI_BaseAddress_2_c, NMI_NumPorts_2_c));
 
@@ -413,6 +424,26 @@ H89::buildSystem(Console* console, PropertyUtil::PropertyMapT props)
         h89io->addDevice(modemPort);
     }
 
+    // Optional connections from the serial ports to the host.
+    // property syntax: serial_lp = pty|fifo|unix|file [args...]
+    vector<pair<string, INS8250*> > hostPorts = {{"serial_lp", lpPort},
+                                                 {"serial_modem", modemPort},
+                                                 {"serial_aux", auxPort}};
+
+    for (int x = 0; x < hostPorts.size(); ++x)
+    {
+        if (hostPorts[x].second == nullptr)
+        {
+            continue;
+        }
+
+        HostSerialPort* hsp = HostSerialPort::install_HostSerialPort(props, hostPorts[x].first);
+
+        if (hsp != nullptr)
+        {
+            hostPorts[x].second->attachDevice(hsp);
+        }
+    }
 }
 
 
@@ -513,6 +544,12 @@ H89::waitCPU(void)
     cpu->waitState();
 }
 
+void
+H89::addWaitStates(unsigned int cycles)
+{
+    cpu->addWaitStates(cycles);
+}
+
 H89_IO&
 H89::getIO()
 {
@@ -540,6 +577,12 @@ H89::getCPU()
     return (*cpu);
 }
 
+H89Timer&
+H89::getTimer()
+{
+    return (*timer);
+}
+
 string
 H89::dumpDebug()
 {
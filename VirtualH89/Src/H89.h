@@ -150,6 +150,7 @@ class H89: public Computer
     virtual void raiseNMI(void) override;
     virtual void continueCPU(void) override;
     virtual void waitCPU(void) override;
+    virtual void addWaitStates(unsigned int cycles) override;
     std::string dumpDebug();
 
     virtual void writeProtectH17RAM();
@@ -160,6 +161,7 @@ class H89: public Computer
 
     virtual AddressBus& getAddressBus() override;
     virtual CPU&        getCPU();
+    virtual H89Timer&   getTimer();
 };
 
 extern H89 h89;
@@ -12,17 +12,24 @@
 
 
 #include "cpu.h"
+#include "AddressBus.h"
 #include "H89.h"
 #include "h89-io.h"
 #include "logger.h"
 #include "DiskController.h"
 #include "GenericDiskDrive.h"
-#include "RawFloppyImage.h"
-#include "SectorFloppyImage.h"
+#include "GuestProfiler.h"
+#include "h89-timer.h"
+#include "MediaLoader.h"
 #include "propertyutil.h"
+#include "SocketServer.h"
+#include "WallClock.h"
+#include "WorkloadScript.h"
 
 /// \cond
+#include <algorithm>
 #include <stdio.h>
+#include <sys/time.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <signal.h>
@@ -33,16 +40,46 @@
 /// \endcond
 
 
+std::vector<OperatorEventListener*> H89Operator::listeners;
+
+/// host time the first operator was created, used for stats.
+static struct timeval               startTime;
+
 /// \brief H89Operator
 ///
 ///
 H89Operator::H89Operator()
 {
+    if (startTime.tv_sec == 0)
+    {
+        gettimeofday(&startTime, nullptr);
+    }
 }
 
 H89Operator::~H89Operator() {
 }
 
+void
+H89Operator::addListener(OperatorEventListener* lstr)
+{
+    listeners.push_back(lstr);
+}
+
+void
+H89Operator::removeListener(OperatorEventListener* lstr)
+{
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), lstr), listeners.end());
+}
+
+void
+H89Operator::notifyListeners(std::string event)
+{
+    for (int x = 0; x < listeners.size(); ++x)
+    {
+        listeners[x]->operatorEvent(event);
+    }
+}
+
 GenericDiskDrive*
 H89Operator::findDrive(std::string name)
 {
@@ -120,9 +157,61 @@ H89Operator::executeCommand(std::string cmd)
     if (args[0].compare("reset") == 0)
     {
         h89.reset();
+        notifyListeners("reset");
         return "ok";
     }
 
+    if (args[0].compare("stats") == 0)
+    {
+        struct timeval now;
+        gettimeofday(&now, nullptr);
+
+        unsigned long long cycles  = WallClock::instance()->getClock();
+        double             elapsed = (now.tv_sec - startTime.tv_sec) +
+                                     (now.tv_usec - startTime.tv_usec) / 1000000.0;
+
+        std::string stats = PropertyUtil::sprintf("ok cycles=%llu clock=%lu elapsed=%.3f mhz=%.3f\n",
+                                                  cycles,
+                                                  WallClock::instance()->getTicksPerSecond(),
+                                                  elapsed,
+                                                  (elapsed > 0.0) ?
+                                                  cycles / elapsed / 1000000.0 : 0.0);
+
+        // followed by a "socket <sid> ..." line for each CP/Net socket server.
+        stats += SocketServer::getAllStats();
+        stats.erase(stats.size() - 1);
+
+        return cleanse(stats);
+    }
+
+    if (args[0].compare("snapshot") == 0)
+    {
+        // writes the 64K address space as currently mapped, returns the CPU state.
+        if (args.size() < 2)
+        {
+            return "error syntax: " + cmd;
+        }
+
+        FILE* file = fopen(args[1].c_str(), "wb");
+
+        if (file == nullptr)
+        {
+            return "error open: " + args[1];
+        }
+
+        AddressBus& ab = h89.getAddressBus();
+
+        for (int addr = 0; addr < 0x10000; ++addr)
+        {
+            fputc(ab.readByte(addr), file);
+        }
+
+        fclose(file);
+
+        std::string dump = "ok " + h89.getCPU().dumpDebug();
+        return cleanse(dump);
+    }
+
     if (args[0].compare("mount") == 0)
     {
         if (args.size() < 3)
@@ -137,7 +226,198 @@ H89Operator::executeCommand(std::string cmd)
             return "error nodrive: " + args[1];
         }
 
-        drv->insertDisk(SectorFloppyImage::getDiskette(drv, PropertyUtil::shiftArgs(args, 2)));
+        // decoded in the background, the drive is empty until the mount event.
+        MediaLoader::instance()->mount(drv, args[1], PropertyUtil::shiftArgs(args, 2));
+        return "ok";
+    }
+
+    if (args[0].compare("eject") == 0)
+    {
+        if (args.size() < 2)
+        {
+            return "error syntax: " + cmd;
+        }
+
+        GenericDiskDrive* drv = findDrive(args[1]);
+
+        if (drv == nullptr)
+        {
+            return "error nodrive: " + args[1];
+        }
+
+        MediaLoader::instance()->eject(drv, args[1]);
+        return "ok";
+    }
+
+    if (args[0].compare("sync") == 0)
+    {
+        // flush all mounted media to the host files.
+        std::vector<DiskController*> devs = h89.getIO().getDiskDevices();
+
+        for (int x = 0; x < devs.size(); ++x)
+        {
+            if (devs[x] != nullptr)
+            {
+                devs[x]->sync();
+            }
+        }
+
+        return "ok";
+    }
+
+    if (args[0].compare("ports") == 0)
+    {
+        // per-port access counts, "ports on|off|clear" controls the counting.
+        H89_IO& io = h89.getIO();
+
+        if (args.size() < 2)
+        {
+            return "ok " + io.dumpCounters();
+        }
+
+        if (args[1].compare("on") == 0)
+        {
+            io.setCounting(true);
+        }
+        else if (args[1].compare("off") == 0)
+        {
+            io.setCounting(false);
+        }
+        else if (args[1].compare("clear") == 0)
+        {
+            io.clearCounters();
+        }
+        else
+        {
+            return "error syntax: " + cmd;
+        }
+
+        return "ok";
+    }
+
+    if (args[0].compare("opstats") == 0)
+    {
+        // per-opcode counts, "opstats <file>" writes them as CSV, "opstats clear".
+        if (args.size() < 2)
+        {
+            return "error syntax: " + cmd;
+        }
+
+        CPU& cpu = h89.getCPU();
+
+        if (args[1].compare("clear") == 0)
+        {
+            cpu.clearStats();
+            return "ok";
+        }
+
+        std::string csv = cpu.dumpStats();
+
+        if (csv.empty())
+        {
+            return "error notbuilt: Z80_STATS";
+        }
+
+        FILE* file = fopen(args[1].c_str(), "w");
+
+        if (file == nullptr)
+        {
+            return "error open: " + args[1];
+        }
+
+        fputs(csv.c_str(), file);
+        fclose(file);
+
+        return "ok";
+    }
+
+    if (args[0].compare("profile") == 0)
+    {
+        // PC sampling, "profile start [<cycles>]|stop|dump [<count>]|symbols <file> [<bias>]".
+        GuestProfiler* prof = GuestProfiler::instance();
+
+        if (args.size() < 2)
+        {
+            return PropertyUtil::sprintf("ok %s samples=%llu",
+                                         prof->running() ? "running" : "stopped",
+                                         prof->getSamples());
+        }
+
+        if (args[1].compare("start") == 0)
+        {
+            unsigned long cycles = (args.size() > 2) ? strtoul(args[2].c_str(), nullptr, 0) : 0;
+
+            prof->start(&h89.getCPU(), &h89.getAddressBus(), cycles);
+        }
+        else if (args[1].compare("stop") == 0)
+        {
+            prof->stop();
+        }
+        else if (args[1].compare("dump") == 0)
+        {
+            unsigned long count = (args.size() > 2) ? strtoul(args[2].c_str(), nullptr, 0) : 20;
+
+            return "ok " + prof->dump(count);
+        }
+        else if (args[1].compare("symbols") == 0 && args.size() > 2)
+        {
+            WORD bias  = (args.size() > 3) ? strtoul(args[3].c_str(), nullptr, 16) : 0;
+            int  count = prof->loadSymbols(args[2], bias);
+
+            if (count < 0)
+            {
+                return "error open: " + args[2];
+            }
+
+            return PropertyUtil::sprintf("ok %d", count);
+        }
+        else
+        {
+            return "error syntax: " + cmd;
+        }
+
+        return "ok";
+    }
+
+    if (args[0].compare("throttle") == 0)
+    {
+        // "throttle off" runs the guest as fast as the host allows, "throttle on" at speed.
+        if (args.size() < 2 || (args[1].compare("on") != 0 && args[1].compare("off") != 0))
+        {
+            return "error syntax: " + cmd;
+        }
+
+        if (!h89.getTimer().setThrottle(args[1].compare("on") == 0))
+        {
+            return "error journal";
+        }
+
+        return "ok";
+    }
+
+    if (args[0].compare("workload") == 0)
+    {
+        // scripted console session, "workload <script> [<results>]|stop", or its status.
+        // only a start creates the instance.
+        WorkloadScript* workload = WorkloadScript::current();
+
+        if (args.size() < 2)
+        {
+            return "ok " + (workload ? workload->status() : std::string("none"));
+        }
+
+        if (args[1].compare("stop") == 0)
+        {
+            if (workload)
+            {
+                workload->stop();
+            }
+        }
+        else if (!WorkloadScript::instance()->start(args[1], (args.size() > 2) ? args[2] : ""))
+        {
+            return "error open: " + args[1];
+        }
+
         return "ok";
     }
 
@@ -14,6 +14,7 @@
 /// \cond
 #include <assert.h>
 #include <string>
+#include <vector>
 /// \endcond
 
 
@@ -21,6 +22,18 @@ class GenericDiskDrive;
 class DiskController;
 
 
+/// \brief Receives asynchronous operator events, e.g. to forward to a front-end.
+///
+class OperatorEventListener
+{
+  public:
+    virtual ~OperatorEventListener()
+    {
+    }
+
+    virtual void operatorEvent(std::string event) = 0;
+};
+
 /// \brief H89Operator
 ///
 ///
@@ -31,8 +44,17 @@ class H89Operator
     virtual ~H89Operator();
     std::string handleCommand(std::string cmd);
 
-  private:
+    /// Same as handleCommand(), but the caller must already hold the system
+    /// mutex, e.g. when running on the CPU thread at an instruction boundary.
     std::string executeCommand(std::string cmd);
+
+    static void addListener(OperatorEventListener* lstr);
+    static void removeListener(OperatorEventListener* lstr);
+    static void notifyListeners(std::string event);
+
+  private:
+    static std::vector<OperatorEventListener*> listeners;
+
     GenericDiskDrive* findDrive(std::string name);
     DiskController* findDiskCtrlr(std::string name);
     std::string cleanse(std::string resp);
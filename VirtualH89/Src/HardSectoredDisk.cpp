@@ -7,57 +7,76 @@
 ///
 
 #include "HardSectoredDisk.h"
+#include "SectorJournal.h"
 #include "logger.h"
 
 /// \cond
 #include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include <sys/stat.h>
 /// \endcond
 
-HardSectoredDisk::HardSectoredDisk(const char* name)
+HardSectoredDisk::HardSectoredDisk(const char* name): name_m(name)
 {
-    FILE* file;
+    int         fd;
+    struct stat st;
 
     initialized_m = true;
     memset(rawImage_m, 0, maxHeads_c * bytesPerTrack_c * maxTracksPerSide_c);
 
-    if ((file = fopen(name, "r")) != nullptr)
+    if ((fd = open(name, O_RDONLY)) >= 0 && fstat(fd, &st) == 0)
     {
-        unsigned long readCount;
-        int           trk  = 0;
-        int           head = 0;
+        // the image is side 0, then side 1, each of up to 80 tracks, and is read with
+        // one read() into rawImage_m, which has the same layout.
+        unsigned long numTracks = st.st_size / bytesPerTrack_c;
+        size_t        len;
+        size_t        pos       = 0;
 
-        do
+        if (numTracks > maxHeads_c * maxTracksPerSide_c)
         {
-            if (trk == 80)
-            {
-                // Check to see if we read both sides.
-                if (head == 1)
-                {
-                    break;
-                }
+            numTracks = maxHeads_c * maxTracksPerSide_c;
+        }
 
-                trk = 0;
-                head++;
-            }
+        len = numTracks * bytesPerTrack_c;
 
-            if ((readCount =
-                     fread(&rawImage_m[head][trk][0], bytesPerTrack_c, 1, file)) == 1)
+        while (pos < len)
+        {
+            ssize_t num = read(fd, (BYTE*) rawImage_m + pos, len - pos);
+
+            if (num < 0 && errno == EINTR)
             {
-                trk++;
+                continue;
             }
-            else if ((trk == 0) && (head == 1))
+
+            if (num <= 0)
             {
-                // check to see if we have to adjust side and track.
-                head = 0;
-                trk  = 80;
+                debugss(ssFloppyDisk, ERROR, "unable to read file - %s\n", name);
+                break;
             }
+
+            pos += num;
         }
-        while (readCount == 1);
 
-        tracks_m = trk;
-        sides_m  = head + 1;
+        numTracks = pos / bytesPerTrack_c;
+
+        if (numTracks > maxTracksPerSide_c)
+        {
+            tracks_m = numTracks - maxTracksPerSide_c;
+            sides_m  = 2;
+        }
+        else
+        {
+            tracks_m = numTracks;
+            sides_m  = 1;
+        }
+
+        fileTracks_m = numTracks;
+
         debugss(ssFloppyDisk, ALL, "Sides: %d  Tracks: %d\n", sides_m, tracks_m);
-        fclose(file);
     }
     else
     {
@@ -65,6 +84,11 @@ HardSectoredDisk::HardSectoredDisk(const char* name)
         initialized_m = false;
     }
 
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
     if (initialized_m)
     {
         debugss(ssFloppyDisk, INFO, "Success %s\n", name);
@@ -87,7 +111,7 @@ HardSectoredDisk::HardSectoredDisk()
 
 HardSectoredDisk::~HardSectoredDisk()
 {
-
+    endWriteBack();
 }
 
 bool
@@ -188,7 +212,18 @@ HardSectoredDisk::writeData(BYTE          side,
 
         if ((track < maxTracksPerSide_c) && (pos < bytesPerTrack_c))
         {
-            rawImage_m[side][track][pos] = data;
+            if (fd_m >= 0)
+            {
+                pthread_mutex_lock(&mutex_m);
+                rawImage_m[side][track][pos]                 = data;
+                dirty_m[side][track][pos / bytesPerSector_c] = true;
+                pthread_mutex_unlock(&mutex_m);
+            }
+            else
+            {
+                rawImage_m[side][track][pos] = data;
+            }
+
             debugss(ssFloppyDisk, ALL, "side (%d) track(%d) pos(%lu) = %d\n",
                     side,
                     track,
@@ -262,29 +297,46 @@ HardSectoredDisk::dump()
 void
 HardSectoredDisk::eject(const char* name)
 {
-    FILE* file;
+    if (fd_m >= 0)
+    {
+        endWriteBack();
+        return;
+    }
+
+    saveImage(name, false);
+}
+
+///
+/// \param imageLayout - with two sides, write all 80 tracks of side 0 first, the
+///                      layout the image is loaded with.
+///
+/// Goes through a temporary file, so a crash leaves the old image, not part of it.
+///
+void
+HardSectoredDisk::saveImage(const char* name,
+                            bool        imageLayout)
+{
+    std::vector<BYTE> buf;
+
     debugss(ssFloppyDisk, ALL, "Save: %s\n", name);
 
-    if ((file = fopen(name, "wb")) != nullptr)
+    for (int head = 0; head < sides_m; head++)
     {
-        unsigned long readCount;
+        unsigned int tracks = tracks_m;
 
-        for (int head = 0; head < sides_m; head++)
+        if (imageLayout && head + 1 < sides_m)
         {
-            for (int track = 0; track < tracks_m; track++)
-            {
-                if ((readCount =
-                         fwrite(&rawImage_m[head][track][0], bytesPerTrack_c, 1, file)) != 1)
-                {
-                    debugss(ssFloppyDisk, ERROR, "Unable to save file: %s head: %d track: %d\n",
-                            name, head, track);
-                }
-            }
+            tracks = maxTracksPerSide_c;
         }
 
-        fclose(file);
+        for (int track = 0; track < tracks; track++)
+        {
+            buf.insert(buf.end(), &rawImage_m[head][track][0],
+                       &rawImage_m[head][track][0] + bytesPerTrack_c);
+        }
     }
-    else
+
+    if (!SectorJournal::replaceFile(name, &buf[0], buf.size()))
     {
         debugss(ssFloppyDisk, WARNING, "unable to save file - %s\n", name);
     }
@@ -300,3 +352,194 @@ HardSectoredDisk::readSectorData(BYTE  side,
     debugss(ssFloppyDisk, ERROR, "Not Implemented\n");
     return false;
 }
+
+bool
+HardSectoredDisk::enableWriteBack(unsigned int interval)
+{
+    if (!initialized_m || fd_m >= 0)
+    {
+        return false;
+    }
+
+    if ((fd_m = open(name_m.c_str(), O_WRONLY)) < 0)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to open %s for write-back (%d)\n", name_m.c_str(),
+                errno);
+        return false;
+    }
+
+    interval_m = interval;
+
+    if (interval_m)
+    {
+        running_m = (pthread_create(&thread_m, nullptr, threadFunc, this) == 0);
+    }
+
+    return true;
+}
+
+void*
+HardSectoredDisk::threadFunc(void* arg)
+{
+    static_cast<HardSectoredDisk*>(arg)->flushThread();
+
+    return nullptr;
+}
+
+void
+HardSectoredDisk::flushThread()
+{
+    pthread_mutex_lock(&mutex_m);
+
+    while (!stopping_m)
+    {
+        struct timespec deadline;
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += interval_m;
+
+        pthread_cond_timedwait(&cond_m, &mutex_m, &deadline);
+
+        if (!stopping_m)
+        {
+            pthread_mutex_unlock(&mutex_m);
+            flushDirty();
+            pthread_mutex_lock(&mutex_m);
+        }
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+}
+
+///
+/// \brief Write the modified sectors to the image file.
+///
+/// The sectors are copied out while holding the lock, so the CPU thread only ever waits
+/// for a memcpy, never for the host disk.
+///
+bool
+HardSectoredDisk::flushDirty()
+{
+    struct Pending
+    {
+        off_t offset;
+        BYTE  data[bytesPerSector_c];
+    };
+
+    std::vector<Pending> pending;
+    bool                 ok = true;
+
+    pthread_mutex_lock(&flushMutex_m);
+    pthread_mutex_lock(&mutex_m);
+
+    for (unsigned int side = 0; side < maxHeads_c; ++side)
+    {
+        for (unsigned int track = 0; track < maxTracksPerSide_c; ++track)
+        {
+            for (unsigned int sect = 0; sect < sectorsPerTrack_c; ++sect)
+            {
+                if (!dirty_m[side][track][sect])
+                {
+                    continue;
+                }
+
+                dirty_m[side][track][sect] = false;
+
+                if (side * maxTracksPerSide_c + track >= fileTracks_m)
+                {
+                    // would change the layout of the file, leave it for eject().
+                    unsaved_m = true;
+                    continue;
+                }
+
+                Pending p;
+                p.offset = ((side * maxTracksPerSide_c + track) * bytesPerTrack_c +
+                            sect * bytesPerSector_c);
+                memcpy(p.data, &rawImage_m[side][track][sect * bytesPerSector_c],
+                       bytesPerSector_c);
+                pending.push_back(p);
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    for (size_t x = 0; x < pending.size(); ++x)
+    {
+        if (pwrite(fd_m, pending[x].data, bytesPerSector_c, pending[x].offset) !=
+            (ssize_t) bytesPerSector_c)
+        {
+            debugss(ssFloppyDisk, ERROR, "Unable to write %s (%d)\n", name_m.c_str(), errno);
+            unsaved_m = true;
+            ok        = false;
+        }
+    }
+
+    pthread_mutex_unlock(&flushMutex_m);
+
+    if (!pending.empty())
+    {
+        debugss(ssFloppyDisk, INFO, "Flushed %d sectors to %s\n", (int) pending.size(),
+                name_m.c_str());
+    }
+
+    return ok;
+}
+
+void
+HardSectoredDisk::sync()
+{
+    if (fd_m >= 0 && flushDirty())
+    {
+        fsync(fd_m);
+    }
+}
+
+///
+/// Stops the write-back, and saves any writes it couldn't do in place. Writes
+/// beyond the file's tracks change its layout, so the image is rewritten in full
+/// and a session's changes all end up in the one file.
+///
+void
+HardSectoredDisk::endWriteBack()
+{
+    if (fd_m < 0)
+    {
+        return;
+    }
+
+    stopWriteBack();
+
+    if (!unsaved_m)
+    {
+        debugss(ssFloppyDisk, INFO, "Image up to date: %s\n", name_m.c_str());
+        return;
+    }
+
+    saveImage(name_m.c_str(), true);
+    unsaved_m = false;
+}
+
+void
+HardSectoredDisk::stopWriteBack()
+{
+    if (fd_m < 0)
+    {
+        return;
+    }
+
+    if (running_m)
+    {
+        pthread_mutex_lock(&mutex_m);
+        stopping_m = true;
+        pthread_cond_signal(&cond_m);
+        pthread_mutex_unlock(&mutex_m);
+
+        pthread_join(thread_m, nullptr);
+        running_m = false;
+    }
+
+    sync();
+    close(fd_m);
+    fd_m = -1;
+}
@@ -11,6 +11,10 @@
 
 #include "FloppyDisk.h"
 
+/// \cond
+#include <pthread.h>
+#include <string>
+/// \endcond
 
 /// \class HardSectoredDisk
 ///
@@ -19,6 +23,11 @@
 /// This class implements a virtual hard-sectored disk. It models the entire track
 /// such as the headers and gaps, not only the data portion.
 ///
+/// With write-back enabled, modified sectors are tracked and written to the image file
+/// with pwrite, by a background thread every few seconds and on sync(); writes beyond
+/// the file's tracks have the image file rewritten in full on eject(). Otherwise the
+/// image is only saved, in full, to the file given to eject().
+///
 class HardSectoredDisk: public FloppyDisk
 {
   public:
@@ -45,6 +54,11 @@ class HardSectoredDisk: public FloppyDisk
                                 WORD  pos,
                                 BYTE& data) override;
     virtual void eject(const char* name) override;
+    virtual void sync() override;
+
+    /// keep the image file up to date, flushing every interval seconds (0 - only on
+    /// sync() and eject()).
+    bool enableWriteBack(unsigned int interval);
 
   private:
     // Hard sectored disks on Heath, only support single density (FM encoding)
@@ -54,6 +68,8 @@ class HardSectoredDisk: public FloppyDisk
     /// hard-sectored disks can be used
     static const unsigned int maxHeads_c         = 2;
     static const unsigned int maxTracksPerSide_c = 80;
+    static const unsigned int sectorsPerTrack_c  = 10;
+    static const unsigned int bytesPerSector_c   = bytesPerTrack_c / sectorsPerTrack_c;
 
     BYTE                      rawImage_m[maxHeads_c][maxTracksPerSide_c][bytesPerTrack_c];
 
@@ -61,7 +77,33 @@ class HardSectoredDisk: public FloppyDisk
     unsigned int              tracks_m      = 80;
     unsigned int              sides_m       = 2;
 
+    std::string               name_m;
+    /// image file, only open with write-back enabled.
+    int                       fd_m          = -1;
+    /// tracks in the file, written sectors beyond it are kept for a full save.
+    unsigned int              fileTracks_m  = 0;
+    bool                      unsaved_m     = false;
+
+    /// guards writes to rawImage_m and dirty_m, against the flusher's copy.
+    pthread_mutex_t           mutex_m       = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t            cond_m        = PTHREAD_COND_INITIALIZER;
+    /// serializes flushes from the thread, sync() and eject().
+    pthread_mutex_t           flushMutex_m  = PTHREAD_MUTEX_INITIALIZER;
+    pthread_t                 thread_m;
+    bool                      running_m     = false;
+    bool                      stopping_m    = false;
+    unsigned int              interval_m    = 0;
+    bool                      dirty_m[maxHeads_c][maxTracksPerSide_c][sectorsPerTrack_c] = {};
+
     bool defaultHoleStatus(unsigned long pos);
+    void saveImage(const char* name,
+                   bool        imageLayout);
+
+    static void* threadFunc(void* arg);
+    void flushThread();
+    bool flushDirty();
+    void stopWriteBack();
+    void endWriteBack();
 };
 
 #endif // HARDSECTOREDDISK_H_
@@ -44,6 +44,10 @@ enum logLevel
 #include <string.h>
 #include <fnmatch.h>
 #include <stdlib.h>
+#include <algorithm>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
 /// \endcond
 
 
@@ -56,11 +60,29 @@ HostFileBdos::HostFileBdos(PropertyUtil::PropertyMapT& props,
     curDsk(-1),
     curUsr(0),
     curROVec(0),
-    curLogVec(0)
+    curLogVec(0),
+    statGen(1),
+    notifyFd(-1)
 {
     memset(&curSearch, 0, sizeof(curSearch));
+    for (int x = 0; x < 16; ++x)
+    {
+        dirCaches[x].valid  = 0;
+        dirCaches[x].exists = 0;
+        dirCaches[x].gen    = 0;
+        dirCaches[x].wd     = -1;
+        dirCaches[x].built  = 0;
+    }
+#if defined(__linux__)
+    notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifyFd < 0)
+    {
+        debugss(ssHostFileBdos, INFO, "inotify not available (%d)\n", errno);
+    }
+#endif
     memset(&curDpb, 0, sizeof(curDpb));
     memset(openFiles, -1, sizeof(openFiles));
+    memset(fileBufs, 0, sizeof(fileBufs));
     memset(&sFcb, 0, sizeof(sFcb));
     sFcb.drv   = 0x21;
     curDpb.spt = 64; // some number
@@ -105,11 +127,23 @@ HostFileBdos::HostFileBdos(PropertyUtil::PropertyMapT& props,
     }
     debugss(ssHostFileBdos, ERROR, "Creating HostFileBdos device with root dir %s\n", s.c_str());
     dir = strdup(s.c_str());
+    pthread_mutex_init(&reqMutex, nullptr);
+    pthread_mutex_lock(&instancesMutex);
+    if (instances.empty())
+    {
+        atexit(flushAtExit);
+    }
+    instances.push_back(this);
+    pthread_mutex_unlock(&instancesMutex);
 }
 
 HostFileBdos::~HostFileBdos()
 {
     int x;
+    pthread_mutex_lock(&instancesMutex);
+    instances.erase(std::remove(instances.begin(), instances.end(), this), instances.end());
+    pthread_mutex_unlock(&instancesMutex);
+    flushAll();
     for (x = 0; x < DEF_NFILE; ++x)
     {
         if (openFiles[x] >= 0)
@@ -117,11 +151,13 @@ HostFileBdos::~HostFileBdos()
             close(openFiles[x]);
             openFiles[x] = -1;
         }
+        free(fileBufs[x].data);
+        fileBufs[x].data = nullptr;
     }
-    if (curSearch.find.dir)
+    if (notifyFd >= 0)
     {
-        closedir(curSearch.find.dir);
-        curSearch.find.dir = nullptr;
+        close(notifyFd);
+        notifyFd = -1;
     }
     if (dir != nullptr)
     {
@@ -130,6 +166,23 @@ HostFileBdos::~HostFileBdos()
     }
 }
 
+std::vector<HostFileBdos*> HostFileBdos::instances;
+pthread_mutex_t            HostFileBdos::instancesMutex = PTHREAD_MUTEX_INITIALIZER;
+
+void
+HostFileBdos::flushAtExit()
+{
+    pthread_mutex_lock(&instancesMutex);
+    for (HostFileBdos* bdos : instances)
+    {
+        // waits for a request in progress, e.g. on an async server's thread,
+        // and keeps any later one from touching the buffers.
+        pthread_mutex_lock(&bdos->reqMutex);
+        bdos->flushAll();
+    }
+    pthread_mutex_unlock(&instancesMutex);
+}
+
 int
 HostFileBdos::checkRecvMsg(uint8_t clientId, uint8_t* msgbuf, int len)
 {
@@ -149,7 +202,10 @@ HostFileBdos::sendMsg(uint8_t* msgbuf, int len)
         msg[1] = 12;
         return 2;
     }
-    return bdosFunctions[hdr->mfunc](this, msg, len - sizeof(*hdr));
+    pthread_mutex_lock(&reqMutex);
+    int rc = bdosFunctions[hdr->mfunc](this, msg, len - sizeof(*hdr));
+    pthread_mutex_unlock(&reqMutex);
+    return rc;
 }
 
 int
@@ -261,6 +317,12 @@ HostFileBdos::closeFile(uint8_t* msgbuf, int len)
         return 1;
     }
     msgbuf[0] = 0;
+    if (flushFile(locFileFcb(fcb)) < 0)
+    {
+        closeFileFcb(fcb);
+        msgbuf[0] = 255;
+        return 1;
+    }
     if (!fcb->s1[1])
     {
         // special truncate for SUBMIT (CCP)
@@ -271,6 +333,7 @@ HostFileBdos::closeFile(uint8_t* msgbuf, int len)
         {
             debugss(ssHostFileBdos, ERROR, "ftruncate\n");
         }
+        ++statGen;
     }
     rc = closeFileFcb(fcb);
     if (rc < 0)
@@ -340,6 +403,7 @@ HostFileBdos::searchFirst(uint8_t* msgbuf, int len)
         debugss(ssHostFileBdos, ERROR, "Search with drv = '?'\n");
         memset(&fcb->name[0], '?', 12);
     }
+    flushAll(); // sizes of files being written
     const char* f = startSearch(fcb, &curSearch, u);
     if (f == nullptr)
     {
@@ -399,6 +463,10 @@ HostFileBdos::deleteFile(uint8_t* msgbuf, int len)
         unlink(cpmPathFound(&era.find));
         name = doSearch(&era);
     }
+    if (rc > 0)
+    {
+        invalDirCache(era.drv);
+    }
     if (rc == 0)
     {
         msgbuf[0] = 255;
@@ -418,8 +486,8 @@ HostFileBdos::readSeq(uint8_t* msgbuf, int len)
     // uint8_t u = msgbuf[0] & 0x1f;
     struct fcb* fcb = (struct fcb*) &msgbuf[1];
     msgbuf[0] = 0;
-    int         fd  = getFileFcb(fcb);
-    if (fd < 0)
+    int         ix  = locFileFcb(fcb);
+    if (ix < 0 || openFiles[ix] < 0)
     {
         msgbuf[0] = 9;
         return 1;
@@ -428,10 +496,14 @@ HostFileBdos::readSeq(uint8_t* msgbuf, int len)
         fcb->cr != fcb->s1[0])
     {
         off_t len = fcb->cr;
-        len *= 128;
-        lseek(fd, len, SEEK_SET);
+        len             *= 128;
+        fileBufs[ix].pos = len;
+    }
+    int rc = readRec(ix, fileBufs[ix].pos, &msgbuf[37]);
+    if (rc > 0)
+    {
+        fileBufs[ix].pos += rc;
     }
-    ssize_t rc = read(fd, &msgbuf[37], 128);
     if (fcb->cr > 127)
     {
         fcb->cr   = 0;
@@ -462,13 +534,18 @@ HostFileBdos::writeSeq(uint8_t* msgbuf, int len)
     // uint8_t u = msgbuf[0] & 0x1f;
     struct fcb* fcb = (struct fcb*) &msgbuf[1];
     msgbuf[0] = 0;
-    int         fd  = getFileFcb(fcb);
-    if (fd <= 0)
+    int         ix  = locFileFcb(fcb);
+    if (ix < 0 || openFiles[ix] <= 0)
     {
         msgbuf[0] = 9;
         return 1;
     }
-    ssize_t rc = write(fd, &msgbuf[37], 128);
+    int rc = writeRec(ix, fileBufs[ix].pos, &msgbuf[37]);
+    if (rc > 0)
+    {
+        fileBufs[ix].pos += rc;
+    }
+    ++statGen;
     if (fcb->cr > 127)
     {
         fcb->cr   = 0;
@@ -545,6 +622,7 @@ HostFileBdos::renameFile(uint8_t* msgbuf, int len)
         msgbuf[0] = 255;
         return 1;
     }
+    invalDirCache(d);
     curLogVec |= (1 << d);
     return 1;
 }
@@ -555,15 +633,14 @@ HostFileBdos::readRand(uint8_t* msgbuf, int len)
     // uint8_t u = msgbuf[0] & 0x1f;
     struct fcb* fcb = (struct fcb*) &msgbuf[1];
     msgbuf[0] = 0;
-    int         fd  = getFileFcb(fcb);
-    if (fd < 0)
+    int         ix  = locFileFcb(fcb);
+    if (ix < 0 || openFiles[ix] < 0)
     {
         msgbuf[0] = 9;
         return 1;
     }
     seekFile(fcb);
-    ssize_t rc = read(fd, &msgbuf[37], 128);
-    seekFile(fcb);
+    int rc = readRec(ix, fileBufs[ix].pos, &msgbuf[37]);
     if (rc < 0)
     {
         msgbuf[0] = 255;
@@ -585,15 +662,15 @@ HostFileBdos::writeRand(uint8_t* msgbuf, int len)
     // uint8_t u = msgbuf[0] & 0x1f;
     struct fcb* fcb = (struct fcb*) &msgbuf[1];
     msgbuf[0] = 0;
-    int         fd  = getFileFcb(fcb);
-    if (fd < 0)
+    int         ix  = locFileFcb(fcb);
+    if (ix < 0 || openFiles[ix] < 0)
     {
         msgbuf[0] = 9;
         return 1;
     }
     seekFile(fcb);
-    ssize_t rc = write(fd, &msgbuf[37], 128);
-    seekFile(fcb);
+    int rc = writeRec(ix, fileBufs[ix].pos, &msgbuf[37]);
+    ++statGen;
     if (rc < 0)
     {
         msgbuf[0] = 255;
@@ -620,7 +697,7 @@ HostFileBdos::setRandRec(uint8_t* msgbuf, int len)
         msgbuf[0] = 9;
         return 1;
     }
-    off_t r = lseek(fd, (off_t) 0, SEEK_CUR);
+    off_t r = fileBufs[locFileFcb(fcb)].pos;
     if (r > 0x03ffff * 128)
     {
         r = 0x03ffff;
@@ -655,6 +732,7 @@ HostFileBdos::compFileSize(uint8_t* msgbuf, int len)
         fd = getFileFcb(fcb);
     }
     struct stat stb;
+    flushFile(locFileFcb(fcb));
     int         rc = fstat(fd, &stb);
     if (rc < 0)
     {
@@ -725,13 +803,27 @@ HostFileBdos::getFreeSp(uint8_t* msgbuf, int len)
     return 4;
 }
 int
-HostFileBdos::flushBuf(uint8_t* msgbuf, int len)
+HostFileBdos::setMultiCnt(uint8_t* msgbuf, int len)
 {
-    // nothing to do for us?
+    // Replies are limited to 256 bytes, so the client still moves one
+    // record per message. Only check the count, host I/O is buffered
+    // in DEF_BUFSZ pieces anyway.
+    uint8_t n = msgbuf[0];
+    if (n < 1 || n > 128)
+    {
+        msgbuf[0] = 255;
+        return 1;
+    }
     msgbuf[0] = 0;
     return 1;
 }
 int
+HostFileBdos::flushBuf(uint8_t* msgbuf, int len)
+{
+    msgbuf[0] = (flushAll() < 0 ? 255 : 0);
+    return 1;
+}
+int
 HostFileBdos::freeBlks(uint8_t* msgbuf, int len)
 {
     // nothing to do for us?
@@ -752,6 +844,8 @@ HostFileBdos::truncFile(uint8_t* msgbuf, int len)
         msgbuf[1] = 0;
         return 2;
     }
+    // may be open through another FCB.
+    flushAll();
     uint8_t d = fcb->drv;
     if (!d)
     {
@@ -779,6 +873,17 @@ HostFileBdos::truncFile(uint8_t* msgbuf, int len)
         return 2;
     }
     rc = truncate(pathName, r);
+    ++statGen;
+    // the file may be open through another FCB, what's buffered of it is
+    // stale now. Nothing is dirty after the flushAll().
+    for (int x = 0; x < DEF_NFILE; ++x)
+    {
+        if (openFiles[x] >= 0)
+        {
+            fileBufs[x].len    = 0;
+            fileBufs[x].loaded = 0;
+        }
+    }
     if (rc < 0)
     {
         msgbuf[0] = 0xff;
@@ -884,8 +989,8 @@ int(*HostFileBdos::bdosFunctions[256])(HostFileBdos *, uint8_t *, int) = {
 	readRand, writeRand, compFileSize, setRandRec, resetDrive, // 33-37
 	accessDrive, freeDrive, writeRandZF,			// 38-40
 	0,							// (41)
-	lockRec, unlockRec,					// 42-43
-	0, 0,							// (44-45)
+	lockRec, unlockRec, setMultiCnt,			// 42-44
+	0,							// (45)
 	getFreeSp,						// 46
 	0,							// (47)
 	flushBuf,						// 48
@@ -945,56 +1050,310 @@ HostFileBdos::cpmPathFound(struct search::find* find)
     return find->path;
 }
 
-// Not used, as init is automatic on Search First.
-void
-HostFileBdos::cpmFindInit(struct search::find* find, int drive, char* pattern)
+bool
+HostFileBdos::hostEntLess(const struct hostEnt& a, const struct hostEnt& b)
 {
-    if (find->dir)
+    return a.user != b.user ? a.user < b.user : a.base < b.base;
+}
+
+struct HostFileBdos::hostEnt*
+HostFileBdos::cpmEntFound(struct search::find* find)
+{
+    struct dirCache* dc = &dirCaches[find->drive];
+    if (find->cur < 0 || find->gen != dc->gen)
     {
-        closedir(find->dir);
+        return nullptr;
     }
+    return &dc->ents[find->cur];
+}
+
+void
+HostFileBdos::cpmFindInit(struct search::find* find, int drive, int user, char* pattern)
+{
     strncpy(find->pat, pattern, sizeof(find->pat));
     find->pat[sizeof(find->pat) - 1] = '\0';
+    find->drive                      = drive & 0x0f;
+    find->user                       = user;
+    find->literal                    = (strpbrk(find->pat, "*?[\\") == nullptr);
     find->dirlen                     = cpmDrive(find->path, drive);
-    find->dir                        = opendir(find->path);
-    // nullptr check done later...
-    if (!find->dir)
-    {
-        debugss(ssHostFileBdos, INFO, "no dir: %s\n", find->path);
-    }
+    find->cur                        = -1;
+    struct dirCache* dc = getDirCache(find->drive);
+    find->gen  = dc->gen;
+    find->next = seekDirCache(dc, user, find->literal ? find->pat : "", false);
 }
 
 const char*
 HostFileBdos::cpmFind(struct search::find* find)
 {
-    struct dirent* de;
-    if (!find->dir)
+    struct dirCache* dc = &dirCaches[find->drive];
+    if (!dc->exists)
     {
         errno = ENXIO;
         return nullptr;
     }
-    do
+    if (find->gen != dc->gen)
+    {
+        // Rescanned by another search (e.g. delete) while this one was
+        // in progress, pick up after the last name returned.
+        if (find->cur < 0)
+        {
+            find->next = seekDirCache(dc, find->user, find->literal ? find->pat : "", false);
+        }
+        else
+        {
+            struct hostEnt last;
+            makeHostEnt(&last, cpmNameFound(find));
+            find->next = seekDirCache(dc, last.user, last.base.c_str(), true);
+        }
+        find->gen = dc->gen;
+        find->cur = -1;
+    }
+    while (find->next < (int) dc->ents.size())
+    {
+        struct hostEnt* ent = &dc->ents[find->next++];
+        if (find->user >= 0 && ent->user != find->user)
+        {
+            break; // past this user's files
+        }
+        debugss(ssHostFileBdos, VERBOSE, "looking at %s... %s\n", ent->name.c_str(), find->pat);
+        if (find->literal)
+        {
+            if (ent->base != find->pat)
+            {
+                break;
+            }
+        }
+        else if (fnmatch(find->pat, ent->base.c_str(), 0) != 0)
+        {
+            continue;
+        }
+        find->cur = find->next - 1;
+        snprintf(find->path + find->dirlen, sizeof(find->path) - find->dirlen,
+                 "/%s", ent->name.c_str());
+        return cpmNameFound(find);
+    }
+    errno = ENOENT;
+    return nullptr;
+}
+
+// Returns the cached listing for a drive, rescanning it if anything changed.
+struct HostFileBdos::dirCache*
+HostFileBdos::getDirCache(int drive)
+{
+    struct dirCache* dc = &dirCaches[drive & 0x0f];
+    checkDirChanges();
+    if (dc->valid && notifyFd < 0)
     {
-        de = readdir(find->dir);
-        if (!de)
+        // No change notification, so fall back to the directory mtime.
+        // A change in the same second as the last scan can't be seen
+        // that way, so don't trust a listing until a second has passed.
+        struct stat stb;
+        char        path[sizeof(pathName)];
+        cpmDrive(path, drive);
+        if (stat(path, &stb) < 0 || stb.st_mtime >= dc->built)
         {
-            errno = ENOENT;
-            return nullptr;
+            dc->valid = 0;
         }
+        // nor is there any way to know if a file was written to.
+        ++statGen;
+    }
+    if (!dc->valid)
+    {
+        loadDirCache(dc, drive);
+    }
+    return dc;
+}
+
+void
+HostFileBdos::loadDirCache(struct dirCache* dc, int drive)
+{
+    char           path[sizeof(pathName)];
+    struct dirent* de;
+    struct hostEnt ent;
+
+    cpmDrive(path, drive);
+    dc->ents.clear();
+    ++dc->gen;
+#if defined(__linux__)
+    // watch first, so nothing done during the scan is missed.
+    if (notifyFd >= 0 && dc->wd < 0)
+    {
+        dc->wd = inotify_add_watch(notifyFd, path,
+                                   IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                   IN_MODIFY | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF);
+    }
+#endif
+    dc->built = time(nullptr);
+    DIR* d = opendir(path);
+    if (!d)
+    {
+        // leave invalid, the drive may be created later.
+        debugss(ssHostFileBdos, INFO, "no dir: %s\n", path);
+        dc->valid  = 0;
+        dc->exists = 0;
+        return;
+    }
+    while ((de = readdir(d)) != nullptr)
+    {
         if (de->d_name[0] == '.')
         {
             continue;
         }
-        debugss(ssHostFileBdos, INFO, "looking at %s... %s\n", de->d_name, find->pat);
-        // need to prevent "*.*" from matching all users!
-        if (fnmatch(find->pat, de->d_name, 0) == 0)
+        makeHostEnt(&ent, de->d_name);
+        dc->ents.push_back(ent);
+    }
+    closedir(d);
+    std::sort(dc->ents.begin(), dc->ents.end(), hostEntLess);
+    dc->valid  = 1;
+    dc->exists = 1;
+    debugss(ssHostFileBdos, INFO, "scanned %s: %d files\n", path, (int) dc->ents.size());
+}
+
+// Consume any pending inotify events, invalidating what they affect.
+void
+HostFileBdos::checkDirChanges()
+{
+#if defined(__linux__)
+    if (notifyFd < 0)
+    {
+        return;
+    }
+    char    buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    while ((n = read(notifyFd, buf, sizeof(buf))) > 0)
+    {
+        char* p = buf;
+        while (p < buf + n)
         {
-            break;
+            struct inotify_event* ev = (struct inotify_event*) p;
+            p += sizeof(*ev) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW)
+            {
+                for (int x = 0; x < 16; ++x)
+                {
+                    dirCaches[x].valid = 0;
+                }
+                ++statGen;
+                continue;
+            }
+            for (int x = 0; x < 16; ++x)
+            {
+                if (dirCaches[x].wd != ev->wd)
+                {
+                    continue;
+                }
+                if (ev->mask & (IN_MODIFY | IN_ATTRIB))
+                {
+                    ++statGen;
+                }
+                else
+                {
+                    dirCaches[x].valid = 0;
+                }
+                if (ev->mask & IN_IGNORED)
+                {
+                    dirCaches[x].wd = -1;
+                }
+            }
         }
     }
-    while (1);
-    sprintf(find->path + find->dirlen, "/%s", de->d_name);
-    return cpmNameFound(find);
+#endif
+}
+
+void
+HostFileBdos::invalDirCache(int drive)
+{
+    dirCaches[drive & 0x0f].valid = 0;
+}
+
+// Index of the first entry at or (if after) past the given name.
+// user < 0 means the start of the listing.
+int
+HostFileBdos::seekDirCache(struct dirCache* dc, int user, const char* base, bool after)
+{
+    if (user < 0)
+    {
+        return 0;
+    }
+    std::vector<struct hostEnt>::iterator it;
+    struct hostEnt                        key;
+    key.user = user;
+    key.base = base;
+    if (after)
+    {
+        it = std::upper_bound(dc->ents.begin(), dc->ents.end(), key, hostEntLess);
+    }
+    else
+    {
+        it = std::lower_bound(dc->ents.begin(), dc->ents.end(), key, hostEntLess);
+    }
+    return it - dc->ents.begin();
+}
+
+// Fill in size and timestamps of the current match, if not already known.
+void
+HostFileBdos::statHostEnt(struct search::find* find, struct hostEnt* ent)
+{
+    if (ent->statGen == statGen)
+    {
+        return;
+    }
+    struct stat stb;
+    if (stat(cpmPathFound(find), &stb) < 0)
+    {
+        memset(&stb, 0, sizeof(stb));
+    }
+    ent->size    = stb.st_size;
+    ent->atime   = stb.st_atime;
+    ent->mtime   = stb.st_mtime;
+    ent->statGen = statGen;
+}
+
+void
+HostFileBdos::makeHostEnt(struct hostEnt* ent, const char* name)
+{
+    const char* t = strchr(name, ':');
+    if (t)
+    {
+        ent->user = atoi(name);
+        ++t;
+    }
+    else
+    {
+        ent->user = 0;
+        t         = name;
+    }
+    ent->name    = name;
+    ent->base    = t;
+    ent->statGen = 0;
+    ent->size    = 0;
+    ent->atime   = 0;
+    ent->mtime   = 0;
+    int x = 0;
+    while (*t && *t != '.' && x < 8)
+    {
+        ent->fcbName[x++] = toupper(*t++);
+    }
+    while (x < 8)
+    {
+        ent->fcbName[x++] = ' ';
+    }
+    while (*t && *t != '.')
+    {
+        ++t;
+    }
+    if (*t == '.')
+    {
+        ++t;
+    }
+    while (*t && *t != '.' && x < 11)
+    {
+        ent->fcbName[x++] = toupper(*t++);
+    }
+    while (x < 11)
+    {
+        ent->fcbName[x++] = ' ';
+    }
 }
 
 void
@@ -1017,11 +1376,10 @@ HostFileBdos::getFileName(char* dst, struct fcb* fcb)
 }
 
 void
-HostFileBdos::getAmbFileName(char* dst, struct fcb* fcb, uint8_t usr)
+HostFileBdos::getAmbFileName(char* dst, struct fcb* fcb)
 {
     int   x;
-    char  buf[16];
-    char* s    = buf;
+    char* s    = dst;
     int   sawQ = 0;
     for (x = 0; x < 8 && (fcb->name[x] & 0x7f) != ' '; ++x)
     {
@@ -1055,52 +1413,14 @@ HostFileBdos::getAmbFileName(char* dst, struct fcb* fcb, uint8_t usr)
         *s++ = tolower(fcb->name[x] & 0x7f);
     }
     *s++ = '\0';
-    cpmFilename(dst, usr, buf);
 }
 
 void
-HostFileBdos::copyOutDir(uint8_t* dma, const char* name)
+HostFileBdos::copyOutDir(uint8_t* dma, struct hostEnt* ent)
 {
     struct fcb* fcb = (struct fcb*) dma;
-    const char* t;
-    t = strchr(name, ':');
-    uint8_t     u;
-    if (t)
-    {
-        u = atoi(name);
-        ++t;
-    }
-    else
-    {
-        u = 0;
-        t = name;
-    }
-    fcb->drv = u; // user code , not drive
-    int x = 0;
-    while (*t && *t != '.' && x < 8)
-    {
-        fcb->name[x++] = toupper(*t++);
-    }
-    while (x < 8)
-    {
-        fcb->name[x++] = ' ';
-    }
-    while (*t && *t != '.')
-    {
-        ++t;
-    }
-    if (*t == '.')
-    {
-        ++t;
-    }
-    while (*t && *t != '.' && x < 11)
-    {
-        fcb->name[x++] = toupper(*t++);
-    }
-    while (x < 11)
-    {
-        fcb->name[x++] = ' ';
-    }
+    fcb->drv = ent->user; // user code , not drive
+    memcpy(fcb->name, ent->fcbName, sizeof(fcb->name));
     fcb->ext   = 0;
     fcb->s1[0] = 0;
     fcb->s1[1] = 0;
@@ -1127,7 +1447,17 @@ HostFileBdos::copyOutSearch(uint8_t* buf, const char* name)
         memcpy(buf, &sFcb, 32);
         return curSearch.iter++ & 0x03; // should be "3"
     }
-    copyOutDir(buf, name);
+    struct hostEnt* ent = cpmEntFound(&curSearch.find);
+    if (ent)
+    {
+        copyOutDir(buf, ent);
+    }
+    else
+    {
+        struct hostEnt tmp;
+        makeHostEnt(&tmp, name);
+        copyOutDir(buf, &tmp);
+    }
     struct fcb* fcb = (struct fcb*) buf;
     // curSearch.size is only valid if curSearch.ext == '?'.
     if (curSearch.ext == '?')
@@ -1202,9 +1532,9 @@ HostFileBdos::commonSearch(struct search* search)
     }
     if (search->ext == '?') // this includes search->full
     {                       // return size of file... by some definition...
-        struct stat stb;
-        stat(cpmPathFound(&search->find), &stb);
-        search->size = stb.st_size;
+        struct hostEnt* ent = cpmEntFound(&search->find);
+        statHostEnt(&search->find, ent);
+        search->size = ent->size;
         if (search->full && search->cpm3)
         {
             // SFCB timestamps are only used if the
@@ -1213,9 +1543,9 @@ HostFileBdos::commonSearch(struct search* search)
             // extent info is not computed until copyOut.
             int x = search->iter & 0x03; // 0, 1, 2 only
             // order is imperative, overwrite seconds field
-            unix2cpmdate(stb.st_atime,
+            unix2cpmdate(ent->atime,
                          (struct cpmdate*) &sFcb.fcbs[x].atim);
-            unix2cpmdate(stb.st_mtime,
+            unix2cpmdate(ent->mtime,
                          (struct cpmdate*) &sFcb.fcbs[x].utim);
             sFcb.fcbs[x].pwmode = 0; // clear seconds overrun
         }
@@ -1265,7 +1595,8 @@ const char*
 HostFileBdos::startSearch(struct fcb* fcb, struct search* search, uint8_t u)
 {
     char    pat[16];
-    uint8_t d = fcb->drv & 0x7f;
+    int     user = u;
+    uint8_t d    = fcb->drv & 0x7f;
     search->iter = 0;
     if (d == '?')
     {
@@ -1274,6 +1605,7 @@ HostFileBdos::startSearch(struct fcb* fcb, struct search* search, uint8_t u)
         search->ext   = '?';
         search->maxdc = (search->cpm3 ? 3 : 4);
         d             = curDsk;
+        user          = -1; // every user's files
         pat[0]        = '*';
         pat[1]        = '\0';
     }
@@ -1290,25 +1622,25 @@ HostFileBdos::startSearch(struct fcb* fcb, struct search* search, uint8_t u)
         {
             --d;
         }
-        getAmbFileName(pat, fcb, u);
+        getAmbFileName(pat, fcb);
     }
     search->drv = d;
     search->usr = u;
-    cpmFindInit(&search->find, search->drv, pat);
+    cpmFindInit(&search->find, search->drv, user, pat);
     return commonSearch(search);
 }
 
 void
 HostFileBdos::seekFile(struct fcb* fcb)
 {
-    int fd = getFileFcb(fcb);
-    if (fd < 0)
+    int ix = locFileFcb(fcb);
+    if (ix < 0)
     {
         return;
     }
     off_t r = fcb->rr[0] | (fcb->rr[1] << 8) | ((fcb->rr[2] & 0x03) << 16);
     r         *= 128;
-    (void) lseek(fd, r, SEEK_SET);
+    fileBufs[ix].pos = r;
     fcb->s1[0] = fcb->cr;
 }
 
@@ -1350,12 +1682,24 @@ void
 HostFileBdos::putFileFcb(struct fcb* fcb, int ix, int fd)
 {
     openFiles[ix] = fd;
+    fileBufs[ix].pos    = 0;
+    fileBufs[ix].base   = 0;
+    fileBufs[ix].len    = 0;
+    fileBufs[ix].dlo    = 0;
+    fileBufs[ix].dhi    = 0;
+    fileBufs[ix].loaded = 0;
     if (fd < 0)
     {
+        free(fileBufs[ix].data);
+        fileBufs[ix].data = nullptr;
         fcb->fd = fcb->fd_ = 0;
     }
     else
     {
+        if (!fileBufs[ix].data)
+        {
+            fileBufs[ix].data = (uint8_t*) malloc(DEF_BUFSZ);
+        }
         fcb->fd  = ix;
         fcb->fd_ = ~ix;
     }
@@ -1394,6 +1738,129 @@ HostFileBdos::closeFileFcb(struct fcb* fcb)
     return rc < 0 ? -1 : x;
 }
 
+// Read the 128-byte record at 'pos' through the file's buffer.
+// Returns bytes read (less than 128 at EOF), or -1 on error.
+int
+HostFileBdos::readRec(int ix, off_t pos, uint8_t* dst)
+{
+    struct fileBuf* fb  = &fileBufs[ix];
+    off_t           off = pos - fb->base;
+    // hit if the whole record is buffered, or the buffer reaches EOF.
+    if (off < 0 || off >= DEF_BUFSZ || (off + 128 > fb->len && !(fb->loaded && fb->len < DEF_BUFSZ)))
+    {
+        if (flushFile(ix) < 0)
+        {
+            return -1;
+        }
+        ssize_t n = pread(openFiles[ix], fb->data, DEF_BUFSZ, pos);
+        fb->base   = pos;
+        fb->len    = (n < 0 ? 0 : n);
+        fb->loaded = (n >= 0);
+        if (n < 0)
+        {
+            return -1;
+        }
+        off = 0;
+    }
+    int n = fb->len - off;
+    if (n <= 0)
+    {
+        return 0;
+    }
+    if (n > 128)
+    {
+        n = 128;
+    }
+    memcpy(dst, fb->data + off, n);
+    return n;
+}
+
+// Write the record at 'pos' into the file's buffer, it reaches the
+// host file on flushFile(). Returns 128, or -1 if a flush failed.
+int
+HostFileBdos::writeRec(int ix, off_t pos, uint8_t* src)
+{
+    struct fileBuf* fb  = &fileBufs[ix];
+    off_t           off = pos - fb->base;
+    // Unless the buffer was read from the file, only what was written
+    // to it is known, so writes must extend that contiguously.
+    if (off < 0 || off + 128 > DEF_BUFSZ || (!fb->loaded && off > fb->len))
+    {
+        if (flushFile(ix) < 0)
+        {
+            return -1;
+        }
+        fb->base   = pos;
+        fb->len    = 0;
+        fb->loaded = 0;
+        off        = 0;
+    }
+    if (off > fb->len)
+    {
+        // past EOF, same as the hole the host would leave.
+        memset(fb->data + fb->len, 0, off - fb->len);
+    }
+    memcpy(fb->data + off, src, 128);
+    if (off + 128 > fb->len)
+    {
+        fb->len = off + 128;
+    }
+    if (fb->dlo >= fb->dhi)
+    {
+        fb->dlo = off;
+        fb->dhi = off + 128;
+    }
+    else
+    {
+        fb->dlo = std::min(fb->dlo, (int) off);
+        fb->dhi = std::max(fb->dhi, (int) off + 128);
+    }
+    return 128;
+}
+
+int
+HostFileBdos::flushFile(int ix)
+{
+    if (ix < 0)
+    {
+        return -1;
+    }
+    struct fileBuf* fb = &fileBufs[ix];
+    int             rc = 0;
+    while (fb->dlo < fb->dhi)
+    {
+        ssize_t n = pwrite(openFiles[ix], fb->data + fb->dlo, fb->dhi - fb->dlo,
+                           fb->base + fb->dlo);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            debugss(ssHostFileBdos, ERROR, "write-behind failed (%d)\n", errno);
+            rc = -1;
+            break;
+        }
+        fb->dlo += n;
+    }
+    fb->dlo = fb->dhi = 0;
+    return rc;
+}
+
+int
+HostFileBdos::flushAll()
+{
+    int rc = 0;
+    for (int x = 0; x < DEF_NFILE; ++x)
+    {
+        if (openFiles[x] >= 0 && flushFile(x) < 0)
+        {
+            rc = -1;
+        }
+    }
+    return rc;
+}
+
 // Returns CP/M File Id, or -1 on error.
 int
 HostFileBdos::openFileFcb(struct fcb* fcb, uint8_t u)
@@ -1483,6 +1950,7 @@ HostFileBdos::makeFileFcb(struct fcb* fcb, uint8_t u)
         }
         return -1;
     }
+    invalDirCache(d);
     putFileFcb(fcb, x, fd);
     curLogVec  |= (1 << d);
     fcb->ext    = 0;
@@ -14,7 +14,9 @@
 
 /// \cond
 #include <dirent.h>
+#include <pthread.h>
 #include <string>
+#include <vector>
 /// \endcond
 
 #define BDOS_FUNC(name)                                               \
@@ -37,7 +39,16 @@ class HostFileBdos: public NetworkServer
 
     virtual int checkRecvMsg(uint8_t clientId, uint8_t* msgbuf, int len) override;
     virtual int sendMsg(uint8_t* msgbuf, int len) override;
+
+    // Writes every instance's write-behind data to the host files, the
+    // destructors don't run when the emulator exits. Registered with atexit().
+    static void flushAtExit();
   private:
+    static std::vector<HostFileBdos*> instances;
+    static pthread_mutex_t            instancesMutex;
+
+    // held while a request runs, and from flushAtExit() on.
+    pthread_mutex_t reqMutex;
     char*   dir;
     uint8_t serverId;
     uint8_t clientId;
@@ -116,13 +127,58 @@ class HostFileBdos: public NetworkServer
         off_t   size;
         struct find
         {
-            DIR* dir;
-            char pat[16];
-            char path[1024];
-            int  dirlen;
+            int      drive;
+            int      user;    // -1 matches all users
+            int      next;    // next index in dirCaches[drive] to examine
+            int      cur;     // index of the last match, -1 if none
+            unsigned gen;     // dirCaches[drive].gen that next and cur refer to
+            uint8_t  literal; // pat has no wildcards
+            char     pat[16];
+            char     path[1024];
+            int      dirlen;
         } find;
     };
 
+    // One host file, as seen by searches. Listing is sorted by (user, base),
+    // so a search only looks at its own user's files.
+    struct hostEnt
+    {
+        std::string name;        // host name, including any "N:" prefix
+        std::string base;        // host name without the user prefix
+        uint8_t     user;
+        uint8_t     fcbName[11]; // base, already in CP/M 8.3 form
+        unsigned    statGen;     // size and times are valid if == statGen
+        off_t       size;
+        time_t      atime;
+        time_t      mtime;
+    };
+
+    // Cached listing of one drive directory, rebuilt on the next search
+    // after any create, rename or delete. On Linux, inotify catches
+    // changes made by the host, otherwise the directory mtime is checked.
+    struct dirCache
+    {
+        uint8_t              valid;
+        uint8_t              exists;
+        unsigned             gen;   // bumped on every rebuild
+        int                  wd;    // inotify watch, -1 if none
+        time_t               built;
+        std::vector<hostEnt> ents;
+    };
+
+    // Per open file read-ahead/write-behind buffer. Records are copied
+    // in and out of here, the host file only sees DEF_BUFSZ sized I/O.
+    struct fileBuf
+    {
+        off_t    pos;    // file position for sequential I/O
+        off_t    base;   // file offset of data[0]
+        int      len;    // bytes at the start of data[] that are valid
+        int      dlo;    // dirty range of data[], clean if dlo >= dhi
+        int      dhi;
+        uint8_t  loaded; // data[] was read from the file, len < DEF_BUFSZ means EOF
+        uint8_t* data;
+    };
+
     struct dpb
     {
         uint16_t spt;
@@ -141,6 +197,7 @@ class HostFileBdos: public NetworkServer
     static const int     DEF_BLS     = (1 << DEF_BLS_SH);
     static const int     DEF_NBLOCKS = 128; // keep alloc vec small, disk size 2M
     static const int     DEF_NFILE   = 32;  // Probably never need even 8.
+    static const int     DEF_BUFSZ   = 128 * 128; // max multi-sector count, in bytes
     static const uint8_t dirMode     = 0b01100001;
 
     static int(*bdosFunctions[256])(HostFileBdos*, uint8_t*, int);
@@ -155,9 +212,13 @@ class HostFileBdos: public NetworkServer
     struct dpb           curDpb;
     int                  phyExt; // phy ext size, recs
     int                  openFiles[DEF_NFILE];
+    struct fileBuf       fileBufs[DEF_NFILE];
     char                 fileName[sizeof((struct dirent*) 0)->d_name];
     char                 pathName[PATH_MAX];
     struct sfcb          sFcb;
+    struct dirCache      dirCaches[16];
+    unsigned             statGen; // bumped whenever a file size may have changed
+    int                  notifyFd;
 
     BDOS_FUNC(getDPB);
     BDOS_FUNC(writeProt);
@@ -185,6 +246,7 @@ class HostFileBdos: public NetworkServer
     BDOS_FUNC(writeRandZF);
     BDOS_FUNC(lockRec);
     BDOS_FUNC(unlockRec);
+    BDOS_FUNC(setMultiCnt);
     BDOS_FUNC(getFreeSp);
     BDOS_FUNC(flushBuf);
     BDOS_FUNC(freeBlks);
@@ -204,11 +266,20 @@ class HostFileBdos: public NetworkServer
     int cpmPath(char* buf, int drive, int user, char* file);
     char* cpmNameFound(struct search::find* find);
     char* cpmPathFound(struct search::find* find);
-    void cpmFindInit(struct search::find* find, int drive, char* pattern);
+    static bool hostEntLess(const struct hostEnt& a, const struct hostEnt& b);
+    struct hostEnt* cpmEntFound(struct search::find* find);
+    void cpmFindInit(struct search::find* find, int drive, int user, char* pattern);
     const char* cpmFind(struct search::find* find);
+    struct dirCache* getDirCache(int drive);
+    void loadDirCache(struct dirCache* dc, int drive);
+    void checkDirChanges();
+    void invalDirCache(int drive);
+    int seekDirCache(struct dirCache* dc, int user, const char* base, bool after);
+    void statHostEnt(struct search::find* find, struct hostEnt* ent);
+    void makeHostEnt(struct hostEnt* ent, const char* name);
     void getFileName(char* dst, struct fcb* fcb);
-    void getAmbFileName(char* dst, struct fcb* fcb, uint8_t usr);
-    void copyOutDir(uint8_t* dma, const char* name);
+    void getAmbFileName(char* dst, struct fcb* fcb);
+    void copyOutDir(uint8_t* dma, struct hostEnt* ent);
     int fullSearch(uint8_t* dirbuf, struct search* search, const char* ff);
     int copyOutSearch(uint8_t* buf, const char* name);
     const char* commonSearch(struct search* search);
@@ -221,6 +292,10 @@ class HostFileBdos: public NetworkServer
     void putFileFcb(struct fcb* fcb, int ix, int fd);
     int getFileFcb(struct fcb* fcb);
     int closeFileFcb(struct fcb* fcb);
+    int readRec(int ix, off_t pos, uint8_t* dst);
+    int writeRec(int ix, off_t pos, uint8_t* src);
+    int flushFile(int ix);
+    int flushAll();
     int makeFileFcb(struct fcb* fcb, uint8_t u);
     void unix2cpmdate(time_t unx, struct cpmdate* cpm);
 
@@ -0,0 +1,412 @@
+/// \file HostIOThread.cpp
+///
+/// Single per-process thread servicing all host file descriptors used by
+/// virtual devices.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#include "HostIOThread.h"
+
+#include "logger.h"
+
+/// \cond
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <vector>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+/// \endcond
+
+
+HostIOListener::HostIOListener(): wakeupPending_m(false)
+{
+
+}
+
+HostIOListener::~HostIOListener()
+{
+
+}
+
+void
+HostIOListener::ioWakeup()
+{
+
+}
+
+
+HostIOThread* HostIOThread::_inst = nullptr;
+
+HostIOThread::HostIOThread(): thread_m(0),
+                              running_m(false),
+                              epollFd_m(-1)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex_m, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    // writes to a disconnected socket or pty must fail with EPIPE, not end the process.
+    signal(SIGPIPE, SIG_IGN);
+
+    if (pipe(wakeFds_m) < 0)
+    {
+        debugss(ssHostIO, FATAL, "Unable to create wakeup pipe: %d\n", errno);
+        wakeFds_m[0] = wakeFds_m[1] = -1;
+        return;
+    }
+
+    fcntl(wakeFds_m[0], F_SETFL, O_NONBLOCK);
+    fcntl(wakeFds_m[1], F_SETFL, O_NONBLOCK);
+
+#if defined(__linux__)
+    epollFd_m = epoll_create1(0);
+
+    if (epollFd_m < 0)
+    {
+        debugss(ssHostIO, FATAL, "epoll_create1 failed: %d\n", errno);
+        return;
+    }
+
+    struct epoll_event ev = {};
+    ev.events  = EPOLLIN;
+    ev.data.fd = wakeFds_m[0];
+    epoll_ctl(epollFd_m, EPOLL_CTL_ADD, wakeFds_m[0], &ev);
+#endif
+}
+
+HostIOThread::~HostIOThread()
+{
+
+}
+
+HostIOThread*
+HostIOThread::instance(void)
+{
+    if (!_inst)
+    {
+        _inst = new HostIOThread();
+    }
+
+    return (_inst);
+}
+
+void*
+HostIOThread::threadFunc(void* arg)
+{
+    ((HostIOThread*) arg)->run();
+
+    return (nullptr);
+}
+
+bool
+HostIOThread::addListener(HostIOListener* listener)
+{
+    pthread_mutex_lock(&mutex_m);
+
+    listeners_m.remove(listener);
+    listeners_m.push_back(listener);
+
+    if (!running_m && wakeFds_m[0] >= 0)
+    {
+        // signals are already blocked in main() before devices are created, so the
+        // I/O thread never sees SIGALRM.
+        running_m = (pthread_create(&thread_m, nullptr, threadFunc, this) == 0);
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    return running_m;
+}
+
+bool
+HostIOThread::removeListener(HostIOListener* listener)
+{
+    pthread_mutex_lock(&mutex_m);
+
+    for (std::map<int, Source>::iterator it = sources_m.begin(); it != sources_m.end();)
+    {
+        if (it->second.listener == listener)
+        {
+#if defined(__linux__)
+            epoll_ctl(epollFd_m, EPOLL_CTL_DEL, it->first, nullptr);
+#endif
+            it = sources_m.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    listeners_m.remove(listener);
+
+    pthread_mutex_unlock(&mutex_m);
+
+    kick();
+
+    return true;
+}
+
+bool
+HostIOThread::addSource(int             fd,
+                        unsigned int    events,
+                        HostIOListener* listener)
+{
+    bool retVal = true;
+
+    addListener(listener);
+
+    pthread_mutex_lock(&mutex_m);
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+#if defined(__linux__)
+    struct epoll_event ev = {};
+    ev.events  = ((events & ioRead) ? EPOLLIN : 0) | ((events & ioWrite) ? EPOLLOUT : 0);
+    ev.data.fd = fd;
+
+    if (epoll_ctl(epollFd_m, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        debugss(ssHostIO, ERROR, "epoll_ctl(ADD, %d) failed: %d\n", fd, errno);
+        retVal = false;
+    }
+#endif
+
+    if (retVal)
+    {
+        sources_m[fd] = {events, listener};
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    kick();
+
+    return retVal;
+}
+
+bool
+HostIOThread::modifySource(int          fd,
+                           unsigned int events)
+{
+    bool retVal = false;
+
+    pthread_mutex_lock(&mutex_m);
+
+    std::map<int, Source>::iterator it = sources_m.find(fd);
+
+    if (it != sources_m.end())
+    {
+        retVal = true;
+
+        if (it->second.events != events)
+        {
+            it->second.events = events;
+#if defined(__linux__)
+            struct epoll_event ev = {};
+            ev.events  = ((events & ioRead) ? EPOLLIN : 0) | ((events & ioWrite) ? EPOLLOUT : 0);
+            ev.data.fd = fd;
+            epoll_ctl(epollFd_m, EPOLL_CTL_MOD, fd, &ev);
+#endif
+        }
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    kick();
+
+    return retVal;
+}
+
+bool
+HostIOThread::removeSource(int fd)
+{
+    pthread_mutex_lock(&mutex_m);
+
+    bool retVal = (sources_m.erase(fd) != 0);
+
+#if defined(__linux__)
+    if (retVal)
+    {
+        epoll_ctl(epollFd_m, EPOLL_CTL_DEL, fd, nullptr);
+    }
+#endif
+
+    pthread_mutex_unlock(&mutex_m);
+
+    kick();
+
+    return retVal;
+}
+
+void
+HostIOThread::wakeup(HostIOListener* listener)
+{
+    if (!listener->wakeupPending_m.exchange(true))
+    {
+        static const char ch = 'w';
+
+        // pipe is non-blocking, if it's full the I/O thread is already awake.
+        if (write(wakeFds_m[1], &ch, 1) < 0 && errno != EAGAIN)
+        {
+            debugss(ssHostIO, ERROR, "wakeup write failed: %d\n", errno);
+        }
+    }
+}
+
+/// With epoll, the kernel interest list is updated directly, only the poll()
+/// version needs to rebuild its fd list.
+void
+HostIOThread::kick()
+{
+#if !defined(__linux__)
+    static const char ch = 'k';
+
+    if (running_m && pthread_self() != thread_m)
+    {
+        write(wakeFds_m[1], &ch, 1);
+    }
+#endif
+}
+
+void
+HostIOThread::dispatchWakeups()
+{
+    char buf[64];
+
+    while (read(wakeFds_m[0], buf, sizeof(buf)) > 0)
+    {
+    }
+
+    pthread_mutex_lock(&mutex_m);
+
+    std::list<HostIOListener*>::iterator it = listeners_m.begin();
+
+    while (it != listeners_m.end())
+    {
+        // advance first, the listener may remove itself.
+        HostIOListener* listener = *it++;
+
+        if (listener->wakeupPending_m.exchange(false))
+        {
+            listener->ioWakeup();
+        }
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+}
+
+void
+HostIOThread::dispatch(int  fd,
+                       bool readable,
+                       bool writable,
+                       bool hangup)
+{
+    pthread_mutex_lock(&mutex_m);
+
+    std::map<int, Source>::iterator it = sources_m.find(fd);
+
+    // may have been removed by an earlier callback in the same batch.
+    if (it != sources_m.end())
+    {
+        it->second.listener->ioReady(fd, readable, writable, hangup);
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+}
+
+void
+HostIOThread::run()
+{
+    debugss(ssHostIO, INFO, "I/O thread started\n");
+
+#if defined(__linux__)
+    static const int   maxEvents_c = 16;
+    struct epoll_event events[maxEvents_c];
+
+    while (true)
+    {
+        int num = epoll_wait(epollFd_m, events, maxEvents_c, -1);
+
+        if (num < 0)
+        {
+            if (errno != EINTR)
+            {
+                debugss(ssHostIO, ERROR, "epoll_wait failed: %d\n", errno);
+            }
+
+            continue;
+        }
+
+        for (int x = 0; x < num; ++x)
+        {
+            int fd = events[x].data.fd;
+
+            if (fd == wakeFds_m[0])
+            {
+                dispatchWakeups();
+                continue;
+            }
+
+            dispatch(fd,
+                     (events[x].events & EPOLLIN) != 0,
+                     (events[x].events & EPOLLOUT) != 0,
+                     (events[x].events & (EPOLLHUP | EPOLLERR)) != 0);
+        }
+    }
+#else
+    std::vector<struct pollfd> fds;
+
+    while (true)
+    {
+        fds.clear();
+        fds.push_back({wakeFds_m[0], POLLIN, 0});
+
+        pthread_mutex_lock(&mutex_m);
+
+        for (std::map<int, Source>::iterator it = sources_m.begin(); it != sources_m.end(); ++it)
+        {
+            short events = ((it->second.events & ioRead) ? POLLIN : 0) |
+                           ((it->second.events & ioWrite) ? POLLOUT : 0);
+            fds.push_back({it->first, events, 0});
+        }
+
+        pthread_mutex_unlock(&mutex_m);
+
+        if (poll(&fds[0], fds.size(), -1) < 0)
+        {
+            if (errno != EINTR)
+            {
+                debugss(ssHostIO, ERROR, "poll failed: %d\n", errno);
+            }
+
+            continue;
+        }
+
+        if (fds[0].revents != 0)
+        {
+            dispatchWakeups();
+        }
+
+        for (int x = 1; x < fds.size(); ++x)
+        {
+            if (fds[x].revents != 0)
+            {
+                dispatch(fds[x].fd,
+                         (fds[x].revents & POLLIN) != 0,
+                         (fds[x].revents & POLLOUT) != 0,
+                         (fds[x].revents & (POLLHUP | POLLERR)) != 0);
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,112 @@
+/// \file HostIOThread.h
+///
+/// Single per-process thread servicing all host file descriptors used by
+/// virtual devices (serial port bridges, sockets, ...), so the CPU thread never
+/// blocks on host I/O.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#ifndef HOSTIOTHREAD_H_
+#define HOSTIOTHREAD_H_
+
+/// \cond
+#include <atomic>
+#include <list>
+#include <map>
+#include <pthread.h>
+/// \endcond
+
+class HostIOThread;
+
+///
+/// \brief Receives callbacks from the HostIOThread.
+///
+/// All callbacks are made on the I/O thread.
+///
+class HostIOListener
+{
+  public:
+    HostIOListener();
+    virtual ~HostIOListener();
+
+    /// A registered file descriptor is ready.
+    virtual void ioReady(int  fd,
+                         bool readable,
+                         bool writable,
+                         bool hangup) = 0;
+
+    /// Requested by HostIOThread::wakeup() from another thread.
+    virtual void ioWakeup();
+
+  private:
+    friend class HostIOThread;
+    std::atomic_bool wakeupPending_m;
+};
+
+///
+/// \class HostIOThread
+///
+/// \brief Event loop for host I/O. This is a singleton.
+///
+/// Uses epoll on Linux, and poll() elsewhere.
+///
+class HostIOThread
+{
+  public:
+    static HostIOThread* instance(void);
+
+    static const unsigned int ioRead  = 0x01;
+    static const unsigned int ioWrite = 0x02;
+
+    bool addListener(HostIOListener* listener);
+    bool removeListener(HostIOListener* listener);
+
+    bool addSource(int             fd,
+                   unsigned int    events,
+                   HostIOListener* listener);
+    bool modifySource(int          fd,
+                      unsigned int events);
+    bool removeSource(int fd);
+
+    /// Safe to call from any thread, without taking any locks. Multiple calls
+    /// before the I/O thread runs result in one ioWakeup() call.
+    void wakeup(HostIOListener* listener);
+
+  private:
+    HostIOThread();
+    ~HostIOThread();
+
+    /// use C++11 to avoid having to define copy constructor
+    HostIOThread(HostIOThread const&)            = delete;
+    HostIOThread& operator=(HostIOThread const&) = delete;
+
+    static HostIOThread* _inst;
+
+    static void* threadFunc(void* arg);
+    void run();
+    void kick();
+    void dispatchWakeups();
+    void dispatch(int  fd,
+                  bool readable,
+                  bool writable,
+                  bool hangup);
+
+    struct Source
+    {
+        unsigned int    events;
+        HostIOListener* listener;
+    };
+
+    /// Recursive, so listeners may add/modify/remove sources from their callbacks.
+    pthread_mutex_t            mutex_m;
+    pthread_t                  thread_m;
+    bool                       running_m;
+    int                        wakeFds_m[2];
+    int                        epollFd_m;
+    std::map<int, Source>      sources_m;
+    std::list<HostIOListener*> listeners_m;
+};
+
+#endif // HOSTIOTHREAD_H_
@@ -0,0 +1,631 @@
+/// \file HostSerialPort.cpp
+///
+/// Connects a virtual serial port (INS8250) to a host pty, FIFO, Unix domain
+/// socket or file.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#include "HostSerialPort.h"
+
+#include "INS8250.h"
+#include "WallClock.h"
+#include "logger.h"
+
+/// \cond
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+/// \endcond
+
+
+HostSerialPort::HostSerialPort(std::string name): ClockUser(true),
+                                                  name_m(name),
+                                                  type_m(ht_None),
+                                                  uart_m(nullptr),
+                                                  rxFd_m(-1),
+                                                  txFd_m(-1),
+                                                  listenFd_m(-1),
+                                                  ptySlaveFd_m(-1),
+                                                  rxStalled_m(false),
+                                                  txBlocked_m(false),
+                                                  txPendingLen_m(0),
+                                                  txPendingOff_m(0),
+                                                  nextRxClock_m(0)
+{
+
+}
+
+HostSerialPort::~HostSerialPort()
+{
+    HostIOThread::instance()->removeListener(this);
+
+    if (rxFd_m >= 0)
+    {
+        close(rxFd_m);
+    }
+
+    if (txFd_m >= 0 && txFd_m != rxFd_m)
+    {
+        close(txFd_m);
+    }
+
+    if (listenFd_m >= 0)
+    {
+        close(listenFd_m);
+        unlink(path_m.c_str());
+    }
+
+    if (ptySlaveFd_m >= 0)
+    {
+        close(ptySlaveFd_m);
+
+        if (!path_m.empty())
+        {
+            unlink(path_m.c_str());
+        }
+    }
+}
+
+HostSerialPort*
+HostSerialPort::install_HostSerialPort(PropertyUtil::PropertyMapT& props,
+                                       std::string                 name)
+{
+    std::string s = props[name];
+
+    if (s.empty())
+    {
+        return nullptr;
+    }
+
+    HostSerialPort* hsp = new HostSerialPort(name);
+
+    if (!hsp->open(PropertyUtil::splitArgs(s)))
+    {
+        debugss(ssHostIO, ERROR, "%s: unable to open \"%s\"\n", name.c_str(), s.c_str());
+        delete hsp;
+        return nullptr;
+    }
+
+    return hsp;
+}
+
+bool
+HostSerialPort::open(std::vector<std::string> args)
+{
+    if (args.size() < 1)
+    {
+        return false;
+    }
+
+    if (args[0].compare("pty") == 0)
+    {
+        return openPty(args);
+    }
+
+    if (args[0].compare("fifo") == 0)
+    {
+        return openFifo(args);
+    }
+
+    if (args[0].compare("unix") == 0)
+    {
+        return openUnix(args);
+    }
+
+    if (args[0].compare("file") == 0)
+    {
+        return openFile(args);
+    }
+
+    debugss(ssHostIO, ERROR, "%s: unknown type %s\n", name_m.c_str(), args[0].c_str());
+
+    return false;
+}
+
+bool
+HostSerialPort::openPty(std::vector<std::string>& args)
+{
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0)
+    {
+        debugss(ssHostIO, ERROR, "%s: unable to create pty: %d\n", name_m.c_str(), errno);
+
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+
+        return false;
+    }
+
+    const char* slave = ptsname(fd);
+
+    ptySlaveFd_m = ::open(slave, O_RDWR | O_NOCTTY);
+
+    if (ptySlaveFd_m >= 0)
+    {
+        struct termios tio;
+
+        // binary transfers (XMODEM, etc.) must pass through untouched.
+        tcgetattr(ptySlaveFd_m, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(ptySlaveFd_m, TCSANOW, &tio);
+    }
+
+    if (args.size() > 1)
+    {
+        path_m = args[1];
+        unlink(path_m.c_str());
+
+        if (symlink(slave, path_m.c_str()) < 0)
+        {
+            debugss(ssHostIO, ERROR, "%s: unable to link %s to %s\n", name_m.c_str(),
+                    path_m.c_str(), slave);
+            path_m.clear();
+        }
+    }
+
+    debugss(ssHostIO, INFO, "%s: connected to %s\n", name_m.c_str(), slave);
+
+    type_m = ht_Pty;
+    rxFd_m = txFd_m = fd;
+
+    return HostIOThread::instance()->addSource(fd, HostIOThread::ioRead, this);
+}
+
+bool
+HostSerialPort::openFifo(std::vector<std::string>& args)
+{
+    if (args.size() < 2)
+    {
+        return false;
+    }
+
+    for (int x = 1; x < args.size() && x < 3; ++x)
+    {
+        if (mkfifo(args[x].c_str(), 0666) < 0 && errno != EEXIST)
+        {
+            debugss(ssHostIO, ERROR, "%s: unable to create fifo %s: %d\n", name_m.c_str(),
+                    args[x].c_str(), errno);
+            return false;
+        }
+
+        // Open read-write, so neither side sees EOF/hangup when the other end
+        // is not open, and opening does not block.
+        int fd = ::open(args[x].c_str(), O_RDWR | O_NONBLOCK);
+
+        if (fd < 0)
+        {
+            debugss(ssHostIO, ERROR, "%s: unable to open fifo %s: %d\n", name_m.c_str(),
+                    args[x].c_str(), errno);
+            return false;
+        }
+
+        if (x == 1)
+        {
+            txFd_m = fd;
+        }
+        else
+        {
+            rxFd_m = fd;
+        }
+    }
+
+    type_m = ht_Fifo;
+
+    if (!HostIOThread::instance()->addSource(txFd_m, 0, this))
+    {
+        return false;
+    }
+
+    return (rxFd_m < 0) || HostIOThread::instance()->addSource(rxFd_m, HostIOThread::ioRead, this);
+}
+
+bool
+HostSerialPort::openUnix(std::vector<std::string>& args)
+{
+    struct sockaddr_un addr;
+
+    if (args.size() < 2 || args[1].length() >= sizeof(addr.sun_path))
+    {
+        return false;
+    }
+
+    listenFd_m = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listenFd_m < 0)
+    {
+        return false;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, args[1].c_str(), sizeof(addr.sun_path) - 1);
+    path_m          = args[1];
+    unlink(path_m.c_str());
+
+    if (bind(listenFd_m, (struct sockaddr*) &addr, sizeof(addr)) < 0 ||
+        listen(listenFd_m, 1) < 0)
+    {
+        debugss(ssHostIO, ERROR, "%s: unable to listen on %s: %d\n", name_m.c_str(),
+                path_m.c_str(), errno);
+        close(listenFd_m);
+        listenFd_m = -1;
+        return false;
+    }
+
+    debugss(ssHostIO, INFO, "%s: listening on %s\n", name_m.c_str(), path_m.c_str());
+
+    type_m = ht_Unix;
+
+    return HostIOThread::instance()->addSource(listenFd_m, HostIOThread::ioRead, this);
+}
+
+bool
+HostSerialPort::openFile(std::vector<std::string>& args)
+{
+    if (args.size() < 2)
+    {
+        return false;
+    }
+
+    int flags = O_WRONLY | O_CREAT;
+
+    if (args.size() > 2 && args[2].compare("append") == 0)
+    {
+        flags |= O_APPEND;
+    }
+    else
+    {
+        flags |= O_TRUNC;
+    }
+
+    txFd_m = ::open(args[1].c_str(), flags, 0644);
+
+    if (txFd_m < 0)
+    {
+        debugss(ssHostIO, ERROR, "%s: unable to open %s: %d\n", name_m.c_str(),
+                args[1].c_str(), errno);
+        return false;
+    }
+
+    type_m = ht_File;
+
+    // regular files can't be polled, output is written from ioWakeup().
+    return HostIOThread::instance()->addListener(this);
+}
+
+void
+HostSerialPort::attachPort(INS8250* port)
+{
+    SerialPortDevice::attachPort(port);
+    uart_m = port;
+
+    WallClock::instance()->requestHostWork();
+}
+
+unsigned int
+HostSerialPort::getBaudRate()
+{
+    // Pacing is done by notification(), the host side has no baud rate.
+    return SerialPortDevice::DISABLE_BAUD_CHECK;
+}
+
+///
+/// Called on the CPU thread when the guest transmits a byte.
+///
+void
+HostSerialPort::receiveData(BYTE data)
+{
+    if (!txQueue_m.push(data))
+    {
+        debugss(ssHostIO, WARNING, "%s: transmit queue overflow\n", name_m.c_str());
+        return;
+    }
+
+    // pairs with the fence in flushTx(), so a blocked flag cleared there is
+    // either seen here, or this byte is seen there.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // if blocked, the I/O thread will flush when the host fd becomes writable.
+    if (!txBlocked_m)
+    {
+        HostIOThread::instance()->wakeup(this);
+    }
+}
+
+///
+/// Polled after every instruction while bytes are received, hands the next one
+/// to the UART once the previous one was read and a character time has passed.
+///
+void
+HostSerialPort::notification(unsigned int cycleCount)
+{
+    if (uart_m == nullptr || rxQueue_m.empty())
+    {
+        return;
+    }
+
+    WallClock::instance()->requestHostWork();
+
+    unsigned long long now = WallClock::instance()->getClock();
+
+    if (now < nextRxClock_m || !sendReady())
+    {
+        return;
+    }
+
+    BYTE ch;
+
+    rxQueue_m.pop(ch);
+    sendData(ch);
+
+    // 1 start, 8 data and 1 stop bit.
+    unsigned int baud = uart_m->getBaudRate();
+    nextRxClock_m = now;
+
+    if (baud != 0)
+    {
+        nextRxClock_m += WallClock::instance()->getTicksPerSecond() * 10 / baud;
+    }
+
+    if (rxStalled_m && rxQueue_m.space() >= queueSize_c / 2)
+    {
+        HostIOThread::instance()->wakeup(this);
+    }
+}
+
+void
+HostSerialPort::ioReady(int  fd,
+                        bool readable,
+                        bool writable,
+                        bool hangup)
+{
+    if (fd == listenFd_m)
+    {
+        acceptClient();
+        return;
+    }
+
+    if (fd == txFd_m && writable)
+    {
+        flushTx();
+    }
+
+    if (fd == rxFd_m && (readable || hangup))
+    {
+        // a hangup is reported by read() returning 0 or an error.
+        fillRx();
+    }
+    else if (hangup && type_m == ht_Unix)
+    {
+        closeClient();
+    }
+}
+
+void
+HostSerialPort::ioWakeup()
+{
+    flushTx();
+
+    if (rxStalled_m && rxQueue_m.space() >= queueSize_c / 2)
+    {
+        rxStalled_m = false;
+        updateInterest();
+        fillRx();
+    }
+}
+
+void
+HostSerialPort::acceptClient()
+{
+    int fd = accept(listenFd_m, nullptr, nullptr);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    if (rxFd_m >= 0)
+    {
+        // only one connection at a time, like a real serial line.
+        close(fd);
+        return;
+    }
+
+    debugss(ssHostIO, INFO, "%s: client connected\n", name_m.c_str());
+
+    rxFd_m      = txFd_m = fd;
+    rxStalled_m = false;
+    txBlocked_m = false;
+
+    HostIOThread::instance()->addSource(fd, HostIOThread::ioRead, this);
+
+    // send anything the guest wrote while no one was connected.
+    flushTx();
+}
+
+void
+HostSerialPort::closeClient()
+{
+    if (rxFd_m < 0)
+    {
+        return;
+    }
+
+    debugss(ssHostIO, INFO, "%s: client disconnected\n", name_m.c_str());
+
+    HostIOThread::instance()->removeSource(rxFd_m);
+    close(rxFd_m);
+
+    rxFd_m         = txFd_m = -1;
+    rxStalled_m    = false;
+    txBlocked_m    = false;
+    txPendingLen_m = txPendingOff_m = 0;
+}
+
+void
+HostSerialPort::fillRx()
+{
+    BYTE buf[512];
+
+    while (rxFd_m >= 0)
+    {
+        unsigned int space = rxQueue_m.space();
+
+        if (space == 0)
+        {
+            rxStalled_m = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (rxQueue_m.space() == 0)
+            {
+                // stop reading, the CPU thread wakes us when there is room.
+                updateInterest();
+                return;
+            }
+
+            rxStalled_m = false;
+            continue;
+        }
+
+        ssize_t num = read(rxFd_m, buf, (space < sizeof(buf)) ? space : sizeof(buf));
+
+        if (num > 0)
+        {
+            rxQueue_m.write(buf, num);
+            WallClock::instance()->requestHostWork();
+            continue;
+        }
+
+        if (num < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (num < 0 && errno == EAGAIN)
+        {
+            return;
+        }
+
+        // EOF or error
+        if (type_m == ht_Unix)
+        {
+            closeClient();
+        }
+        else
+        {
+            debugss(ssHostIO, ERROR, "%s: read failed: %d\n", name_m.c_str(), errno);
+            HostIOThread::instance()->removeSource(rxFd_m);
+        }
+
+        return;
+    }
+}
+
+void
+HostSerialPort::flushTx()
+{
+    if (txFd_m < 0)
+    {
+        // nothing connected, data is lost, just like a real serial line.
+        while (txQueue_m.read(txPending_m, sizeof(txPending_m)) != 0)
+        {
+        }
+
+        return;
+    }
+
+    do
+    {
+        while (true)
+        {
+            if (txPendingOff_m == txPendingLen_m)
+            {
+                txPendingOff_m = 0;
+                txPendingLen_m = txQueue_m.read(txPending_m, sizeof(txPending_m));
+
+                if (txPendingLen_m == 0)
+                {
+                    break;
+                }
+            }
+
+            ssize_t num = write(txFd_m, &txPending_m[txPendingOff_m],
+                                txPendingLen_m - txPendingOff_m);
+
+            if (num > 0)
+            {
+                txPendingOff_m += num;
+                continue;
+            }
+
+            if (num < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (num < 0 && errno == EAGAIN)
+            {
+                if (!txBlocked_m)
+                {
+                    txBlocked_m = true;
+                    updateInterest();
+                }
+
+                return;
+            }
+
+            debugss(ssHostIO, ERROR, "%s: write failed: %d\n", name_m.c_str(), errno);
+
+            if (type_m == ht_Unix)
+            {
+                closeClient();
+            }
+
+            txPendingLen_m = txPendingOff_m = 0;
+            return;
+        }
+
+        if (txBlocked_m)
+        {
+            txBlocked_m = false;
+            updateInterest();
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    while (!txQueue_m.empty());
+}
+
+void
+HostSerialPort::updateInterest()
+{
+    HostIOThread* io = HostIOThread::instance();
+
+    if (rxFd_m >= 0 && rxFd_m == txFd_m)
+    {
+        io->modifySource(rxFd_m, (rxStalled_m ? 0 : HostIOThread::ioRead) |
+                         (txBlocked_m ? HostIOThread::ioWrite : 0));
+        return;
+    }
+
+    if (rxFd_m >= 0)
+    {
+        io->modifySource(rxFd_m, rxStalled_m ? 0 : HostIOThread::ioRead);
+    }
+
+    if (txFd_m >= 0 && type_m != ht_File)
+    {
+        io->modifySource(txFd_m, txBlocked_m ? HostIOThread::ioWrite : 0);
+    }
+}
@@ -0,0 +1,119 @@
+/// \file HostSerialPort.h
+///
+/// Connects a virtual serial port (INS8250) to a host pty, FIFO, Unix domain
+/// socket or file.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#ifndef HOSTSERIALPORT_H_
+#define HOSTSERIALPORT_H_
+
+#include "SerialPortDevice.h"
+#include "ClockUser.h"
+#include "HostIOThread.h"
+#include "RingBuffer.h"
+#include "propertyutil.h"
+
+/// \cond
+#include <string>
+#include <vector>
+/// \endcond
+
+///
+/// \class HostSerialPort
+///
+/// \brief Bridge between a virtual serial port and a host file descriptor.
+///
+/// All host I/O is done on the HostIOThread. Data moves to and from the CPU
+/// thread through lock-free queues. Received data is handed to the UART at the
+/// UART's programmed baud rate, from the CPU thread via ClockUser::notification().
+///
+/// Property syntax:
+///
+///     <name> = pty [<symlink>]
+///     <name> = fifo <to-host-path> [<from-host-path>]
+///     <name> = unix <socket-path>
+///     <name> = file <path> [append]
+///
+class HostSerialPort: public SerialPortDevice, public ClockUser, public HostIOListener
+{
+  public:
+    HostSerialPort(std::string name);
+    virtual ~HostSerialPort() override;
+
+    static HostSerialPort* install_HostSerialPort(PropertyUtil::PropertyMapT& props,
+                                                  std::string                 name);
+
+    bool open(std::vector<std::string> args);
+
+    virtual void attachPort(INS8250* port) override;
+    virtual void receiveData(BYTE data) override;
+    virtual unsigned int getBaudRate() override;
+
+    virtual void notification(unsigned int cycleCount) override;
+
+    virtual void ioReady(int  fd,
+                         bool readable,
+                         bool writable,
+                         bool hangup) override;
+    virtual void ioWakeup() override;
+
+  private:
+    enum HostType
+    {
+        ht_None,
+        ht_Pty,
+        ht_Fifo,
+        ht_Unix,
+        ht_File
+    };
+
+    bool openPty(std::vector<std::string>& args);
+    bool openFifo(std::vector<std::string>& args);
+    bool openUnix(std::vector<std::string>& args);
+    bool openFile(std::vector<std::string>& args);
+
+    void acceptClient();
+    void closeClient();
+    void fillRx();
+    void flushTx();
+    void updateInterest();
+
+    std::string                 name_m;
+    HostType                    type_m;
+    INS8250*                    uart_m;
+
+    /// fd data from the host is read from, -1 if none.
+    int                         rxFd_m;
+    /// fd data to the host is written to, -1 if none.
+    int                         txFd_m;
+    /// listening socket for ht_Unix
+    int                         listenFd_m;
+    /// slave side of ht_Pty, kept open so the master never sees hangup.
+    int                         ptySlaveFd_m;
+    std::string                 path_m;
+
+    static const unsigned int   queueSize_c = 4096;
+
+    /// host to guest, I/O thread produces, CPU thread consumes.
+    RingBuffer<queueSize_c>     rxQueue_m;
+    /// guest to host, CPU thread produces, I/O thread consumes.
+    RingBuffer<queueSize_c>     txQueue_m;
+
+    /// I/O thread stopped reading because rxQueue_m was full.
+    std::atomic_bool            rxStalled_m;
+    /// host fd would block, waiting for it to become writable.
+    std::atomic_bool            txBlocked_m;
+
+    /// data taken from txQueue_m, not yet accepted by the host fd (I/O thread only).
+    BYTE                        txPending_m[512];
+    unsigned int                txPendingLen_m;
+    unsigned int                txPendingOff_m;
+
+    /// earliest clock a received byte may be given to the UART.
+    unsigned long long          nextRxClock_m;
+};
+
+#endif // HOSTSERIALPORT_H_
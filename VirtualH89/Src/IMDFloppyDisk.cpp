@@ -9,13 +9,17 @@
 
 #include "Track.h"
 #include "Sector.h"
+#include "DiskImageCache.h"
 
 #include "GenericFloppyFormat.h"
 #include "logger.h"
 
 /// \cond
+#include <algorithm>
 #include <fstream>
 #include <memory>
+#include <string.h>
+#include <utility>
 /// \endcond
 
 using namespace std;
@@ -40,14 +44,19 @@ IMDFloppyDisk::IMDFloppyDisk(vector<string> argv): GenericFloppyDisk(),
                                                    dataPos_m(0),
                                                    sectorLength_m(0),
                                                    secLenCode_m(0),
-                                                   ready_m(true)
+                                                   ready_m(true),
+                                                   journal_m(argv.size() > 0 ?
+                                                             argv[0] + ".journal" : ""),
+                                                   dirty_m(false)
 {
     if (argv.size() < 1)
     {
         debugss(ssFloppyDisk, WARNING, "no file specified\n");
+        ready_m = false;
         return;
     }
 
+    imageName_m = argv[0];
     string name(argv[0]);
     debugss(ssFloppyDisk, INFO, "reading: %s\n", name.c_str());
 
@@ -59,16 +68,248 @@ IMDFloppyDisk::IMDFloppyDisk(vector<string> argv): GenericFloppyDisk(),
         }
     }
 
-    if (!readIMD(name.c_str()))
+    DiskImageCache cache(name);
+
+    if (!loadCached(cache))
     {
-        ready_m = false;
-        debugss(ssFloppyDisk, ERROR, "Read of file %s failed\n", name.c_str());
+        if (!readIMD(name.c_str()))
+        {
+            ready_m = false;
+            debugss(ssFloppyDisk, ERROR, "Read of file %s failed\n", name.c_str());
+            return;
+        }
+
+        storeCached(cache);
+    }
+
+    replayJournal();
+}
+
+bool
+IMDFloppyDisk::loadCached(DiskImageCache& cache)
+{
+    DiskImageCache::Geometry          geom;
+    vector<shared_ptr<Track> >        tracks;
+    vector<DiskImageCache::SourceRef> refs;
+
+    if (!cache.load(geom, tracks, refs, arena_m))
+    {
+        return false;
+    }
+
+    size_t ref = 0;
+
+    for (size_t x = 0; x < tracks.size(); ++x)
+    {
+        vector<Sector>& sectors = tracks[x]->getSectors();
+
+        if (tracks[x]->getSideNumber() < maxHeads_c)
+        {
+            tracks_m[tracks[x]->getSideNumber()].push_back(tracks[x]);
+        }
+
+        for (size_t y = 0; y < sectors.size() && ref < refs.size(); ++y, ++ref)
+        {
+            imageSectors_m.push_back({&sectors[y], refs[ref].offset, refs[ref].length, false});
+        }
     }
+
+    // compact() walks the records in file order.
+    sort(imageSectors_m.begin(), imageSectors_m.end(),
+         [](const ImageSector& a, const ImageSector& b) {
+        return a.offset < b.offset;
+    });
+
+    for (size_t x = 0; x < imageSectors_m.size(); ++x)
+    {
+        sectorIndex_m[imageSectors_m[x].sector] = x;
+    }
+
+    numTracks_m     = geom.numTracks;
+    doubleDensity_m = geom.doubleDensity;
+
+    return true;
+}
+
+void
+IMDFloppyDisk::storeCached(DiskImageCache& cache)
+{
+    DiskImageCache::Geometry          geom;
+    vector<shared_ptr<Track> >        tracks;
+    vector<DiskImageCache::SourceRef> refs;
+
+    geom.numSides      = 0;
+    geom.numTracks     = numTracks_m;
+    geom.doubleDensity = doubleDensity_m;
+
+    for (unsigned int head = 0; head < maxHeads_c; ++head)
+    {
+        for (size_t x = 0; x < tracks_m[head].size(); ++x)
+        {
+            vector<Sector>& sectors = tracks_m[head][x]->getSectors();
+
+            for (size_t y = 0; y < sectors.size(); ++y)
+            {
+                ImageSector& is = imageSectors_m[sectorIndex_m[&sectors[y]]];
+                refs.push_back({is.offset, is.length});
+            }
+
+            tracks.push_back(tracks_m[head][x]);
+        }
+    }
+
+    cache.store(geom, tracks, refs);
 }
 
 IMDFloppyDisk::~IMDFloppyDisk()
 {
+    compact();
+}
+
+void
+IMDFloppyDisk::replayJournal()
+{
+    vector<shared_ptr<Sector> > saved = journal_m.load();
+    int                         count = 0;
 
+    for (size_t x = 0; x < saved.size(); ++x)
+    {
+        shared_ptr<Sector> src = saved[x];
+
+        for (size_t y = 0; y < imageSectors_m.size(); ++y)
+        {
+            Sector*            dst = imageSectors_m[y].sector;
+
+            if (dst->getHeadNum() == src->getHeadNum() &&
+                dst->getTrackNum() == src->getTrackNum() &&
+                dst->getSectorNum() == src->getSectorNum() &&
+                dst->getSectorLength() == src->getSectorLength())
+            {
+                for (WORD pos = 0; pos < src->getSectorLength(); ++pos)
+                {
+                    dst->writeData(pos, src->getData()[pos]);
+                }
+
+                dst->setDeletedDataAddressMark(src->getDeletedDataAddressMark());
+                dst->setReadError(src->getReadError());
+                imageSectors_m[y].dirty = true;
+                dirty_m                 = true;
+                ++count;
+                break;
+            }
+        }
+    }
+
+    if (count > 0)
+    {
+        debugss(ssFloppyDisk, WARNING, "%s: recovered %d sectors from journal\n",
+                imageName_m.c_str(), count);
+    }
+}
+
+void
+IMDFloppyDisk::sectorWritten()
+{
+    map<Sector*, size_t>::iterator it = sectorIndex_m.find(curSector_m);
+
+    if (it == sectorIndex_m.end())
+    {
+        return;
+    }
+
+    imageSectors_m[it->second].dirty = true;
+    dirty_m                          = true;
+    journal_m.append(curSector_m);
+}
+
+///
+/// Copies the image file, substituting new records for the modified sectors,
+/// and replaces the original with the result.
+///
+bool
+IMDFloppyDisk::compact()
+{
+    if (!dirty_m || writeProtect_m)
+    {
+        return true;
+    }
+
+    ifstream file(imageName_m.c_str(), ios::binary);
+
+    if (!file.is_open())
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to reopen %s, changes remain in %s.journal\n",
+                imageName_m.c_str(), imageName_m.c_str());
+        return false;
+    }
+
+    vector<BYTE>        orig((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    vector<BYTE>        out;
+    vector<ImageSector> updated = imageSectors_m;
+    unsigned long       pos     = 0;
+
+    file.close();
+    out.reserve(orig.size());
+
+    for (size_t x = 0; x < imageSectors_m.size(); ++x)
+    {
+        ImageSector& is = imageSectors_m[x];
+
+        if (is.offset + is.length > orig.size())
+        {
+            debugss(ssFloppyDisk, ERROR, "%s changed since mounted, changes remain in %s.journal\n",
+                    imageName_m.c_str(), imageName_m.c_str());
+            return false;
+        }
+
+        out.insert(out.end(), orig.begin() + pos, orig.begin() + is.offset);
+        updated[x].offset = out.size();
+
+        if (is.dirty)
+        {
+            WORD         len = is.sector->getSectorLength();
+            vector<BYTE> data(is.sector->getData(), is.sector->getData() + len);
+
+            bool compressed = true;
+
+            for (WORD y = 1; y < len && compressed; ++y)
+            {
+                compressed = (data[y] == data[0]);
+            }
+
+            // type - 1 is a bit mask of compressed, deleted and error.
+            out.push_back(1 + (compressed ? 0x01 : 0) +
+                          (is.sector->getDeletedDataAddressMark() ? 0x02 : 0) +
+                          (is.sector->getReadError() ? 0x04 : 0));
+            out.insert(out.end(), data.begin(), compressed ? data.begin() + 1 : data.end());
+        }
+        else
+        {
+            out.insert(out.end(), orig.begin() + is.offset, orig.begin() + is.offset + is.length);
+        }
+
+        updated[x].length = out.size() - updated[x].offset;
+        updated[x].dirty  = false;
+        pos               = is.offset + is.length;
+    }
+
+    out.insert(out.end(), orig.begin() + pos, orig.end());
+
+    if (!SectorJournal::replaceFile(imageName_m, &out[0], out.size()))
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to update %s, changes remain in %s.journal\n",
+                imageName_m.c_str(), imageName_m.c_str());
+        return false;
+    }
+
+    // only now is the journal redundant.
+    journal_m.discard();
+    imageSectors_m = updated;
+    dirty_m        = false;
+
+    debugss(ssFloppyDisk, INFO, "%s updated\n", imageName_m.c_str());
+
+    return true;
 }
 
 bool
@@ -257,6 +498,8 @@ IMDFloppyDisk::readIMD(const char* name)
         trk->setDataRate(dataRate);
         trk->setDensity(density);
 
+        vector<ImageSector> records;
+
         numSec        = buf[pos++];
         debugss(ssFloppyDisk, ALL, "Num Sectors:    %d\n", numSec);
 
@@ -303,6 +546,7 @@ IMDFloppyDisk::readIMD(const char* name)
 
         for (int i = 0; i < numSec; i++)
         {
+            unsigned long recStart   = pos;
             unsigned char sectorType = buf[pos++];
 
             debugss(ssFloppyDisk, INFO, "Sector: %d(%d) Type: %d\n", sectorOrder[i], i, sectorType);
@@ -348,21 +592,27 @@ IMDFloppyDisk::readIMD(const char* name)
                 }
 
                 // create sector
-                shared_ptr<Sector> sect = make_shared<Sector>(head,
-                                                              cyl,
-                                                              sectorOrder[i],
-                                                              sectorSize,
-                                                              &sectorData[0]);
+                Sector sect(head, cyl, sectorOrder[i], sectorSize, &sectorData[0], arena_m);
 
                 // set flags
-                sect->setReadError(dataError);
-                sect->setDeletedDataAddressMark(deleteData);
+                sect.setReadError(dataError);
+                sect.setDeletedDataAddressMark(deleteData);
 
                 // add sector to track
-                trk->addSector(sect);
+                trk->addSector(std::move(sect));
+
+                records.push_back({nullptr, recStart, pos - recStart, false});
             }
         }
 
+        // the track's sectors don't move once they are all added.
+        for (size_t x = 0; x < records.size(); ++x)
+        {
+            records[x].sector                 = &trk->getSectors()[x];
+            sectorIndex_m[records[x].sector] = imageSectors_m.size();
+            imageSectors_m.push_back(records[x]);
+        }
+
         // add track to disk
         tracks_m[head].push_back(trk);
 
@@ -544,6 +794,11 @@ IMDFloppyDisk::writeData(BYTE track,
                 curSector_m->writeData(dataPos_m++, data);
 
                 result = data;
+
+                if (dataPos_m == sectorLength_m)
+                {
+                    sectorWritten();
+                }
             }
             else
             {
@@ -569,7 +824,13 @@ IMDFloppyDisk::isReady()
 void
 IMDFloppyDisk::eject(const string name)
 {
+    compact();
+}
 
+void
+IMDFloppyDisk::sync()
+{
+    journal_m.sync();
 }
 
 void
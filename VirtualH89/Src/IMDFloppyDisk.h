@@ -9,16 +9,31 @@
 #define IMDFLOPPYDISK_H_
 
 #include "GenericFloppyDisk.h"
+#include "SectorArena.h"
+#include "SectorJournal.h"
 
 /// \cond
+#include <map>
 #include <vector>
 #include <memory>
 /// \endcond
 
+class DiskImageCache;
 class DiskSide;
 class Track;
 class Sector;
 
+///
+/// \class IMDFloppyDisk
+///
+/// \brief ImageDisk (.IMD) media.
+///
+/// Each completed sector write is appended to a SectorJournal next to the image
+/// (<image>.journal), which is replayed if the image is mounted again before
+/// the journal was folded back in. On eject, the image is rewritten with the
+/// modified sectors and atomically renamed over the original, so a crash at any
+/// point leaves either the old or the new image plus the journal.
+///
 class IMDFloppyDisk: public GenericFloppyDisk
 {
   public:
@@ -40,6 +55,7 @@ class IMDFloppyDisk: public GenericFloppyDisk
                            int& result) override;
     virtual bool isReady() override;
     virtual void eject(const std::string name) override;
+    virtual void sync() override;
     virtual void dump(void) override;
     bool findSector(BYTE side,
                     BYTE track,
@@ -48,18 +64,40 @@ class IMDFloppyDisk: public GenericFloppyDisk
     static GenericFloppyDisk_ptr getDiskette(std::vector<std::string> argv);
 
   private:
-    const std::string                          imageName_m;
+    /// a sector as stored in the image file.
+    struct ImageSector
+    {
+        Sector*       sector;
+        /// offset and length of the sector record, type byte included.
+        unsigned long offset;
+        unsigned long length;
+        bool          dirty;
+    };
+
     static const unsigned int                  maxHeads_c = 2;
 
+    /// data of every sector on the disk.
+    SectorArena                                arena_m;
     std::vector <std::shared_ptr<Track> >      tracks_m[maxHeads_c];
     std::vector<std::shared_ptr<DiskSide> >    sideData_m;
 
-    std::shared_ptr<Sector>                    curSector_m;
+    Sector*                                    curSector_m;
     int                                        dataPos_m;
     int                                        sectorLength_m;
     BYTE                                       secLenCode_m;
     bool                                       ready_m;
 
+    std::vector<ImageSector>                   imageSectors_m;
+    std::map<Sector*, size_t>                  sectorIndex_m;
+    SectorJournal                              journal_m;
+    bool                                       dirty_m;
+
+    void sectorWritten();
+    void replayJournal();
+    bool compact();
+    bool loadCached(DiskImageCache& cache);
+    void storeCached(DiskImageCache& cache);
+
     // int           gapLen_m;
     // int           indexGapLen_m;
     // unsigned long writePos_m;
@@ -7,6 +7,7 @@
 #include "INS8250.h"
 
 #include "computer.h"
+#include "InputJournal.h"
 #include "WallClock.h"
 #include "logger.h"
 
@@ -24,6 +25,7 @@ INS8250::INS8250(Computer* computer,
                                       FE_m(false),
                                       device_m(0),
                                       rxByteAvail(false),
+                                      rxQueued_m(false),
                                       txByteAvail(false),
                                       lsBaudDiv(0),
                                       msBaudDiv(0),
@@ -38,6 +40,11 @@ INS8250::INS8250(Computer* computer,
 {
     intLevel_m = intLevel;
 
+    if (InputJournal::active())
+    {
+        InputJournal::active()->addPort(this);
+    }
+
     /// \todo Use H89 manual to verify/set all the conditions on reset of chip.
 }
 
@@ -132,38 +139,7 @@ INS8250::in(BYTE addr)
                 break;
 
             case LSR: // Line Status Register
-                if (rxByteAvail)
-                {
-                    val |= LSB_DataReady;
-                }
-
-                if ((WallClock::instance()->getClock() - lastTransmit) > 2133)
-                {
-                    val |= LSB_THRE;
-                }
-
-                if (1) /// \todo - what to do here?
-                {
-                    val |= LSB_TSRE;
-                }
-
-                if (OE_m)
-                {
-                    val |= LSB_Overrun;
-                    OE_m = false;
-                }
-
-                if (FE_m)
-                {
-                    val |= LSB_FramingError;
-                    FE_m = false;
-                }
-
-                if (PE_m)
-                {
-                    val |= LSB_ParityError;
-                    PE_m = false;
-                }
+                val = lsrIn();
                 break;
 
             case MSR: // Modem Status Register
@@ -187,6 +163,66 @@ INS8250::in(BYTE addr)
     return (val);
 }
 
+BYTE
+INS8250::lsrIn()
+{
+    BYTE val = 0x00;
+
+    if (rxByteAvail)
+    {
+        val |= LSB_DataReady;
+    }
+
+    if ((WallClock::instance()->getClock() - lastTransmit) > 2133)
+    {
+        val |= LSB_THRE;
+    }
+
+    if (1) /// \todo - what to do here?
+    {
+        val |= LSB_TSRE;
+    }
+
+    if (OE_m)
+    {
+        val |= LSB_Overrun;
+        OE_m = false;
+    }
+
+    if (FE_m)
+    {
+        val |= LSB_FramingError;
+        FE_m = false;
+    }
+
+    if (PE_m)
+    {
+        val |= LSB_ParityError;
+        PE_m = false;
+    }
+
+    return (val);
+}
+
+/// The LSR is polled by anything waiting to send or receive.
+BYTE
+INS8250::lsrPortIn(IODevice* dev,
+                   BYTE      addr)
+{
+    return static_cast<INS8250*>(dev)->lsrIn();
+}
+
+void
+INS8250::getPortHandlers(BYTE        offset,
+                         InHandler&  in,
+                         OutHandler& out)
+{
+    if (offset == LSR)
+    {
+        in = lsrPortIn;
+    }
+}
+
 void
 INS8250::out(BYTE addr,
              BYTE val)
@@ -305,17 +341,45 @@ INS8250::attachDevice(SerialPortDevice* dev)
 }
 
 
+unsigned int
+INS8250::getBaudRate()
+{
+    return baud_m;
+}
+
 bool
 INS8250::receiveReady()
 {
-    return !rxByteAvail;
+    return !rxByteAvail && !rxQueued_m;
 }
 
 void
 INS8250::receiveData(BYTE data)
+{
+    InputJournal* journal = InputJournal::active();
+
+    if (journal)
+    {
+        // the replayed input takes the place of the host's.
+        if (!journal->replaying())
+        {
+            rxQueued_m = true;
+            journal->serialData(this, data);
+        }
+
+        return;
+    }
+
+    latchData(data);
+}
+
+void
+INS8250::latchData(BYTE data)
 {
     debugss(ss8250, ALL, "%d\n", data);
 
+    rxQueued_m = false;
+
     unsigned int baud = device_m->getBaudRate();
 
     if (baud == SerialPortDevice::DISABLE_BAUD_CHECK)
@@ -11,6 +11,10 @@
 
 #include "IODevice.h"
 
+/// \cond
+#include <atomic>
+/// \endcond
+
 class SerialPortDevice;
 class Computer;
 
@@ -30,12 +34,21 @@ class INS8250: public IODevice
     virtual BYTE in(BYTE addr) override;
     virtual void out(BYTE addr,
                      BYTE val) override;
+    virtual void getPortHandlers(BYTE        offset,
+                                 InHandler&  in,
+                                 OutHandler& out) override;
 
     virtual bool attachDevice(SerialPortDevice* dev);
 
     virtual bool receiveReady();
     virtual void receiveData(BYTE data);
 
+    /// puts a received byte in the receiver buffer, on the CPU thread.
+    void latchData(BYTE data);
+
+    /// Baud rate programmed by the divisor latch, 0 if not yet set.
+    unsigned int getBaudRate();
+
     void reset() override;
 
     // TODO - add all the status, both for the device to set it's status
@@ -48,6 +61,10 @@ class INS8250: public IODevice
     void raiseInterrupt();
     void lowerInterrupt();
 
+    BYTE lsrIn();
+    static BYTE lsrPortIn(IODevice* dev,
+                          BYTE      addr);
+
     /// Line Control variables:
     bool DLAB_m; // Divisor Latch Access bit
     BYTE bits_m;
@@ -98,6 +115,8 @@ class INS8250: public IODevice
     SerialPortDevice* device_m;
 
     bool              rxByteAvail;
+    /// received, but waiting for the journal to apply it.
+    std::atomic_bool  rxQueued_m;
     BYTE              RecvBuf;
     bool              txByteAvail;
     BYTE              TransHolding;
@@ -11,13 +11,21 @@
 #include "logger.h"
 #include "IODevice.h"
 
-IOBus::IOBus()
+/// \cond
+#include <sstream>
+/// \endcond
+
+IOBus::IOBus(): counting_m(false)
 {
     debugss(ssIO, INFO, "%\n");
 
     for (int port = 0; port < 256; ++port)
     {
-        iodevices[port] = 0;
+        ports_m[port].device   = nullptr;
+        ports_m[port].in       = undefinedIn;
+        ports_m[port].out      = undefinedOut;
+        ports_m[port].inCount  = 0;
+        ports_m[port].outCount = 0;
     }
 }
 
@@ -57,7 +65,7 @@ IOBus::addDevice(IODevice* device)
     // First make sure there is no conflict
     for (BYTE port = base; port < last; ++port)
     {
-        if (iodevices[port])
+        if (ports_m[port].device)
         {
             // Address already in use
             debugss(ssIO, ERROR, "duplicate devices on port (%03o)\n", port);
@@ -65,10 +73,13 @@ IOBus::addDevice(IODevice* device)
         }
     }
 
-    // Now set the new value
+    // Now set the new value, the device may supply its own handlers for each port.
     for (BYTE port = base; port < last; ++port)
     {
-        iodevices[port] = device;
+        ports_m[port].device = device;
+        ports_m[port].in     = nullptr;
+        ports_m[port].out    = nullptr;
+        device->getPortHandlers(port - base, ports_m[port].in, ports_m[port].out);
     }
 
     return (true);
@@ -91,10 +102,12 @@ IOBus::removeDevice(IODevice* device)
         {
             for (BYTE port = base; port < last; ++port)
             {
-                if (iodevices[port] == device)
+                if (ports_m[port].device == device)
                 {
-                    // TODO: call destructor? (i.e. "delete iodevices[port];"?)
-                    iodevices[port] = 0;
+                    // TODO: call destructor? (i.e. "delete ports_m[port].device;"?)
+                    ports_m[port].device = nullptr;
+                    ports_m[port].in     = undefinedIn;
+                    ports_m[port].out    = undefinedOut;
                 }
                 else
                 {
@@ -128,46 +141,66 @@ IOBus::reset()
 {
     for (int port = 0; port < 256; ++port)
     {
-        if (iodevices[port] != nullptr)
+        if (ports_m[port].device != nullptr)
         {
-            iodevices[port]->reset();
+            ports_m[port].device->reset();
         }
     }
 }
 
 BYTE
-IOBus::in(BYTE addr)
+IOBus::undefinedIn(IODevice* device,
+                   BYTE      addr)
 {
-    BYTE val = 0xff;
-
-    debugss(ssIO, ALL, "(%03o)\n", addr);
+    // undefined in
+    debugss(ssIO, WARNING, "undefined port (%03o)\n", addr);
 
-    if (iodevices[addr])
-    {
-        val = iodevices[addr]->in(addr);
-    }
-    else
-    {
-        // undefined in
-        debugss(ssIO, WARNING, "undefined port (%03o)\n", addr);
-    }
+    return (0xff);
+}
 
-    debugss(ssIO, ALL, "(%03o): %d\n", addr, val);
-    return (val);
+void
+IOBus::undefinedOut(IODevice* device,
+                    BYTE      addr,
+                    BYTE      val)
+{
+    debugss(ssIO, WARNING, "undefined port (%03o) = 0x%02x\n", addr, val);
 }
 
 void
-IOBus::out(BYTE addr,
-           BYTE val)
+IOBus::setCounting(bool enable)
 {
-    debugss(ssIO, ALL, "(%03o) = 0x%02x\n", addr, val);
+    counting_m = enable;
+}
 
-    if (iodevices[addr])
+void
+IOBus::clearCounters()
+{
+    for (int port = 0; port < 256; ++port)
     {
-        iodevices[addr]->out(addr, val);
+        ports_m[port].inCount  = 0;
+        ports_m[port].outCount = 0;
     }
-    else
+}
+
+std::string
+IOBus::dumpCounters()
+{
+    std::ostringstream resp;
+    int                count = 0;
+
+    for (int port = 0; port < 256; ++port)
     {
-        debugss(ssIO, WARNING, "undefined port (%03o) = 0x%02x\n", addr, val);
+        if (ports_m[port].inCount || ports_m[port].outCount)
+        {
+            if (count++ > 0)
+            {
+                resp << ';';
+            }
+
+            resp << std::oct << port << std::dec << '=' << ports_m[port].inCount << '/'
+                 << ports_m[port].outCount;
+        }
     }
+
+    return resp.str();
 }
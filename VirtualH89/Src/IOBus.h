@@ -11,14 +11,30 @@
 #define IOBUS_H
 
 #include "h89Types.h"
+#include "IODevice.h"
 
 
-class IODevice;
+/// \cond
+#include <string>
+/// \endcond
+
 class DiskController;
 
+///
+/// \brief Routes CPU port accesses to the I/O devices.
+///
+/// Each port has its device, and optionally its own handler pair, looked up from the
+/// device when it is added, so a device can handle its busiest registers without
+/// going through in()/out() and decoding the port again. Ports without a handler
+/// call the device's in()/out() directly. Access counts per port are kept when
+/// enabled.
+///
 class IOBus
 {
   public:
+    typedef IODevice::InHandler  InHandler;
+    typedef IODevice::OutHandler OutHandler;
+
     IOBus();
     virtual ~IOBus();
 
@@ -26,14 +42,66 @@ class IOBus
     virtual bool removeDevice(IODevice* device);
     virtual void reset();
 
-    virtual BYTE in(BYTE addr);
-    virtual void out(BYTE addr,
-                     BYTE val);
+    BYTE in(BYTE addr)
+    {
+        Port& port = ports_m[addr];
+
+        if (counting_m)
+        {
+            ++port.inCount;
+        }
+
+        if (port.in == nullptr)
+        {
+            return port.device->in(addr);
+        }
+
+        return port.in(port.device, addr);
+    }
+
+    void out(BYTE addr,
+             BYTE val)
+    {
+        Port& port = ports_m[addr];
+
+        if (counting_m)
+        {
+            ++port.outCount;
+        }
+
+        if (port.out == nullptr)
+        {
+            port.device->out(addr, val);
+            return;
+        }
+
+        port.out(port.device, addr, val);
+    }
+
+    void setCounting(bool enable);
+    void clearCounters();
+    /// "<port>=<in>/<out>" for each port accessed, ports in octal.
+    std::string dumpCounters();
 
   protected:
-    IODevice*   iodevices[256];
+    struct Port
+    {
+        IODevice*          device;
+        /// nullptr to call device->in()/out().
+        InHandler          in;
+        OutHandler         out;
+        unsigned long long inCount;
+        unsigned long long outCount;
+    };
 
+    Port ports_m[256];
+    bool counting_m;
 
+    static BYTE undefinedIn(IODevice* device,
+                            BYTE      addr);
+    static void undefinedOut(IODevice* device,
+                             BYTE      addr,
+                             BYTE      val);
 };
 
 
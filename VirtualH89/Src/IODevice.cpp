@@ -41,3 +41,11 @@ IODevice::getPortOffset(BYTE addr)
 {
     return (addr - baseAddress_m);
 }
+
+void
+IODevice::getPortHandlers(BYTE        offset,
+                          InHandler&  in,
+                          OutHandler& out)
+{
+
+}
@@ -21,6 +21,13 @@
 class IODevice
 {
   public:
+    /// Handlers the IOBus calls for a port, instead of in() and out().
+    typedef BYTE (*InHandler)(IODevice* device,
+                              BYTE      addr);
+    typedef void (*OutHandler)(IODevice* device,
+                               BYTE      addr,
+                               BYTE      val);
+
     ///
     ///   \param base Base address for the I/O device
     ///   \param numPorts The number of addresses used by the device.
@@ -78,6 +85,19 @@ class IODevice
     ///
     virtual BYTE getPortOffset(BYTE addr);
 
+    ///
+    /// Handlers for one port, asked for by the IOBus when the device is added. They
+    /// start out as nullptr, for calling in() and out(); a device may set them for
+    /// its busiest registers, to skip the port decode.
+    ///
+    /// \param[in] offset Offset of the port from the base address
+    /// \param[in,out] in Handler for reads of the port
+    /// \param[in,out] out Handler for writes to the port
+    ///
+    virtual void getPortHandlers(BYTE        offset,
+                                 InHandler&  in,
+                                 OutHandler& out);
+
     // System RESET, may be ignored by device - if appropiate
     virtual void reset() = 0;
 
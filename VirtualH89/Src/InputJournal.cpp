@@ -0,0 +1,502 @@
+/// \file InputJournal.cpp
+///
+/// Records the machine's nondeterministic inputs, and replays them.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#include "InputJournal.h"
+
+#include "H89Operator.h"
+#include "h89-timer.h"
+#include "INS8250.h"
+#include "WallClock.h"
+#include "logger.h"
+
+/// \cond
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+/// \endcond
+
+const char    InputJournal::magic_c[8] = {'V', 'H', '8', '9', 'I', 'J', '1', '\n'};
+
+InputJournal* InputJournal::_inst      = nullptr;
+InputJournal* InputJournal::active_m   = nullptr;
+
+InputJournal*
+InputJournal::install_InputJournal(PropertyUtil::PropertyMapT& props)
+{
+    std::string record = props["journal_record"];
+    std::string replay = props["journal_replay"];
+
+    if (record.empty() && replay.empty())
+    {
+        return nullptr;
+    }
+
+    if (!record.empty() && !replay.empty())
+    {
+        debugss(ssH89, ERROR, "journal_record and journal_replay both set, replaying\n");
+    }
+
+    _inst = new InputJournal();
+
+    bool ok = replay.empty() ? _inst->startRecording(record) : _inst->startReplay(replay);
+
+    if (ok)
+    {
+        active_m = _inst;
+    }
+
+    return active_m;
+}
+
+InputJournal::InputJournal(): ClockUser(true),
+                              replaying_m(false),
+                              timer_m(nullptr),
+                              lastCycle_m(0),
+                              fd_m(-1),
+                              ticksPending_m(0),
+                              pending_m(false),
+                              inPos_m(0),
+                              haveNext_m(false)
+{
+    pthread_mutex_init(&mutex_m, nullptr);
+}
+
+InputJournal::~InputJournal()
+{
+    if (fd_m >= 0)
+    {
+        flush();
+        close(fd_m);
+    }
+}
+
+bool
+InputJournal::startRecording(std::string path)
+{
+    path_m = path;
+    fd_m   = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd_m < 0)
+    {
+        debugss(ssH89, ERROR, "Unable to create journal %s (%d)\n", path.c_str(), errno);
+        return false;
+    }
+
+    out_m.insert(out_m.end(), magic_c, magic_c + sizeof(magic_c));
+    flush();
+
+    debugss(ssH89, INFO, "Recording inputs to %s\n", path.c_str());
+
+    return true;
+}
+
+bool
+InputJournal::startReplay(std::string path)
+{
+    path_m = path;
+
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        debugss(ssH89, ERROR, "Unable to open journal %s (%d)\n", path.c_str(), errno);
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        in_m.resize(st.st_size);
+
+        if (read(fd, &in_m[0], in_m.size()) != (ssize_t) in_m.size())
+        {
+            in_m.clear();
+        }
+    }
+
+    close(fd);
+
+    if (in_m.size() < sizeof(magic_c) || memcmp(&in_m[0], magic_c, sizeof(magic_c)) != 0)
+    {
+        debugss(ssH89, ERROR, "Invalid journal %s\n", path.c_str());
+        return false;
+    }
+
+    inPos_m     = sizeof(magic_c);
+    replaying_m = true;
+    haveNext_m  = readNext();
+
+    WallClock::instance()->requestHostWork();
+
+    debugss(ssH89, INFO, "Replaying inputs from %s\n", path.c_str());
+
+    return true;
+}
+
+void
+InputJournal::setTimer(H89Timer* timer)
+{
+    timer_m = timer;
+}
+
+void
+InputJournal::addPort(INS8250* port)
+{
+    ports_m[port->getBaseAddress()] = port;
+}
+
+void
+InputJournal::timerSignal()
+{
+    if (!replaying_m)
+    {
+        ++ticksPending_m;
+        pending_m = true;
+        WallClock::instance()->requestHostWork();
+    }
+}
+
+void
+InputJournal::serialData(INS8250* port,
+                         BYTE     data)
+{
+    pthread_mutex_lock(&mutex_m);
+    serial_m.push_back(std::make_pair(port, data));
+    pending_m = true;
+    pthread_mutex_unlock(&mutex_m);
+
+    WallClock::instance()->requestHostWork();
+}
+
+void
+InputJournal::notification(unsigned int cycleCount)
+{
+    if (replaying_m)
+    {
+        if (haveNext_m && WallClock::instance()->getClock() >= next_m.cycle)
+        {
+            applyDue(false);
+        }
+
+        if (replaying_m && haveNext_m)
+        {
+            // inputs are due at an exact cycle, so look again after the next instruction.
+            WallClock::instance()->requestHostWork();
+        }
+    }
+    else if (pending_m)
+    {
+        applyPending(false);
+    }
+}
+
+void
+InputJournal::idle()
+{
+    if (replaying_m)
+    {
+        if (!applyDue(true) && replaying_m)
+        {
+            // recording never left the CPU waiting without an input to end it.
+            goLive(haveNext_m ? "diverged" : "done");
+        }
+    }
+    else if (active_m)
+    {
+        if (pending_m)
+        {
+            applyPending(true);
+        }
+
+        // the CPU is about to wait anyway.
+        flush();
+    }
+}
+
+void
+InputJournal::applyPending(bool idle)
+{
+    std::deque<std::pair<INS8250*, BYTE> > serial;
+    bool                                   batch = false;
+
+    pending_m = false;
+
+    while (ticksPending_m > 0)
+    {
+        --ticksPending_m;
+        writeEvent(et_tick, idle, batch);
+        batch = true;
+        timer_m->tick();
+    }
+
+    pthread_mutex_lock(&mutex_m);
+    serial.swap(serial_m);
+    pthread_mutex_unlock(&mutex_m);
+
+    for (int x = 0; x < serial.size(); ++x)
+    {
+        writeEvent(et_serial, idle, batch);
+        out_m.push_back(serial[x].first->getBaseAddress());
+        out_m.push_back(serial[x].second);
+        batch = true;
+        serial[x].first->latchData(serial[x].second);
+    }
+
+    if (out_m.size() >= flushSize_c)
+    {
+        flush();
+    }
+}
+
+///
+/// Applies the inputs recorded at this point, the same ones applyPending() did when
+/// recording.
+///
+/// \retval true if any were applied.
+///
+bool
+InputJournal::applyDue(bool idle)
+{
+    WallClock* clock   = WallClock::instance();
+    bool       applied = false;
+
+    while (haveNext_m && next_m.idle == idle && next_m.cycle == clock->getClock() &&
+           next_m.batch == applied &&
+           (next_m.type == et_tick || next_m.type == et_serial))
+    {
+        if (next_m.type == et_tick)
+        {
+            timer_m->tick();
+        }
+        else if (ports_m.count(next_m.port))
+        {
+            ports_m[next_m.port]->latchData(next_m.data);
+        }
+
+        applied    = true;
+        haveNext_m = readNext();
+    }
+
+    if (haveNext_m && next_m.cycle < clock->getClock())
+    {
+        goLive("diverged");
+    }
+
+    return applied;
+}
+
+bool
+InputJournal::replayResult(EventType type,
+                           BYTE*     data,
+                           int       maxLen,
+                           int&      result)
+{
+    if (!replaying_m)
+    {
+        return false;
+    }
+
+    if (haveNext_m && next_m.type == type && next_m.cycle == WallClock::instance()->getClock())
+    {
+        result = next_m.result;
+
+        if (!next_m.bytes.empty())
+        {
+            memcpy(data, &next_m.bytes[0], std::min((int) next_m.bytes.size(), maxLen));
+        }
+
+        haveNext_m = readNext();
+        return true;
+    }
+
+    if (type == et_netRecv && !(haveNext_m && next_m.type == et_netRecv &&
+                                next_m.cycle < WallClock::instance()->getClock()))
+    {
+        // nothing had arrived yet.
+        result = 0;
+        return true;
+    }
+
+    goLive("diverged");
+
+    return false;
+}
+
+void
+InputJournal::recordResult(EventType   type,
+                           const BYTE* data,
+                           int         result)
+{
+    if (replaying_m)
+    {
+        return;
+    }
+
+    writeEvent(type, false, false);
+    out_m.push_back(result & 0xff);
+    out_m.push_back((result >> 8) & 0xff);
+
+    if (result > 0)
+    {
+        out_m.insert(out_m.end(), data, data + result);
+    }
+}
+
+void
+InputJournal::goLive(const char* why)
+{
+    unsigned long long cycle = WallClock::instance()->getClock();
+    char               event[64];
+
+    debugss(ssH89, INFO, "Replay %s at %llu, going live\n", why, cycle);
+
+    replaying_m = false;
+    haveNext_m  = false;
+    active_m    = nullptr;
+
+    if (timer_m)
+    {
+        timer_m->start();
+    }
+
+    snprintf(event, sizeof(event), "replay %s %llu", why, cycle);
+    H89Operator::notifyListeners(event);
+}
+
+void
+InputJournal::writeEvent(EventType type,
+                         bool      idle,
+                         bool      batch)
+{
+    unsigned long long cycle = WallClock::instance()->getClock();
+    unsigned long long delta = cycle - lastCycle_m;
+
+    lastCycle_m = cycle;
+    out_m.push_back(type | (idle ? idleFlag_c : 0) | (batch ? batchFlag_c : 0));
+
+    do
+    {
+        BYTE val = delta & 0x7f;
+
+        delta >>= 7;
+        out_m.push_back(val | (delta ? 0x80 : 0));
+    }
+    while (delta);
+}
+
+void
+InputJournal::flush()
+{
+    size_t pos = 0;
+
+    while (pos < out_m.size())
+    {
+        ssize_t num = write(fd_m, &out_m[pos], out_m.size() - pos);
+
+        if (num < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (num <= 0)
+        {
+            debugss(ssH89, ERROR, "Unable to write journal %s (%d)\n", path_m.c_str(), errno);
+            break;
+        }
+
+        pos += num;
+    }
+
+    out_m.clear();
+}
+
+///
+/// \retval false at the end of the journal, including a record cut short when the
+///         recording stopped.
+///
+bool
+InputJournal::readNext()
+{
+    if (inPos_m >= in_m.size())
+    {
+        return false;
+    }
+
+    BYTE               flags = in_m[inPos_m++];
+    unsigned long long delta = 0;
+    int                shift = 0;
+
+    do
+    {
+        if (inPos_m >= in_m.size() || shift > 63)
+        {
+            return false;
+        }
+
+        delta |= (unsigned long long) (in_m[inPos_m] & 0x7f) << shift;
+        shift += 7;
+    }
+    while (in_m[inPos_m++] & 0x80);
+
+    lastCycle_m   += delta;
+
+    next_m.type    = flags & typeMask_c;
+    next_m.idle    = (flags & idleFlag_c) != 0;
+    next_m.batch   = (flags & batchFlag_c) != 0;
+    next_m.cycle   = lastCycle_m;
+    next_m.result  = 0;
+    next_m.bytes.clear();
+
+    switch (next_m.type)
+    {
+        case et_tick:
+            return true;
+
+        case et_serial:
+            if (inPos_m + 2 > in_m.size())
+            {
+                return false;
+            }
+
+            next_m.port = in_m[inPos_m++];
+            next_m.data = in_m[inPos_m++];
+            return true;
+
+        case et_netSend:
+        case et_netRecv:
+            if (inPos_m + 2 > in_m.size())
+            {
+                return false;
+            }
+
+            next_m.result = (int16_t) (in_m[inPos_m] | (in_m[inPos_m + 1] << 8));
+            inPos_m      += 2;
+
+            if (next_m.result > 0)
+            {
+                if (inPos_m + next_m.result > in_m.size())
+                {
+                    return false;
+                }
+
+                next_m.bytes.assign(&in_m[inPos_m], &in_m[inPos_m] + next_m.result);
+                inPos_m += next_m.result;
+            }
+
+            return true;
+
+        default:
+            debugss(ssH89, ERROR, "Unknown record %02x in journal %s\n", flags, path_m.c_str());
+            return false;
+    }
+}
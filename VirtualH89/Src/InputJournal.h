@@ -0,0 +1,178 @@
+/// \file InputJournal.h
+///
+/// Records the machine's nondeterministic inputs, and replays them.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#ifndef INPUTJOURNAL_H_
+#define INPUTJOURNAL_H_
+
+#include "ClockUser.h"
+#include "h89Types.h"
+#include "propertyutil.h"
+
+/// \cond
+#include <atomic>
+#include <deque>
+#include <map>
+#include <pthread.h>
+#include <string>
+#include <utility>
+#include <vector>
+/// \endcond
+
+class H89Timer;
+class INS8250;
+
+///
+/// \class InputJournal
+///
+/// \brief Journal of everything that reaches the guest from the host, stamped with
+/// the WallClock cycle it took effect at. This is a singleton.
+///
+/// What the guest does depends on when the 2 mSec timer ticks arrive, when bytes
+/// (keystrokes included) arrive at the UARTs, and what the CP/Net servers return.
+/// While a journal is active, ticks and received bytes are no longer applied when
+/// they arrive, but queued and applied by the CPU thread after the current
+/// instruction, or while the CPU waits for the next tick. CP/Net results are
+/// already produced on the CPU thread. When replaying, the CP/Net servers still
+/// run the requests, so they have the same open files once the machine goes live,
+/// but the guest gets the recorded results.
+///
+/// When recording, each input is written out as it is applied. When replaying, the
+/// host's inputs are ignored, the timer isn't started and the CPU never waits: each
+/// input is applied at the same point it was recorded at, so the run repeats exactly
+/// and as fast as the host allows. At the end of the journal (or if the run stops
+/// matching it) the machine goes live, and a "replay done <cycle>" (or "replay
+/// diverged <cycle>") operator event is sent.
+///
+/// Operator commands aren't recorded, a replay only repeats a run that didn't use
+/// any that change the machine.
+///
+/// Property syntax:
+///
+///     journal_record = <file>
+///     journal_replay = <file>
+///
+/// The journal starts with an 8 byte magic, followed by records of a type byte, the
+/// cycles since the previous record (LEB128), and the type's data.
+///
+class InputJournal: public ClockUser
+{
+  public:
+    static InputJournal* install_InputJournal(PropertyUtil::PropertyMapT& props);
+
+    /// nullptr unless a journal is being recorded or replayed.
+    static InputJournal* active()
+    {
+        return active_m;
+    }
+
+    bool replaying()
+    {
+        return replaying_m;
+    }
+
+    enum EventType
+    {
+        et_tick    = 1,
+        et_serial  = 2,
+        /// result of CPNetDevice::sendMsg().
+        et_netSend = 3,
+        /// non-zero result of CPNetDevice::checkRecvMsg().
+        et_netRecv = 4
+    };
+
+    /// devices taking part, registered as they are created.
+    void setTimer(H89Timer* timer);
+    void addPort(INS8250* port);
+
+    /// called from the SIGALRM handler.
+    void timerSignal();
+    /// called from any thread, when recording.
+    void serialData(INS8250* port,
+                    BYTE      data);
+
+    /// called by the CPU when it has no cycles left, instead of waiting for the next
+    /// tick when replaying, and after waiting when recording.
+    void idle();
+
+    /// For results computed on the CPU thread. When replaying, fills in data and
+    /// result and returns true, or returns false if the journal has gone live.
+    bool replayResult(EventType type,
+                      BYTE*     data,
+                      int       maxLen,
+                      int&      result);
+    /// only the first result bytes of data are kept, none if it's negative.
+    void recordResult(EventType   type,
+                      const BYTE* data,
+                      int         result);
+
+    virtual void notification(unsigned int cycleCount) override;
+
+  private:
+    InputJournal();
+    virtual ~InputJournal();
+
+    /// use C++11 to avoid having to define copy constructor
+    InputJournal(InputJournal const&)            = delete;
+    InputJournal& operator=(InputJournal const&) = delete;
+
+    bool startRecording(std::string path);
+    bool startReplay(std::string path);
+
+    void applyPending(bool idle);
+    bool applyDue(bool idle);
+    void goLive(const char* why);
+
+    void writeEvent(EventType type,
+                    bool      idle,
+                    bool      batch);
+    void flush();
+    bool readNext();
+
+    static const char            magic_c[8];
+    static const BYTE            idleFlag_c  = 0x80;
+    static const BYTE            batchFlag_c = 0x40;
+    static const BYTE            typeMask_c  = 0x3f;
+    static const size_t          flushSize_c = 65536;
+
+    static InputJournal*         _inst;
+    static InputJournal*         active_m;
+
+    bool                         replaying_m;
+    std::string                  path_m;
+    H89Timer*                    timer_m;
+    std::map<BYTE, INS8250*>     ports_m;
+    unsigned long long           lastCycle_m;
+
+    // recording
+    int                          fd_m;
+    std::vector<BYTE>            out_m;
+    std::atomic_uint             ticksPending_m;
+    std::atomic_bool             pending_m;
+    pthread_mutex_t              mutex_m;
+    std::deque<std::pair<INS8250*, BYTE> > serial_m;
+
+    // replaying
+    struct Event
+    {
+        BYTE               type;
+        bool               idle;
+        bool               batch;
+        unsigned long long cycle;
+        BYTE               port;
+        BYTE               data;
+        int                result;
+        std::vector<BYTE>  bytes;
+    };
+
+    std::vector<BYTE>            in_m;
+    size_t                       inPos_m;
+    bool                         haveNext_m;
+    Event                        next_m;
+};
+
+#endif // INPUTJOURNAL_H_
@@ -0,0 +1,230 @@
+/// \file MediaLoader.cpp
+///
+/// Opens and decodes disk images for the operator's mount and eject commands,
+/// off the CPU thread.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#include "MediaLoader.h"
+
+#include "GenericDiskDrive.h"
+#include "GenericFloppyDisk.h"
+#include "H89Operator.h"
+#include "SectorFloppyImage.h"
+#include "WallClock.h"
+#include "logger.h"
+
+
+MediaLoader* MediaLoader::_inst = nullptr;
+
+MediaLoader*
+MediaLoader::instance()
+{
+    if (!_inst)
+    {
+        _inst = new MediaLoader();
+    }
+
+    return _inst;
+}
+
+MediaLoader::MediaLoader(): ClockUser(true),
+                            running_m(false),
+                            donePending_m(false)
+{
+    pthread_mutex_init(&mutex_m, nullptr);
+    pthread_cond_init(&cond_m, nullptr);
+
+    running_m = (pthread_create(&thread_m, nullptr, threadFunc, this) == 0);
+
+    if (!running_m)
+    {
+        debugss(ssStdioConsole, ERROR, "unable to start loader thread, loading inline\n");
+    }
+}
+
+MediaLoader::~MediaLoader()
+{
+
+}
+
+void
+MediaLoader::mount(GenericDiskDrive*        drive,
+                   std::string              name,
+                   std::vector<std::string> argv)
+{
+    Request req;
+
+    req.drive   = drive;
+    req.seq     = ++latest_m[drive];
+    req.name    = name;
+    req.mount   = true;
+    req.argv    = argv;
+    req.oldDisk = drive->getDisk();
+
+    drive->insertDisk(nullptr);
+    queue(req);
+}
+
+void
+MediaLoader::eject(GenericDiskDrive* drive,
+                   std::string       name)
+{
+    Request req;
+
+    req.drive   = drive;
+    req.seq     = ++latest_m[drive];
+    req.name    = name;
+    req.mount   = false;
+    req.oldDisk = drive->getDisk();
+
+    drive->insertDisk(nullptr);
+    queue(req);
+}
+
+void
+MediaLoader::queue(Request& req)
+{
+    if (!running_m)
+    {
+        process(req);
+        finish(req);
+        return;
+    }
+
+    pthread_mutex_lock(&mutex_m);
+    pending_m.push_back(req);
+    pthread_cond_signal(&cond_m);
+    pthread_mutex_unlock(&mutex_m);
+}
+
+void*
+MediaLoader::threadFunc(void* arg)
+{
+    static_cast<MediaLoader*>(arg)->run();
+
+    return nullptr;
+}
+
+void
+MediaLoader::run()
+{
+    pthread_mutex_lock(&mutex_m);
+
+    while (true)
+    {
+        while (pending_m.empty())
+        {
+            pthread_cond_wait(&cond_m, &mutex_m);
+        }
+
+        Request req = pending_m.front();
+        pending_m.pop_front();
+        pthread_mutex_unlock(&mutex_m);
+
+        process(req);
+
+        pthread_mutex_lock(&mutex_m);
+        done_m.push_back(req);
+        donePending_m = true;
+        WallClock::instance()->requestHostWork();
+    }
+}
+
+/// Runs on the loader thread, the drive is only asked for its geometry.
+void
+MediaLoader::process(Request& req)
+{
+    req.oldDisk.reset();
+
+    if (req.mount)
+    {
+        // IMD and TD0 are recognized by name, anything else is a sector or raw image.
+        req.disk = GenericFloppyDisk::loadDiskImage(req.argv);
+
+        if (!req.disk)
+        {
+            req.disk = SectorFloppyImage::getDiskette(req.drive, req.argv);
+        }
+    }
+}
+
+/// Runs on the CPU thread, with the system mutex held.
+void
+MediaLoader::finish(Request& req)
+{
+    if (req.name.empty())
+    {
+        return;
+    }
+
+    if (!req.mount)
+    {
+        // the drive was emptied when it was requested.
+        H89Operator::notifyListeners("eject " + req.name);
+        return;
+    }
+
+    Request release;
+
+    release.drive = req.drive;
+    release.seq   = 0;
+    release.mount = false;
+
+    if (req.seq != latest_m[req.drive])
+    {
+        // overtaken, the drive is left to the later request.
+        release.oldDisk = req.disk;
+
+        if (release.oldDisk)
+        {
+            queue(release);
+        }
+
+        H89Operator::notifyListeners("mount " + req.name + " cancelled");
+        return;
+    }
+
+    // the drive was emptied when this was requested, and earlier requests were
+    // cancelled, but don't leak anything put in since.
+    release.oldDisk = req.drive->getDisk();
+
+    req.drive->insertDisk(req.disk);
+
+    if (release.oldDisk)
+    {
+        queue(release);
+    }
+
+    if (req.disk && req.disk->isReady())
+    {
+        H89Operator::notifyListeners("mount " + req.name + " " + req.drive->getMediaName());
+    }
+    else
+    {
+        H89Operator::notifyListeners("mount " + req.name + " error");
+    }
+}
+
+void
+MediaLoader::notification(unsigned int cycleCount)
+{
+    if (!donePending_m)
+    {
+        return;
+    }
+
+    std::deque<Request> reqs;
+
+    pthread_mutex_lock(&mutex_m);
+    reqs.swap(done_m);
+    donePending_m = false;
+    pthread_mutex_unlock(&mutex_m);
+
+    for (int x = 0; x < reqs.size(); ++x)
+    {
+        finish(reqs[x]);
+    }
+}
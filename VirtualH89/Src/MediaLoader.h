@@ -0,0 +1,96 @@
+/// \file MediaLoader.h
+///
+/// Opens and decodes disk images for the operator's mount and eject commands,
+/// off the CPU thread.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#ifndef MEDIALOADER_H_
+#define MEDIALOADER_H_
+
+#include "ClockUser.h"
+
+/// \cond
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <pthread.h>
+#include <string>
+#include <vector>
+/// \endcond
+
+class GenericDiskDrive;
+class GenericFloppyDisk;
+
+///
+/// \class MediaLoader
+///
+/// \brief Background media changes. This is a singleton.
+///
+/// A request empties the drive right away, so it reports not-ready, and queues the
+/// work for a single loader thread: releasing the old disk (which may have to write
+/// it back) and, for a mount, opening and decoding the new image. Requests are
+/// handled in order. Finished requests are applied on the CPU thread, between
+/// instructions, where the new disk is put in the drive and an operator event
+/// ("mount <drive> <media>", "mount <drive> error" or "eject <drive>") is sent.
+/// Only a drive's latest request takes effect, a mount that a later mount or eject
+/// of the same drive overtook ends with "mount <drive> cancelled" instead.
+///
+class MediaLoader: public ClockUser
+{
+  public:
+    static MediaLoader* instance(void);
+
+    /// must be called with the system mutex held.
+    void mount(GenericDiskDrive*        drive,
+               std::string              name,
+               std::vector<std::string> argv);
+    void eject(GenericDiskDrive* drive,
+               std::string       name);
+
+    virtual void notification(unsigned int cycleCount) override;
+
+  private:
+    MediaLoader();
+    virtual ~MediaLoader();
+
+    /// use C++11 to avoid having to define copy constructor
+    MediaLoader(MediaLoader const&)            = delete;
+    MediaLoader& operator=(MediaLoader const&) = delete;
+
+    static MediaLoader* _inst;
+
+    struct Request
+    {
+        GenericDiskDrive*                  drive;
+        /// the drive's request count when this one was made.
+        unsigned long                      seq;
+        /// drive name for the event, empty to only release oldDisk.
+        std::string                        name;
+        bool                               mount;
+        std::vector<std::string>           argv;
+        std::shared_ptr<GenericFloppyDisk> disk;
+        std::shared_ptr<GenericFloppyDisk> oldDisk;
+    };
+
+    static void* threadFunc(void* arg);
+    void run();
+    void queue(Request& req);
+    void process(Request& req);
+    void finish(Request& req);
+
+    pthread_mutex_t     mutex_m;
+    pthread_cond_t      cond_m;
+    pthread_t           thread_m;
+    bool                running_m;
+    std::deque<Request> pending_m;
+    std::deque<Request> done_m;
+    /// the latest request for each drive, only used with the system mutex held.
+    std::map<GenericDiskDrive*, unsigned long> latest_m;
+    std::atomic_bool    donePending_m;
+};
+
+#endif // MEDIALOADER_H_
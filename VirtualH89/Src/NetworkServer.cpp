@@ -16,3 +16,8 @@ NetworkServer::NetworkServer()
 NetworkServer::~NetworkServer()
 {
 }
+
+void
+NetworkServer::cancelMsgs()
+{
+}
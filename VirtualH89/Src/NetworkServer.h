@@ -22,6 +22,8 @@ class NetworkServer
 
     virtual int checkRecvMsg(uint8_t clientId, uint8_t* msgbuf, int len) = 0;
     virtual int sendMsg(uint8_t* msgbuf, int len)                        = 0;
+    /// Client was reset, drop any responses it will no longer collect.
+    virtual void cancelMsgs();
 
     // This is the standard CP/Net message header.
     struct ndos
@@ -0,0 +1,392 @@
+/// \file OperatorServer.cpp
+///
+/// Control server for the H89Operator interface on a Unix domain socket.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#include "OperatorServer.h"
+
+#include "WallClock.h"
+#include "logger.h"
+
+/// \cond
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+/// \endcond
+
+
+OperatorServer::OperatorServer(): ClockUser(true),
+                                  listenFd_m(-1),
+                                  nextClientId_m(1),
+                                  commandsPending_m(false)
+{
+    pthread_mutex_init(&mutex_m, nullptr);
+    H89Operator::addListener(this);
+}
+
+OperatorServer::~OperatorServer()
+{
+    H89Operator::removeListener(this);
+    HostIOThread::instance()->removeListener(this);
+
+    for (std::map<unsigned int, Client>::iterator it = clients_m.begin(); it != clients_m.end();
+         ++it)
+    {
+        close(it->second.fd);
+    }
+
+    if (listenFd_m >= 0)
+    {
+        close(listenFd_m);
+        unlink(path_m.c_str());
+    }
+}
+
+OperatorServer*
+OperatorServer::install_OperatorServer(PropertyUtil::PropertyMapT& props)
+{
+    std::string s = props["operator_socket"];
+
+    if (s.empty())
+    {
+        return nullptr;
+    }
+
+    OperatorServer* os = new OperatorServer();
+
+    if (!os->listen(s))
+    {
+        delete os;
+        return nullptr;
+    }
+
+    return os;
+}
+
+bool
+OperatorServer::listen(std::string path)
+{
+    struct sockaddr_un addr;
+
+    if (path.length() >= sizeof(addr.sun_path))
+    {
+        debugss(ssStdioConsole, ERROR, "socket path too long: %s\n", path.c_str());
+        return false;
+    }
+
+    listenFd_m = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listenFd_m < 0)
+    {
+        return false;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    path_m          = path;
+    unlink(path_m.c_str());
+
+    if (bind(listenFd_m, (struct sockaddr*) &addr, sizeof(addr)) < 0 ||
+        ::listen(listenFd_m, maxClients_c) < 0)
+    {
+        debugss(ssStdioConsole, ERROR, "unable to listen on %s: %d\n", path_m.c_str(), errno);
+        close(listenFd_m);
+        listenFd_m = -1;
+        return false;
+    }
+
+    debugss(ssStdioConsole, INFO, "operator server listening on %s\n", path_m.c_str());
+
+    return HostIOThread::instance()->addSource(listenFd_m, HostIOThread::ioRead, this);
+}
+
+///
+/// Runs any commands received since the last instruction.
+///
+void
+OperatorServer::notification(unsigned int cycleCount)
+{
+    if (!commandsPending_m)
+    {
+        return;
+    }
+
+    std::deque<Command> cmds;
+
+    pthread_mutex_lock(&mutex_m);
+    cmds.swap(commands_m);
+    commandsPending_m = false;
+    pthread_mutex_unlock(&mutex_m);
+
+    for (int x = 0; x < cmds.size(); ++x)
+    {
+        // may generate events, so must not hold mutex_m.
+        std::string resp = op_m.executeCommand(cmds[x].cmd);
+
+        pthread_mutex_lock(&mutex_m);
+        queueOutput(cmds[x].clientId, resp);
+        pthread_mutex_unlock(&mutex_m);
+    }
+
+    HostIOThread::instance()->wakeup(this);
+}
+
+void
+OperatorServer::operatorEvent(std::string event)
+{
+    pthread_mutex_lock(&mutex_m);
+
+    for (std::map<unsigned int, Client>::iterator it = clients_m.begin(); it != clients_m.end();
+         ++it)
+    {
+        queueOutput(it->first, "event " + event);
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    HostIOThread::instance()->wakeup(this);
+}
+
+/// Must hold mutex_m.
+void
+OperatorServer::queueOutput(unsigned int       id,
+                            const std::string& line)
+{
+    std::map<unsigned int, Client>::iterator it = clients_m.find(id);
+
+    // client may have gone away while the command was running.
+    if (it != clients_m.end())
+    {
+        it->second.out += line;
+        it->second.out += '\n';
+    }
+}
+
+void
+OperatorServer::ioReady(int  fd,
+                        bool readable,
+                        bool writable,
+                        bool hangup)
+{
+    if (fd == listenFd_m)
+    {
+        acceptClient();
+        return;
+    }
+
+    std::map<int, unsigned int>::iterator it = fdToClient_m.find(fd);
+
+    if (it == fdToClient_m.end())
+    {
+        return;
+    }
+
+    unsigned int id = it->second;
+
+    if (writable)
+    {
+        flushClient(id);
+    }
+
+    if (readable || hangup)
+    {
+        readClient(id);
+    }
+}
+
+void
+OperatorServer::ioWakeup()
+{
+    std::vector<unsigned int> ids;
+
+    pthread_mutex_lock(&mutex_m);
+
+    for (std::map<unsigned int, Client>::iterator it = clients_m.begin(); it != clients_m.end();
+         ++it)
+    {
+        ids.push_back(it->first);
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    for (int x = 0; x < ids.size(); ++x)
+    {
+        flushClient(ids[x]);
+    }
+}
+
+void
+OperatorServer::acceptClient()
+{
+    int fd = accept(listenFd_m, nullptr, nullptr);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    if (fdToClient_m.size() >= maxClients_c)
+    {
+        static const char busy[] = "error busy\n";
+
+        write(fd, busy, sizeof(busy) - 1);
+        close(fd);
+        return;
+    }
+
+    pthread_mutex_lock(&mutex_m);
+
+    unsigned int id = nextClientId_m++;
+    clients_m[id]    = {fd, "", "", false};
+    fdToClient_m[fd] = id;
+
+    pthread_mutex_unlock(&mutex_m);
+
+    debugss(ssStdioConsole, INFO, "client %d connected\n", id);
+
+    HostIOThread::instance()->addSource(fd, HostIOThread::ioRead, this);
+}
+
+void
+OperatorServer::readClient(unsigned int id)
+{
+    char buf[1024];
+    int  fd;
+
+    pthread_mutex_lock(&mutex_m);
+    fd = clients_m[id].fd;
+    pthread_mutex_unlock(&mutex_m);
+
+    while (true)
+    {
+        ssize_t num = read(fd, buf, sizeof(buf));
+
+        if (num < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (num < 0 && errno == EAGAIN)
+        {
+            break;
+        }
+
+        if (num <= 0)
+        {
+            closeClient(id);
+            return;
+        }
+
+        pthread_mutex_lock(&mutex_m);
+
+        Client& client = clients_m[id];
+        client.in.append(buf, num);
+
+        size_t  pos;
+
+        while ((pos = client.in.find('\n')) != std::string::npos)
+        {
+            std::string cmd = client.in.substr(0, pos);
+            client.in.erase(0, pos + 1);
+
+            if (!cmd.empty() && cmd[cmd.length() - 1] == '\r')
+            {
+                cmd.erase(cmd.length() - 1);
+            }
+
+            commands_m.push_back({id, cmd});
+            commandsPending_m = true;
+            WallClock::instance()->requestHostWork();
+        }
+
+        bool overflow = (client.in.length() > maxLineLen_c);
+
+        pthread_mutex_unlock(&mutex_m);
+
+        if (overflow)
+        {
+            debugss(ssStdioConsole, ERROR, "client %d: command too long\n", id);
+            closeClient(id);
+            return;
+        }
+    }
+}
+
+void
+OperatorServer::flushClient(unsigned int id)
+{
+    pthread_mutex_lock(&mutex_m);
+
+    std::map<unsigned int, Client>::iterator it = clients_m.find(id);
+
+    if (it == clients_m.end())
+    {
+        pthread_mutex_unlock(&mutex_m);
+        return;
+    }
+
+    Client& client  = it->second;
+    bool    blocked = false;
+    bool    failed  = (client.out.length() > maxOutputLen_c);
+
+    while (!failed && !client.out.empty())
+    {
+        ssize_t num = write(client.fd, client.out.data(), client.out.length());
+
+        if (num > 0)
+        {
+            client.out.erase(0, num);
+        }
+        else if (num < 0 && errno == EAGAIN)
+        {
+            blocked = true;
+            break;
+        }
+        else if (num < 0 && errno != EINTR)
+        {
+            failed = true;
+        }
+    }
+
+    if (!failed && blocked != client.writeBlocked)
+    {
+        client.writeBlocked = blocked;
+        HostIOThread::instance()->modifySource(client.fd, HostIOThread::ioRead |
+                                               (blocked ? HostIOThread::ioWrite : 0));
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    if (failed)
+    {
+        closeClient(id);
+    }
+}
+
+void
+OperatorServer::closeClient(unsigned int id)
+{
+    pthread_mutex_lock(&mutex_m);
+
+    std::map<unsigned int, Client>::iterator it = clients_m.find(id);
+
+    if (it != clients_m.end())
+    {
+        int fd = it->second.fd;
+
+        HostIOThread::instance()->removeSource(fd);
+        close(fd);
+        fdToClient_m.erase(fd);
+        clients_m.erase(it);
+
+        debugss(ssStdioConsole, INFO, "client %d disconnected\n", id);
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+}
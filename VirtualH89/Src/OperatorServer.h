@@ -0,0 +1,106 @@
+/// \file OperatorServer.h
+///
+/// Control server for the H89Operator interface on a Unix domain socket.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#ifndef OPERATORSERVER_H_
+#define OPERATORSERVER_H_
+
+#include "ClockUser.h"
+#include "HostIOThread.h"
+#include "H89Operator.h"
+#include "propertyutil.h"
+
+/// \cond
+#include <atomic>
+#include <deque>
+#include <map>
+#include <pthread.h>
+#include <string>
+/// \endcond
+
+///
+/// \class OperatorServer
+///
+/// \brief Serves H89Operator commands to any number of socket clients.
+///
+/// Each client sends newline-terminated commands, and may send several before
+/// reading any responses. Responses are returned one per line, in order. Events
+/// are sent to every client as lines starting with "event ".
+///
+/// Socket I/O runs on the HostIOThread and never blocks. Commands run on the CPU
+/// thread between instructions, so neither a slow client nor the command itself
+/// has to wait for the system mutex.
+///
+/// Property syntax:
+///
+///     operator_socket = <socket-path>
+///
+class OperatorServer: public ClockUser, public HostIOListener, public OperatorEventListener
+{
+  public:
+    OperatorServer();
+    virtual ~OperatorServer() override;
+
+    static OperatorServer* install_OperatorServer(PropertyUtil::PropertyMapT& props);
+
+    bool listen(std::string path);
+
+    virtual void notification(unsigned int cycleCount) override;
+
+    virtual void ioReady(int  fd,
+                         bool readable,
+                         bool writable,
+                         bool hangup) override;
+    virtual void ioWakeup() override;
+
+    virtual void operatorEvent(std::string event) override;
+
+  private:
+    struct Client
+    {
+        int          fd;
+        std::string  in;
+        std::string  out;
+        bool         writeBlocked;
+    };
+
+    struct Command
+    {
+        unsigned int clientId;
+        std::string  cmd;
+    };
+
+    void acceptClient();
+    void readClient(unsigned int id);
+    void flushClient(unsigned int id);
+    void closeClient(unsigned int id);
+    void queueOutput(unsigned int       id,
+                     const std::string& line);
+
+    H89Operator                    op_m;
+    std::string                    path_m;
+    int                            listenFd_m;
+
+    /// protects clients_m and commands_m.
+    pthread_mutex_t                mutex_m;
+
+    /// keyed by a never reused id, so a response for a closed client can't go
+    /// to a new client that got the same fd.
+    std::map<unsigned int, Client> clients_m;
+    std::map<int, unsigned int>    fdToClient_m;
+    unsigned int                   nextClientId_m;
+
+    std::deque<Command>            commands_m;
+    std::atomic_bool               commandsPending_m;
+
+    static const int               maxClients_c   = 16;
+    static const size_t            maxLineLen_c   = 4096;
+    /// clients that don't read their responses are dropped.
+    static const size_t            maxOutputLen_c = 1024 * 1024;
+};
+
+#endif // OPERATORSERVER_H_
@@ -0,0 +1,349 @@
+/// \file OverlayImage.cpp
+///
+///  Copy-on-write view of a shared, read-only media image.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#include "OverlayImage.h"
+
+#include "logger.h"
+
+/// \cond
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+/// \endcond
+
+const char   OverlayImage::magic_c[8] = {'V', 'H', '8', '9', 'C', 'O', 'W', '1'};
+const size_t OverlayImage::blockSize_c;
+const size_t OverlayImage::bitmapOffset_c;
+
+OverlayImage::OverlayImage(const std::string& base,
+                           const std::string& delta): base_m(base),
+                                                      delta_m(delta),
+                                                      deltaFd_m(-1),
+                                                      image_m(nullptr),
+                                                      size_m(0),
+                                                      numBlocks_m(0),
+                                                      dataStart_m(0),
+                                                      anyDirty_m(false),
+                                                      unsynced_m(false)
+{
+    int fd = open(base.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to open base image %s (%d)\n", base.c_str(), errno);
+        return;
+    }
+
+    struct stat st;
+    void*       image = MAP_FAILED;
+
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        // private, so changes never reach the base file.
+        image = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+
+    close(fd);
+
+    if (image == MAP_FAILED)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to map base image %s (%d)\n", base.c_str(), errno);
+        return;
+    }
+
+    image_m     = (BYTE*) image;
+    size_m      = st.st_size;
+    numBlocks_m = (size_m + blockSize_c - 1) / blockSize_c;
+    dataStart_m = ((bitmapOffset_c + (numBlocks_m + 7) / 8 + blockSize_c - 1) / blockSize_c) *
+                  blockSize_c;
+    dirty_m.assign(numBlocks_m, false);
+
+    if (!openDelta())
+    {
+        closeImage();
+    }
+}
+
+OverlayImage::~OverlayImage()
+{
+    closeImage();
+}
+
+bool
+OverlayImage::isOverlayArg(const std::string& arg,
+                           std::string&       delta)
+{
+    if (arg.compare(0, 4, "cow=") != 0 || arg.length() == 4)
+    {
+        return false;
+    }
+
+    delta = arg.substr(4);
+
+    return true;
+}
+
+bool
+OverlayImage::openDelta()
+{
+    deltaFd_m = open(delta_m.c_str(), O_RDWR | O_CREAT, 0644);
+
+    if (deltaFd_m < 0)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to open delta %s (%d)\n", delta_m.c_str(), errno);
+        return false;
+    }
+
+    DeltaHeader hdr;
+    size_t      bitmapLen = (numBlocks_m + 7) / 8;
+    ssize_t     num       = ::pread(deltaFd_m, &hdr, sizeof(hdr), 0);
+
+    present_m.assign(bitmapLen, 0);
+
+    if (num == 0)
+    {
+        // new delta, the data area is left as a hole.
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, magic_c, sizeof(magic_c));
+        hdr.blockSize = blockSize_c;
+        hdr.numBlocks = numBlocks_m;
+        hdr.baseSize  = size_m;
+
+        if (::pwrite(deltaFd_m, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+            ftruncate(deltaFd_m, dataStart_m) < 0)
+        {
+            debugss(ssFloppyDisk, ERROR, "Unable to create delta %s (%d)\n", delta_m.c_str(),
+                    errno);
+            return false;
+        }
+
+        debugss(ssFloppyDisk, INFO, "Created delta %s for %s\n", delta_m.c_str(), base_m.c_str());
+
+        return true;
+    }
+
+    if (num != sizeof(hdr) || memcmp(hdr.magic, magic_c, sizeof(magic_c)) != 0 ||
+        hdr.blockSize != blockSize_c || hdr.numBlocks != numBlocks_m || hdr.baseSize != size_m)
+    {
+        debugss(ssFloppyDisk, ERROR, "Delta %s does not match base %s\n", delta_m.c_str(),
+                base_m.c_str());
+        return false;
+    }
+
+    if (::pread(deltaFd_m, &present_m[0], bitmapLen, bitmapOffset_c) != (ssize_t) bitmapLen)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to read delta %s (%d)\n", delta_m.c_str(), errno);
+        return false;
+    }
+
+    int count = 0;
+
+    for (size_t blk = 0; blk < numBlocks_m; ++blk)
+    {
+        if ((present_m[blk / 8] & (1 << (blk % 8))) == 0)
+        {
+            continue;
+        }
+
+        size_t off = blk * blockSize_c;
+        size_t len = std::min(blockSize_c, size_m - off);
+
+        if (::pread(deltaFd_m, image_m + off, len, dataStart_m + off) != (ssize_t) len)
+        {
+            debugss(ssFloppyDisk, ERROR, "Unable to read delta %s (%d)\n", delta_m.c_str(), errno);
+            return false;
+        }
+
+        ++count;
+    }
+
+    debugss(ssFloppyDisk, INFO, "%s: %d blocks from delta %s\n", base_m.c_str(), count,
+            delta_m.c_str());
+
+    return true;
+}
+
+void
+OverlayImage::closeImage()
+{
+    sync();
+
+    if (deltaFd_m >= 0)
+    {
+        close(deltaFd_m);
+        deltaFd_m = -1;
+    }
+
+    if (image_m != nullptr)
+    {
+        munmap(image_m, size_m);
+        image_m = nullptr;
+    }
+}
+
+bool
+OverlayImage::isOpen()
+{
+    return (image_m != nullptr);
+}
+
+size_t
+OverlayImage::size()
+{
+    return size_m;
+}
+
+BYTE*
+OverlayImage::data()
+{
+    return image_m;
+}
+
+void
+OverlayImage::written(size_t off,
+                      size_t len)
+{
+    if (len == 0 || off >= size_m)
+    {
+        return;
+    }
+
+    size_t last = std::min(off + len, size_m) - 1;
+
+    for (size_t blk = off / blockSize_c; blk <= last / blockSize_c; ++blk)
+    {
+        dirty_m[blk] = true;
+    }
+
+    anyDirty_m = true;
+}
+
+ssize_t
+OverlayImage::pread(void*  buf,
+                    size_t len,
+                    off_t  off)
+{
+    if (image_m == nullptr || off < 0 || (size_t) off >= size_m)
+    {
+        return 0;
+    }
+
+    len = std::min(len, size_m - off);
+    memcpy(buf, image_m + off, len);
+
+    return len;
+}
+
+ssize_t
+OverlayImage::pwrite(const void* buf,
+                     size_t      len,
+                     off_t       off)
+{
+    // the image can't grow.
+    if (image_m == nullptr || off < 0 || (size_t) off + len > size_m)
+    {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    memcpy(image_m + off, buf, len);
+    written(off, len);
+
+    return len;
+}
+
+void
+OverlayImage::flush()
+{
+    writeBlocks(false);
+}
+
+void
+OverlayImage::sync()
+{
+    writeBlocks(true);
+}
+
+///
+/// When durable, block data reaches the disk before the bitmap marks it
+/// present, so a host crash leaves a block written for the first time either
+/// absent (the base's contents) or complete. A block already present is
+/// rewritten in place, and may be left torn.
+///
+void
+OverlayImage::writeBlocks(bool durable)
+{
+    if (deltaFd_m < 0)
+    {
+        return;
+    }
+
+    if (!anyDirty_m)
+    {
+        if (durable && unsynced_m && fdatasync(deltaFd_m) == 0)
+        {
+            unsynced_m = false;
+        }
+
+        return;
+    }
+
+    std::vector<BYTE>   present = present_m;
+    std::vector<size_t> saved;
+    bool                failed  = false;
+
+    for (size_t blk = 0; blk < numBlocks_m; ++blk)
+    {
+        if (!dirty_m[blk])
+        {
+            continue;
+        }
+
+        size_t off = blk * blockSize_c;
+        size_t len = std::min(blockSize_c, size_m - off);
+
+        if (::pwrite(deltaFd_m, image_m + off, len, dataStart_m + off) != (ssize_t) len)
+        {
+            failed = true;
+            continue;
+        }
+
+        saved.push_back(blk);
+        present[blk / 8] |= (1 << (blk % 8));
+    }
+
+    if ((durable && fdatasync(deltaFd_m) < 0) ||
+        (present != present_m &&
+         (::pwrite(deltaFd_m, &present[0], present.size(), bitmapOffset_c) !=
+          (ssize_t) present.size() || (durable && fdatasync(deltaFd_m) < 0))))
+    {
+        // all of them are retried next time.
+        debugss(ssFloppyDisk, ERROR, "Unable to write delta %s (%d)\n", delta_m.c_str(), errno);
+        return;
+    }
+
+    present_m  = present;
+    unsynced_m = !durable;
+
+    for (size_t x = 0; x < saved.size(); ++x)
+    {
+        dirty_m[saved[x]] = false;
+    }
+
+    if (failed)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to write delta %s (%d)\n", delta_m.c_str(), errno);
+        return;
+    }
+
+    anyDirty_m = false;
+}
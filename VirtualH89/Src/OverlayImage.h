@@ -0,0 +1,107 @@
+/// \file OverlayImage.h
+///
+///  Copy-on-write view of a shared, read-only media image.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#ifndef OVERLAYIMAGE_H_
+#define OVERLAYIMAGE_H_
+
+#include "h89Types.h"
+
+/// \cond
+#include <stdint.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+/// \endcond
+
+///
+/// \class OverlayImage
+///
+/// \brief A read-only base image plus a private delta file.
+///
+/// The base is never written, so any number of emulator instances can mount
+/// the same file and share its page cache. It is mapped privately, changed
+/// blocks are kept in a sparse delta file and laid over the mapping on
+/// mount. Unchanged blocks are read straight from the base.
+///
+/// The delta file is a header and a bitmap of the blocks present, followed by
+/// room for every block at its own offset, most of which is never written.
+/// Blocks are rewritten in place, so a crash during sync() can leave a block
+/// that was already in the delta half old and half new.
+///
+/// Selected by a 'cow=<delta file>' option in a disk specification.
+///
+class OverlayImage
+{
+  public:
+    OverlayImage(const std::string& base,
+                 const std::string& delta);
+    ~OverlayImage();
+
+    OverlayImage(const OverlayImage&)            = delete;
+    OverlayImage& operator=(const OverlayImage&) = delete;
+
+    bool isOpen();
+    size_t size();
+
+    /// the whole image, with the delta applied. Changes made through this
+    /// must be reported with written().
+    BYTE* data();
+    void written(size_t off,
+                 size_t len);
+
+    ssize_t pread(void*  buf,
+                  size_t len,
+                  off_t  off);
+    ssize_t pwrite(const void* buf,
+                   size_t      len,
+                   off_t       off);
+
+    /// writes changed blocks to the delta file, enough to survive the
+    /// emulator exiting.
+    void flush();
+    /// as flush(), and forces them to the host disk.
+    void sync();
+
+    /// returns true, and sets delta, if arg is a 'cow=' option.
+    static bool isOverlayArg(const std::string& arg,
+                             std::string&       delta);
+
+  private:
+    struct DeltaHeader
+    {
+        char     magic[8];
+        uint32_t blockSize;
+        uint32_t numBlocks;
+        uint64_t baseSize;
+    };
+
+    bool openDelta();
+    void closeImage();
+    void writeBlocks(bool durable);
+
+    std::string          base_m;
+    std::string          delta_m;
+    int                  deltaFd_m;
+    BYTE*                image_m;
+    size_t               size_m;
+    size_t               numBlocks_m;
+    off_t                dataStart_m;
+    /// blocks held in the delta file, as stored in it.
+    std::vector<BYTE>    present_m;
+    /// blocks changed since the last sync().
+    std::vector<bool>    dirty_m;
+    bool                 anyDirty_m;
+    /// flushed, but not yet synced.
+    bool                 unsynced_m;
+
+    static const char    magic_c[8];
+    static const size_t  blockSize_c = 4096;
+    static const size_t  bitmapOffset_c = sizeof(DeltaHeader);
+};
+
+#endif // OVERLAYIMAGE_H_
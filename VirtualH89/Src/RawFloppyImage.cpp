@@ -21,6 +21,8 @@
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <algorithm>
 /// \endcond
 
 
@@ -70,6 +72,19 @@ RawFloppyImage::eject(const std::string file)
     cacheTrack(-1, -1);
     close(imageFd_m);
     imageFd_m = -1;
+    overlay_m.reset();
+    dropTracks();
+}
+
+void
+RawFloppyImage::sync()
+{
+    flushTracks();
+
+    if (overlay_m)
+    {
+        overlay_m->sync();
+    }
 }
 
 void
@@ -85,8 +100,9 @@ RawFloppyImage::RawFloppyImage(GenericDiskDrive*        drive,
                                                                trackBuffer_m(nullptr),
                                                                bufferedTrack_m(-1),
                                                                bufferedSide_m(-1),
-                                                               bufferOffset_m(0),
-                                                               bufferDirty_m(false),
+                                                               cache_m(cacheTracks_c),
+                                                               curTrack_m(nullptr),
+                                                               useCount_m(0),
                                                                hypoTrack_m(false),
                                                                hyperTrack_m(false),
                                                                interlaced_m(false),
@@ -110,6 +126,7 @@ RawFloppyImage::RawFloppyImage(GenericDiskDrive*        drive,
     bool        ss    = false, ds = false;
     bool        st    = false, dt = false;
     int         media = 0;
+    std::string delta;
 
     for (int x = 1; x < argv.size(); ++x)
     {
@@ -149,23 +166,40 @@ RawFloppyImage::RawFloppyImage(GenericDiskDrive*        drive,
         {
             writeProtect_m = false;
         }
+        else if (OverlayImage::isOverlayArg(argv[x], delta))
+        {
+            writeProtect_m = false;
+        }
         else
         {
             debugss(ssRawFloppyImage, WARNING, "unrecognized hint - %s\n", argv[x].c_str());
         }
     }
 
-    if (!writeProtect_m && access(name, W_OK) != 0)
+    if (!delta.empty())
+    {
+        overlay_m.reset(new OverlayImage(name, delta));
+
+        if (!overlay_m->isOpen())
+        {
+            overlay_m.reset();
+            free((void*) name);
+            return;
+        }
+    }
+
+    if (!writeProtect_m && !overlay_m && access(name, W_OK) != 0)
     {
         debugss(ssRawFloppyImage, WARNING, "Image not writeable: %s\n", name);
         writeProtect_m = true;
     }
 
-    int fd = open(name, writeProtect_m ? O_RDONLY : O_RDWR);
+    int fd = open(name, (writeProtect_m || overlay_m) ? O_RDONLY : O_RDWR);
 
     if (fd < 0)
     {
         debugss(ssRawFloppyImage, ERROR, "unable to open file - %s\n", name);
+        overlay_m.reset();
         free((void*) name);
         return;
     }
@@ -173,28 +207,22 @@ RawFloppyImage::RawFloppyImage(GenericDiskDrive*        drive,
     // First examine at least one track, but we don't know the format...
     // So get enough data for 1.5 DD tracks on this drive...
     long nbytes = drive->getRawBytesPerTrack() * 2;
-    nbytes       += nbytes / 2;
-    trackBuffer_m = new BYTE[nbytes];
+    nbytes += nbytes / 2;
+    std::vector<BYTE> probe(nbytes);
 
-    if (trackBuffer_m == nullptr)
-    {
-        debugss(ssRawFloppyImage, ERROR, "unable to allocate track buffer of %ld bytes\n", nbytes);
-        close(fd);
-        free((void*) name);
-        return;
-    }
-
-    long n = read(fd, trackBuffer_m, nbytes);
+    long              n = overlay_m ? overlay_m->pread(&probe[0], nbytes, 0) :
+                          read(fd, &probe[0], nbytes);
 
     if (n != nbytes)
     {
         debugss(ssRawFloppyImage, ERROR, "unable to read a track\n");
+        overlay_m.reset();
         close(fd);
         free((void*) name);
         return;
     }
 
-    BYTE*    tp     = trackBuffer_m;
+    BYTE*    tp     = &probe[0];
     BYTE*    idx    = nullptr;
     BYTE*    dat    = nullptr;
     BYTE*    end    = nullptr;
@@ -262,7 +290,7 @@ RawFloppyImage::RawFloppyImage(GenericDiskDrive*        drive,
             if (dat == nullptr)
             {
                 dat    = tp + 1;
-                idxgap = (unsigned) (dat - trackBuffer_m);
+                idxgap = (unsigned) (dat - &probe[0]);
             }
             else if (gaplen == 0)
             {
@@ -288,6 +316,7 @@ RawFloppyImage::RawFloppyImage(GenericDiskDrive*        drive,
         id_tk != 0 || id_sd != 0)
     {
         debugss(ssRawFloppyImage, ERROR, "format not recognized\n");
+        overlay_m.reset();
         free((void*) name);
         close(fd);
         return;
@@ -468,16 +497,15 @@ RawFloppyImage::RawFloppyImage(GenericDiskDrive*        drive,
         }
     }
 
-    // TODO: keep oversized buffer or free and alloc exact size needed?
+    // tracks read while probing used a provisional geometry.
+    dropTracks();
 
     imageName_m     = name;
-    bufferedTrack_m = -1;
-    bufferedSide_m  = -1;
-    bufferDirty_m   = false;
     debugss(ssRawFloppyImage, ERROR,
-            "mounted %d\" floppy %s: sides=%d tracks=%d spt=%d DD=%s R%s\n",
+            "mounted %d\" floppy %s: sides=%d tracks=%d spt=%d DD=%s R%s%s\n",
             mediaSize_m, imageName_m, numSides_m, numTracks_m, numSectors_m,
-            doubleDensity_m ? "yes" : "no", writeProtect_m ? "O" : "W");
+            doubleDensity_m ? "yes" : "no", writeProtect_m ? "O" : "W",
+            overlay_m ? " (cow)" : "");
 }
 
 RawFloppyImage::~RawFloppyImage()
@@ -488,9 +516,9 @@ RawFloppyImage::~RawFloppyImage()
     }
 
     debugss(ssRawFloppyImage, INFO, "unmounted %s\n", imageName_m);
-    free((void*) imageName_m);
     // flush data...
     cacheTrack(-1, -1);
+    free((void*) imageName_m);
     close(imageFd_m); // check errors?
     imageFd_m = -1;
 }
@@ -499,7 +527,7 @@ bool
 RawFloppyImage::cacheTrack(int side,
                            int track)
 {
-    if (bufferedSide_m == side && bufferedTrack_m == track)
+    if (curTrack_m != nullptr && bufferedSide_m == side && bufferedTrack_m == track)
     {
         return true;
     }
@@ -509,24 +537,16 @@ RawFloppyImage::cacheTrack(int side,
         return false;
     }
 
-    if (bufferDirty_m && bufferedSide_m != -1 && bufferedTrack_m != -1)
-    {
-        // Must write to disk...
-        lseek(imageFd_m, bufferOffset_m, SEEK_SET);
-        long rd = write(imageFd_m, trackBuffer_m, trackLen_m);
-        if (rd != trackLen_m)
-        {
-            debugss(ssRawFloppyImage, ERROR, "Unable to write to file %s\n", imageName_m);
-        }
-        bufferDirty_m = false;
-    }
-
     if (side < 0 || track < 0)
     {
         // just flush only.
+        flushTracks();
         return true;
     }
 
+    int reqSide  = side;
+    int reqTrack = track;
+
     if (hypoTrack_m)
     {
         if ((track & 1) != 0)
@@ -541,51 +561,200 @@ RawFloppyImage::cacheTrack(int side,
         track *= 2;
     }
 
-    if (interlaced_m)
+    CachedTrack* ct     = nullptr;
+    CachedTrack* victim = &cache_m[0];
+
+    for (int x = 0; x < cache_m.size(); ++x)
     {
-        bufferOffset_m = (track * numSides_m + side) * trackLen_m;
+        if (cache_m[x].side == side && cache_m[x].track == track)
+        {
+            ct = &cache_m[x];
+            break;
+        }
+
+        if (cache_m[x].lastUse < victim->lastUse)
+        {
+            victim = &cache_m[x];
+        }
     }
-    else
+
+    if (ct == nullptr)
+    {
+        if (victim->dirty)
+        {
+            writeTrack(*victim);
+        }
+
+        ct        = victim;
+        ct->side  = -1;
+        ct->track = -1;
+
+        if (interlaced_m)
+        {
+            ct->offset = (track * numSides_m + side) * trackLen_m;
+        }
+        else
+        {
+            ct->offset = (side * numTracks_m + track) * trackLen_m;
+        }
+
+        ct->data.resize(trackLen_m);
+        long rd = readImage(&ct->data[0], trackLen_m, ct->offset);
+
+        if (rd != trackLen_m)
+        {
+            ct->lastUse     = 0;
+            curTrack_m      = nullptr;
+            bufferedSide_m  = -1;
+            bufferedTrack_m = -1;
+            return false;
+        }
+
+        ct->side  = side;
+        ct->track = track;
+        indexTrack(*ct);
+    }
+
+    ct->lastUse     = ++useCount_m;
+    curTrack_m      = ct;
+    trackBuffer_m   = &ct->data[0];
+    headPos_m       = 0;
+    bufferedSide_m  = reqSide;
+    bufferedTrack_m = reqTrack;
+    return true;
+}
+
+///
+/// Records where each address mark is, walking the track the same way
+/// findMark() would: the contents of address and data fields are skipped,
+/// so data bytes that happen to look like marks are not indexed.
+///
+void
+RawFloppyImage::indexTrack(CachedTrack& ct)
+{
+    int pos = 0;
+
+    ct.marks.clear();
+
+    while (pos < trackLen_m)
     {
-        bufferOffset_m = (side * numTracks_m + track) * trackLen_m;
+        BYTE d = ct.data[pos];
+
+        if (d == GenericFloppyFormat::ID_AM_BYTE)
+        {
+            ct.marks.push_back(pos);
+            pos += 7;
+        }
+        else if (d == GenericFloppyFormat::DATA_AM_BYTE)
+        {
+            ct.marks.push_back(pos);
+            pos += secSize_m + 3;
+        }
+        else
+        {
+            ++pos;
+        }
     }
+}
 
-    lseek(imageFd_m, bufferOffset_m, SEEK_SET);
-    long rd = read(imageFd_m, trackBuffer_m, trackLen_m);
+bool
+RawFloppyImage::writeTrack(CachedTrack& ct)
+{
+    long rd = writeImage(&ct.data[0], trackLen_m, ct.offset);
 
     if (rd != trackLen_m)
     {
-        bufferedSide_m  = -1;
-        bufferedTrack_m = -1;
+        debugss(ssRawFloppyImage, ERROR, "Unable to write to file %s (%d)\n", imageName_m,
+                errno);
         return false;
     }
 
-    headPos_m       = 0;
-    bufferedSide_m  = side;
-    bufferedTrack_m = track;
+    ct.dirty = false;
     return true;
 }
 
+ssize_t
+RawFloppyImage::readImage(BYTE*  buf,
+                          size_t len,
+                          off_t  off)
+{
+    if (overlay_m)
+    {
+        return overlay_m->pread(buf, len, off);
+    }
+
+    return pread(imageFd_m, buf, len, off);
+}
+
+ssize_t
+RawFloppyImage::writeImage(const BYTE* buf,
+                           size_t      len,
+                           off_t       off)
+{
+    if (overlay_m)
+    {
+        return overlay_m->pwrite(buf, len, off);
+    }
+
+    return pwrite(imageFd_m, buf, len, off);
+}
+
+void
+RawFloppyImage::flushTracks()
+{
+    if (imageFd_m < 0)
+    {
+        return;
+    }
+
+    for (int x = 0; x < cache_m.size(); ++x)
+    {
+        if (cache_m[x].side >= 0 && cache_m[x].dirty)
+        {
+            writeTrack(cache_m[x]);
+        }
+    }
+}
+
+void
+RawFloppyImage::dropTracks()
+{
+    for (int x = 0; x < cache_m.size(); ++x)
+    {
+        cache_m[x] = CachedTrack();
+    }
+
+    curTrack_m      = nullptr;
+    trackBuffer_m   = nullptr;
+    bufferedSide_m  = -1;
+    bufferedTrack_m = -1;
+}
+
 bool
 RawFloppyImage::findMark(int mark)
 {
-    int indexCount = 0;
+    const std::vector<int>& marks      = curTrack_m->marks;
+    int                     indexCount = 0;
+    size_t                  x          = std::lower_bound(marks.begin(), marks.end(), headPos_m) -
+                                         marks.begin();
 
     while (indexCount < 2)
     {
-        BYTE d = trackBuffer_m[headPos_m++];
-
-        if (headPos_m >= trackLen_m)
+        if (x >= marks.size())
         {
             // in most cases, should never hit this since
             // we started at the address fields (there must be
             // sector data after any address field, before index).
             headPos_m = 0;
+            x         = 0;
             ++indexCount;
             continue;
         }
 
-        if (d == GenericFloppyFormat::ID_AM_BYTE)
+        int pos = marks[x++];
+        headPos_m = pos + 1;
+
+        if (trackBuffer_m[pos] == GenericFloppyFormat::ID_AM_BYTE)
         {
             if (mark == GenericFloppyFormat::ID_AM)
             {
@@ -595,7 +764,7 @@ RawFloppyImage::findMark(int mark)
             headPos_m += 6;
         }
 
-        else if (d == GenericFloppyFormat::DATA_AM_BYTE)
+        else
         {
             if (mark == GenericFloppyFormat::DATA_AM)
             {
@@ -799,7 +968,7 @@ RawFloppyImage::writeData(BYTE track,
         else
         {
             trackBuffer_m[dataPos_m++] = data;
-            bufferDirty_m              = true;
+            curTrack_m->dirty          = true;
             result                     = data;
         }
     }
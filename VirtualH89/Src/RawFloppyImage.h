@@ -23,9 +23,11 @@
 
 
 #include "GenericFloppyDisk.h"
+#include "OverlayImage.h"
 
 /// \cond
 #include <sys/types.h>
+#include <memory>
 #include <vector>
 /// \endcond
 
@@ -38,6 +40,12 @@ class GenericDiskDrive;
 ///
 /// \brief A virtual floppy disk
 ///
+/// Recently used tracks are kept in an LRU cache, along with the positions of
+/// their address marks, so stepping between tracks and sides doesn't reload
+/// the image. Modified tracks are written back when evicted, on sync() and on
+/// eject. With a 'cow=<delta file>' option they go to an OverlayImage delta
+/// and the image file is only read.
+///
 class RawFloppyImage: public GenericFloppyDisk
 {
   public:
@@ -62,27 +70,56 @@ class RawFloppyImage: public GenericFloppyDisk
                     BYTE track,
                     BYTE sector) override;
     void eject(const std::string name) override;
+    void sync() override;
     void dump(void) override;
     std::string getMediaName() override;
 
   private:
-    const char*   imageName_m;
-    int           imageFd_m;
-    BYTE*         trackBuffer_m;
-    int           bufferedTrack_m;
-    int           bufferedSide_m;
-    off_t         bufferOffset_m;
-    bool          bufferDirty_m;
-    bool          hypoTrack_m;  // ST media in DT drive
-    bool          hyperTrack_m; // DT media in ST drive
-    bool          interlaced_m;
-    long          gapLen_m;
-    long          indexGapLen_m;
-    unsigned long writePos_m;
-    bool          trackWrite_m;
-    int           headPos_m;
-    int           dataPos_m;
-    int           dataLen_m;
+    struct CachedTrack
+    {
+        CachedTrack(): side(-1),
+                       track(-1),
+                       offset(0),
+                       dirty(false),
+                       lastUse(0)
+        {
+        }
+
+        /// physical side and track, -1 if the entry is unused.
+        int               side;
+        int               track;
+        off_t             offset;
+        bool              dirty;
+        unsigned long     lastUse;
+        std::vector<BYTE> data;
+        /// offsets of the ID and data address marks, in order.
+        std::vector<int>  marks;
+    };
+
+    static const int         cacheTracks_c = 32;
+
+    const char*              imageName_m;
+    int                      imageFd_m;
+    /// set when mounted copy-on-write.
+    std::unique_ptr<OverlayImage> overlay_m;
+    /// data of curTrack_m.
+    BYTE*                    trackBuffer_m;
+    /// side and track as requested, for the current track.
+    int                      bufferedTrack_m;
+    int                      bufferedSide_m;
+    std::vector<CachedTrack> cache_m;
+    CachedTrack*             curTrack_m;
+    unsigned long            useCount_m;
+    bool                     hypoTrack_m;  // ST media in DT drive
+    bool                     hyperTrack_m; // DT media in ST drive
+    bool                     interlaced_m;
+    long                     gapLen_m;
+    long                     indexGapLen_m;
+    unsigned long            writePos_m;
+    bool                     trackWrite_m;
+    int                      headPos_m;
+    int                      dataPos_m;
+    int                      dataLen_m;
 
     void getAddrMark(BYTE* tp,
                      int   nbytes,
@@ -92,6 +129,16 @@ class RawFloppyImage: public GenericFloppyDisk
                      int&  id_sl);
     bool cacheTrack(int side,
                     int track);
+    void indexTrack(CachedTrack& ct);
+    bool writeTrack(CachedTrack& ct);
+    ssize_t readImage(BYTE*  buf,
+                      size_t len,
+                      off_t  off);
+    ssize_t writeImage(const BYTE* buf,
+                       size_t      len,
+                       off_t       off);
+    void flushTracks();
+    void dropTracks();
     bool findMark(int mark);
     bool locateSector(BYTE track,
                       BYTE side,
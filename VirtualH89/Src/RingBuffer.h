@@ -0,0 +1,133 @@
+/// \file RingBuffer.h
+///
+/// Lock-free single-producer/single-consumer byte queue. Used to pass data
+/// between a host I/O thread and the CPU thread without taking the system mutex.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#ifndef RINGBUFFER_H_
+#define RINGBUFFER_H_
+
+#include "h89Types.h"
+
+/// \cond
+#include <atomic>
+/// \endcond
+
+///
+/// \brief Single-producer/single-consumer byte queue.
+///
+/// head_m is only written by the producer and tail_m only by the consumer, both
+/// are free running counters. Size must be a power of 2.
+///
+template <unsigned int Size>
+class RingBuffer
+{
+    static_assert((Size & (Size - 1)) == 0, "RingBuffer size must be a power of 2");
+
+  public:
+    RingBuffer(): head_m(0),
+                  tail_m(0)
+    {
+    }
+
+    /// Producer - add one byte, returns false if the queue is full.
+    bool push(BYTE val)
+    {
+        unsigned int head = head_m.load(std::memory_order_relaxed);
+
+        if (head - tail_m.load(std::memory_order_acquire) >= Size)
+        {
+            return false;
+        }
+
+        buf_m[head & (Size - 1)] = val;
+        head_m.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /// Consumer - remove one byte, returns false if the queue is empty.
+    bool pop(BYTE& val)
+    {
+        unsigned int tail = tail_m.load(std::memory_order_relaxed);
+
+        if (tail == head_m.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        val = buf_m[tail & (Size - 1)];
+        tail_m.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /// Producer - add up to len bytes, returns the number actually queued.
+    unsigned int write(const BYTE*  buf,
+                       unsigned int len)
+    {
+        unsigned int head  = head_m.load(std::memory_order_relaxed);
+        unsigned int avail = Size - (head - tail_m.load(std::memory_order_acquire));
+
+        if (len > avail)
+        {
+            len = avail;
+        }
+
+        for (unsigned int x = 0; x < len; ++x)
+        {
+            buf_m[(head + x) & (Size - 1)] = buf[x];
+        }
+
+        head_m.store(head + len, std::memory_order_release);
+
+        return len;
+    }
+
+    /// Consumer - remove up to len bytes, returns the number actually removed.
+    unsigned int read(BYTE*        buf,
+                      unsigned int len)
+    {
+        unsigned int tail  = tail_m.load(std::memory_order_relaxed);
+        unsigned int avail = head_m.load(std::memory_order_acquire) - tail;
+
+        if (len > avail)
+        {
+            len = avail;
+        }
+
+        for (unsigned int x = 0; x < len; ++x)
+        {
+            buf[x] = buf_m[(tail + x) & (Size - 1)];
+        }
+
+        tail_m.store(tail + len, std::memory_order_release);
+
+        return len;
+    }
+
+    bool empty() const
+    {
+        return head_m.load(std::memory_order_acquire) == tail_m.load(std::memory_order_acquire);
+    }
+
+    unsigned int size() const
+    {
+        return head_m.load(std::memory_order_acquire) - tail_m.load(std::memory_order_acquire);
+    }
+
+    unsigned int space() const
+    {
+        return Size - size();
+    }
+
+  private:
+    std::atomic_uint head_m;
+    std::atomic_uint tail_m;
+    BYTE             buf_m[Size];
+};
+
+#endif // RINGBUFFER_H_
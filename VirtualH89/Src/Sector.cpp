@@ -8,10 +8,13 @@
 
 #include "Sector.h"
 
+#include "SectorArena.h"
 #include "logger.h"
 
 /// \cond
 #include <iostream>
+#include <string.h>
+#include <utility>
 /// \endcond
 
 
@@ -24,20 +27,12 @@ Sector::Sector(BYTE  headNum,
                             sectorNum_m(sectorNum),
                             deletedDataAddressMark_m(false),
                             readError_m(false),
-                            valid_m(false),
+                            valid_m(true),
+                            ownsData_m(true),
+                            data_m(new BYTE[sectorLength]),
                             sectorLength_m(sectorLength)
 {
-    data_m = new BYTE[sectorLength_m];
-
-    if (data_m)
-    {
-        valid_m = true;
-
-        for (int i = 0; i < sectorLength_m; i++)
-        {
-            data_m[i] = data[i];
-        }
-    }
+    copyData(data);
 }
 
 Sector::Sector(BYTE headNum,
@@ -49,25 +44,91 @@ Sector::Sector(BYTE headNum,
                            sectorNum_m(sectorNum),
                            deletedDataAddressMark_m(false),
                            readError_m(false),
-                           valid_m(false),
+                           valid_m(true),
+                           ownsData_m(true),
+                           data_m(new BYTE[sectorLength]),
                            sectorLength_m(sectorLength)
 {
-    data_m = new BYTE[sectorLength_m];
+    memset(data_m, data, sectorLength_m);
+}
 
-    if (data_m)
+Sector::Sector(BYTE         headNum,
+               BYTE         trackNum,
+               BYTE         sectorNum,
+               WORD         sectorLength,
+               const BYTE*  data,
+               SectorArena& arena): headNum_m(headNum),
+                                    trackNum_m(trackNum),
+                                    sectorNum_m(sectorNum),
+                                    deletedDataAddressMark_m(false),
+                                    readError_m(false),
+                                    valid_m(true),
+                                    ownsData_m(false),
+                                    data_m(arena.alloc(sectorLength)),
+                                    sectorLength_m(sectorLength)
+{
+    copyData(data);
+}
+
+///
+/// Arena-backed copies share the data, so a copy of a sector on a mounted disk
+/// still refers to that disk's storage.
+///
+Sector::Sector(const Sector& other): headNum_m(other.headNum_m),
+                                     trackNum_m(other.trackNum_m),
+                                     sectorNum_m(other.sectorNum_m),
+                                     deletedDataAddressMark_m(other.deletedDataAddressMark_m),
+                                     readError_m(other.readError_m),
+                                     valid_m(other.valid_m),
+                                     ownsData_m(other.ownsData_m),
+                                     data_m(other.data_m),
+                                     sectorLength_m(other.sectorLength_m)
+{
+    if (ownsData_m)
     {
-        valid_m = true;
+        data_m = new BYTE[sectorLength_m];
+        copyData(other.data_m);
+    }
+}
 
-        for (int i = 0; i < sectorLength_m; i++)
-        {
-            data_m[i] = data;
-        }
+Sector::Sector(Sector&& other) noexcept: headNum_m(other.headNum_m),
+                                         trackNum_m(other.trackNum_m),
+                                         sectorNum_m(other.sectorNum_m),
+                                         deletedDataAddressMark_m(other.deletedDataAddressMark_m),
+                                         readError_m(other.readError_m),
+                                         valid_m(other.valid_m),
+                                         ownsData_m(other.ownsData_m),
+                                         data_m(other.data_m),
+                                         sectorLength_m(other.sectorLength_m)
+{
+    other.ownsData_m = false;
+    other.data_m     = nullptr;
+}
+
+Sector&
+Sector::operator=(const Sector& other)
+{
+    if (this != &other)
+    {
+        Sector tmp(other);
+
+        std::swap(headNum_m, tmp.headNum_m);
+        std::swap(trackNum_m, tmp.trackNum_m);
+        std::swap(sectorNum_m, tmp.sectorNum_m);
+        std::swap(deletedDataAddressMark_m, tmp.deletedDataAddressMark_m);
+        std::swap(readError_m, tmp.readError_m);
+        std::swap(valid_m, tmp.valid_m);
+        std::swap(ownsData_m, tmp.ownsData_m);
+        std::swap(data_m, tmp.data_m);
+        std::swap(sectorLength_m, tmp.sectorLength_m);
     }
+
+    return *this;
 }
 
 Sector::~Sector()
 {
-    if (data_m)
+    if (ownsData_m)
     {
         delete[] data_m;
     }
@@ -75,6 +136,12 @@ Sector::~Sector()
     valid_m = false;
 }
 
+void
+Sector::copyData(const BYTE* data)
+{
+    memcpy(data_m, data, sectorLength_m);
+}
+
 
 void
 Sector::setDeletedDataAddressMark(bool val)
@@ -159,39 +226,8 @@ Sector::getTrackNum()
     return trackNum_m;
 }
 
-bool
-Sector::readData(WORD  pos,
-                 BYTE& data)
-{
-    debugss(ssFloppyDisk, INFO, "pos: %d\n", pos);
-
-    if (pos < sectorLength_m)
-    {
-        data = data_m[pos];
-
-        debugss(ssFloppyDisk, INFO, "Valid pos: %d 0x%02x\n", data, data);
-
-        return true;
-    }
-
-    return false;
-}
-
-bool
-Sector::writeData(WORD pos,
-                  BYTE data)
+const BYTE*
+Sector::getData()
 {
-    debugss(ssFloppyDisk, INFO, "pos: %d\n", pos);
-
-    if (pos < sectorLength_m)
-    {
-        data_m[pos] = data;
-
-        debugss(ssFloppyDisk, INFO, "Valid pos: %d 0x%02x\n", pos, data);
-
-        return true;
-    }
-    debugss(ssFloppyDisk, ERROR, "pos: %d sectorLength_m: %d\n", pos, sectorLength_m);
-
-    return false;
+    return data_m;
 }
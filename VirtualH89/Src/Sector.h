@@ -11,6 +11,14 @@
 
 #include "h89Types.h"
 
+class SectorArena;
+
+///
+/// \class Sector
+///
+/// Sectors are kept by value in their Track. The data either belongs to the
+/// sector or, for sectors of a loaded image, lives in the disk's SectorArena.
+///
 class Sector
 {
   private:
@@ -20,10 +28,13 @@ class Sector
     bool  deletedDataAddressMark_m;
     bool  readError_m;
     bool  valid_m;
+    bool  ownsData_m;
     BYTE* data_m;
     WORD  sectorLength_m;
     Sector();
 
+    void copyData(const BYTE* data);
+
   public:
 
     //
@@ -38,7 +49,19 @@ class Sector
            BYTE sectorNum,
            WORD sectorLength,
            BYTE data = 0xe5);
-    virtual ~Sector();
+
+    /// copies data into the arena, which must outlive the sector.
+    Sector(BYTE         headNum,
+           BYTE         trackNum,
+           BYTE         sectorNum,
+           WORD         sectorLength,
+           const BYTE*  data,
+           SectorArena& arena);
+
+    Sector(const Sector& other);
+    Sector(Sector&& other) noexcept;
+    Sector& operator=(const Sector& other);
+    ~Sector();
 
     void setDeletedDataAddressMark(bool val);
     void setReadError(bool val);
@@ -51,10 +74,32 @@ class Sector
     BYTE getHeadNum();
     BYTE getTrackNum();
 
-    bool readData(WORD  pos,
-                  BYTE& data);
-    bool writeData(WORD pos,
-                   BYTE data);
+    /// the whole sector, getSectorLength() bytes.
+    const BYTE* getData();
+
+    inline bool readData(WORD  pos,
+                         BYTE& data)
+    {
+        if (pos < sectorLength_m)
+        {
+            data = data_m[pos];
+            return true;
+        }
+
+        return false;
+    }
+
+    inline bool writeData(WORD pos,
+                          BYTE data)
+    {
+        if (pos < sectorLength_m)
+        {
+            data_m[pos] = data;
+            return true;
+        }
+
+        return false;
+    }
 
     void dump();
 };
@@ -0,0 +1,65 @@
+/// \file SectorArena.cpp
+///
+///  Bulk storage for the sector data of one disk.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#include "SectorArena.h"
+
+
+SectorArena::SectorArena(): next_m(nullptr),
+                            avail_m(0),
+                            used_m(0)
+{
+
+}
+
+SectorArena::~SectorArena()
+{
+    for (size_t x = 0; x < blocks_m.size(); ++x)
+    {
+        delete [] blocks_m[x];
+    }
+}
+
+void
+SectorArena::newBlock(size_t len)
+{
+    next_m  = new BYTE[len];
+    avail_m = len;
+    blocks_m.push_back(next_m);
+}
+
+void
+SectorArena::reserve(size_t len)
+{
+    if (len > avail_m)
+    {
+        newBlock(len);
+    }
+}
+
+BYTE*
+SectorArena::alloc(size_t len)
+{
+    if (len > avail_m)
+    {
+        newBlock(len > blockSize_c ? len : blockSize_c);
+    }
+
+    BYTE* ptr = next_m;
+
+    next_m  += len;
+    avail_m -= len;
+    used_m  += len;
+
+    return ptr;
+}
+
+size_t
+SectorArena::size()
+{
+    return used_m;
+}
@@ -0,0 +1,50 @@
+/// \file SectorArena.h
+///
+///  Bulk storage for the sector data of one disk.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#ifndef SECTORARENA_H_
+#define SECTORARENA_H_
+
+#include "h89Types.h"
+
+/// \cond
+#include <stddef.h>
+#include <vector>
+/// \endcond
+
+///
+/// \class SectorArena
+///
+/// \brief Hands out sector buffers from a few large blocks, all freed together
+/// when the disk goes away.
+///
+class SectorArena
+{
+  public:
+    SectorArena();
+    ~SectorArena();
+
+    SectorArena(const SectorArena&)            = delete;
+    SectorArena& operator=(const SectorArena&) = delete;
+
+    BYTE* alloc(size_t len);
+    /// ensures the next len bytes of allocations are contiguous.
+    void reserve(size_t len);
+    size_t size();
+
+  private:
+    void newBlock(size_t len);
+
+    static const size_t blockSize_c = 256 * 1024;
+
+    std::vector<BYTE*>  blocks_m;
+    BYTE*               next_m;
+    size_t              avail_m;
+    size_t              used_m;
+};
+
+#endif // SECTORARENA_H_
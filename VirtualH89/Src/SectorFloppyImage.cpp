@@ -20,10 +20,12 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <algorithm>
 /// \endcond
 
 using namespace std;
@@ -124,9 +126,102 @@ SectorFloppyImage::checkHeader(BYTE* buf, int n)
 void
 SectorFloppyImage::eject(const string file)
 {
-    // flush data...
-    close(imageFd_m);
-    imageFd_m = -1;
+    unmapImage();
+}
+
+void
+SectorFloppyImage::sync()
+{
+    writePages(true);
+}
+
+///
+/// \param durable - wait for the pages to reach the disk. The periodic writes
+///                  don't, they run on the CPU thread.
+///
+void
+SectorFloppyImage::writePages(bool durable)
+{
+    if (!dirty_m)
+    {
+        return;
+    }
+
+    // write each run of dirty pages with a single msync.
+    size_t pages = dirtyPages_m.size();
+
+    for (size_t x = 0; x < pages; ++x)
+    {
+        if (!dirtyPages_m[x])
+        {
+            continue;
+        }
+
+        size_t end = x;
+
+        while (end < pages && dirtyPages_m[end])
+        {
+            dirtyPages_m[end++] = false;
+        }
+
+        size_t off = x * pageSize_m;
+        size_t len = std::min(end * pageSize_m, imageLen_m) - off;
+
+        if (overlay_m)
+        {
+            overlay_m->written(off, len);
+        }
+        else if (msync(image_m + off, len, durable ? MS_SYNC : MS_ASYNC) < 0)
+        {
+            debugss(ssSectorFloppyImage, ERROR, "Unable to write to file %s (%d)\n",
+                    imageName_m, errno);
+        }
+
+        x = end;
+    }
+
+    if (overlay_m && durable)
+    {
+        overlay_m->sync();
+    }
+    else if (overlay_m)
+    {
+        overlay_m->flush();
+    }
+
+    dirty_m    = false;
+    lastSync_m = time(nullptr);
+}
+
+void
+SectorFloppyImage::unmapImage()
+{
+    if (image_m != nullptr)
+    {
+        sync();
+
+        if (overlay_m)
+        {
+            overlay_m.reset();
+        }
+        else
+        {
+            munmap(image_m, imageLen_m);
+        }
+
+        image_m  = nullptr;
+        secBuf_m = nullptr;
+    }
+
+    if (imageFd_m >= 0)
+    {
+        close(imageFd_m);
+        imageFd_m = -1;
+    }
+
+    bufferedSide_m   = -1;
+    bufferedTrack_m  = -1;
+    bufferedSector_m = -1;
 }
 
 void
@@ -139,11 +234,17 @@ SectorFloppyImage::SectorFloppyImage(GenericDiskDrive*        drive,
                                      std::vector<std::string> argv): GenericFloppyDisk(),
                                                                      imageName_m(nullptr),
                                                                      imageFd_m(-1),
+                                                                     image_m(nullptr),
+                                                                     imageLen_m(0),
                                                                      secBuf_m(nullptr),
                                                                      bufferedTrack_m(-1),
                                                                      bufferedSide_m(-1),
                                                                      bufferedSector_m(-1),
                                                                      bufferOffset_m(0),
+                                                                     dirty_m(false),
+                                                                     pageSize_m(sysconf(
+                                                                                    _SC_PAGESIZE)),
+                                                                     lastSync_m(0),
                                                                      hypoTrack_m(false),
                                                                      hyperTrack_m(false),
                                                                      interlaced_m(false),
@@ -163,6 +264,7 @@ SectorFloppyImage::SectorFloppyImage(GenericDiskDrive*        drive,
     }
 
     const char* name = strdup(argv[0].c_str());
+    std::string delta;
 
     for (int x = 1; x < argv.size(); ++x)
     {
@@ -170,15 +272,25 @@ SectorFloppyImage::SectorFloppyImage(GenericDiskDrive*        drive,
         {
             writeProtect_m = false;
         }
+        else if (OverlayImage::isOverlayArg(argv[x], delta))
+        {
+            // writes never reach the image, so it only has to be readable.
+            writeProtect_m = false;
+        }
+    }
+
+    if (!delta.empty())
+    {
+        overlay_m.reset(new OverlayImage(name, delta));
     }
 
-    if (!writeProtect_m && access(name, W_OK) != 0)
+    if (!writeProtect_m && !overlay_m && access(name, W_OK) != 0)
     {
         debugss(ssSectorFloppyImage, WARNING, "Image not writeable: %s\n", name);
         writeProtect_m = true;
     }
 
-    int fd = open(name, writeProtect_m ? O_RDONLY : O_RDWR);
+    int fd = open(name, (writeProtect_m || overlay_m) ? O_RDONLY : O_RDWR);
 
     if (fd < 0)
     {
@@ -187,26 +299,59 @@ SectorFloppyImage::SectorFloppyImage(GenericDiskDrive*        drive,
         return;
     }
 
-    BYTE  buf[128];
     off_t end = lseek(fd, (off_t) 0, SEEK_END);
 
-    if (end == 0)
+    if (end < headerLen_c)
     {
         // empty file... can't access...
         debugss(ssSectorFloppyImage, ERROR, "file is empty - %s\n", name);
+        close(fd);
+        free((void*) name);
+        return;
+    }
+
+    void* image = MAP_FAILED;
+
+    if (overlay_m)
+    {
+        if (overlay_m->isOpen())
+        {
+            image = overlay_m->data();
+        }
+    }
+    else
+    {
+        // read-only media is mapped read-only, so a stray write faults rather
+        // than silently changing the page cache.
+        image = mmap(nullptr, end, writeProtect_m ? PROT_READ : (PROT_READ | PROT_WRITE),
+                     MAP_SHARED, fd, 0);
+    }
+
+    if (image == MAP_FAILED)
+    {
+        debugss(ssSectorFloppyImage, ERROR, "unable to map file (%d) - %s\n", errno, name);
+        overlay_m.reset();
+        close(fd);
         free((void*) name);
         return;
     }
 
-    lseek(fd, end - sizeof(buf), SEEK_SET);
-    ssize_t x    = read(fd, buf, sizeof(buf));
-    bool    done = (x == sizeof(buf) && checkHeader(buf, sizeof(buf)));
+    bool done = checkHeader((BYTE*) image + end - headerLen_c, headerLen_c);
 
     if (!done)
     {
-        debugss(ssSectorFloppyImage, ERROR, "file is not SectorFloppyImage (%d,%d) - %s\n", x,
-                errno,
-                name);
+        debugss(ssSectorFloppyImage, ERROR, "file is not SectorFloppyImage - %s\n", name);
+
+        if (overlay_m)
+        {
+            overlay_m.reset();
+        }
+        else
+        {
+            munmap(image, end);
+        }
+
+        close(fd);
         free((void*) name);
         return;
     }
@@ -227,14 +372,18 @@ SectorFloppyImage::SectorFloppyImage(GenericDiskDrive*        drive,
         trackLen_m *= 2;
     }
 
-    secBuf_m    = new BYTE[secSize_m];
+    image_m     = (BYTE*) image;
+    imageLen_m  = end;
+    dirtyPages_m.assign((imageLen_m + pageSize_m - 1) / pageSize_m, false);
+    lastSync_m  = time(nullptr);
 
     imageFd_m   = fd;
     imageName_m = name;
     debugss(ssSectorFloppyImage, ERROR,
-            "mounted %d\" floppy %s: sides=%d tracks=%d spt=%d DD=%s R%s\n",
+            "mounted %d\" floppy %s: sides=%d tracks=%d spt=%d DD=%s R%s%s\n",
             mediaSize_m, imageName_m, numSides_m, numTracks_m, numSectors_m,
-            doubleDensity_m ? "yes" : "no", writeProtect_m ? "O" : "W");
+            doubleDensity_m ? "yes" : "no", writeProtect_m ? "O" : "W",
+            overlay_m ? " (cow)" : "");
 }
 
 SectorFloppyImage::~SectorFloppyImage()
@@ -245,8 +394,7 @@ SectorFloppyImage::~SectorFloppyImage()
     }
 
     debugss(ssSectorFloppyImage, INFO, "unmounted %s\n", imageName_m);
-    close(imageFd_m); // check errors?
-    imageFd_m = -1;
+    unmapImage();
 }
 
 shared_ptr<GenericFloppyDisk>
@@ -273,20 +421,14 @@ SectorFloppyImage::cacheSector(int side, int track, int sector)
         return true;
     }
 
-    if (imageFd_m < 0)
+    if (image_m == nullptr)
     {
         return false;
     }
 
-    if (bufferDirty_m && bufferedSide_m != -1 && bufferedTrack_m != -1 && bufferedSector_m != -1)
+    if (dirty_m && time(nullptr) - lastSync_m >= syncInterval_c)
     {
-        lseek(imageFd_m, bufferOffset_m, SEEK_SET);
-        ssize_t rd = write(imageFd_m, secBuf_m, secSize_m);
-        if (rd != secSize_m)
-        {
-            debugss(ssSectorFloppyImage, ERROR, "Unable to write to file %s\n", imageName_m);
-        }
-        bufferDirty_m = false;
+        writePages(false);
     }
 
     if (side < 0 || track < 0 || sector < 0)
@@ -319,10 +461,7 @@ SectorFloppyImage::cacheSector(int side, int track, int sector)
         bufferOffset_m = ((side * numTracks_m + track) * numSectors_m + sector - 1) * secSize_m;
     }
 
-    lseek(imageFd_m, bufferOffset_m, SEEK_SET);
-    ssize_t rd = read(imageFd_m, secBuf_m, secSize_m);
-
-    if (rd != secSize_m)
+    if (sector < 1 || (size_t) (bufferOffset_m + secSize_m) > imageLen_m - headerLen_c)
     {
         bufferedSide_m   = -1;
         bufferedTrack_m  = -1;
@@ -330,6 +469,7 @@ SectorFloppyImage::cacheSector(int side, int track, int sector)
         return false;
     }
 
+    secBuf_m         = image_m + bufferOffset_m;
     bufferedSide_m   = side;
     bufferedTrack_m  = track;
     bufferedSector_m = sector;
@@ -488,8 +628,9 @@ SectorFloppyImage::writeData(BYTE track, BYTE side, BYTE sector, int inSector,
 
         else
         {
+            dirtyPages_m[(bufferOffset_m + dataPos_m) / pageSize_m] = true;
+            dirty_m               = true;
             secBuf_m[dataPos_m++] = data;
-            bufferDirty_m         = true;
             result                = data;
         }
     }
@@ -505,7 +646,7 @@ SectorFloppyImage::writeData(BYTE track, BYTE side, BYTE sector, int inSector,
 bool
 SectorFloppyImage::isReady()
 {
-    return (imageFd_m >= 0);
+    return (image_m != nullptr);
 }
 
 std::string
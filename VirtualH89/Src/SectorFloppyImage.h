@@ -14,9 +14,11 @@
 
 #include "h89Types.h"
 #include "GenericFloppyDisk.h"
+#include "OverlayImage.h"
 
 /// \cond
 #include <sys/types.h>
+#include <time.h>
 #include <string>
 #include <vector>
 #include <memory>
@@ -28,6 +30,14 @@ class GenericDiskDrive;
 ///
 /// \brief A virtual floppy disk
 ///
+/// The image is mapped into memory, sectors are read and written in place.
+/// Pages that have been written are tracked and msync'ed on eject, on an
+/// operator 'sync' and, without waiting for the disk, every syncInterval_c
+/// seconds while writes occur.
+///
+/// With a 'cow=<delta file>' option the image is an OverlayImage instead:
+/// the file itself is only read, and written pages go to the delta file.
+///
 class SectorFloppyImage: public GenericFloppyDisk
 {
   public:
@@ -44,18 +54,29 @@ class SectorFloppyImage: public GenericFloppyDisk
                     BYTE sector) override;
     bool isReady() override;
     void eject(const std::string name) override;
+    void sync() override;
     void dump(void) override;
     std::string getMediaName() override;
 
   private:
     const char*   imageName_m;
     int           imageFd_m;
+    /// mapping of the whole file, including the trailing header.
+    BYTE*         image_m;
+    /// set when mounted copy-on-write, owns image_m.
+    std::unique_ptr<OverlayImage> overlay_m;
+    size_t        imageLen_m;
+    /// current sector, points into image_m.
     BYTE*         secBuf_m;
     int           bufferedTrack_m;
     int           bufferedSide_m;
     int           bufferedSector_m;
     off_t         bufferOffset_m;
-    bool          bufferDirty_m;
+    /// one entry per page of image_m, set when the page is written.
+    std::vector<bool> dirtyPages_m;
+    bool          dirty_m;
+    size_t        pageSize_m;
+    time_t        lastSync_m;
     bool          hypoTrack_m;  // ST media in DT drive
     bool          hyperTrack_m; // DT media in ST drive
     bool          interlaced_m;
@@ -70,6 +91,11 @@ class SectorFloppyImage: public GenericFloppyDisk
 
     bool checkHeader(BYTE* buf, int n);
     bool cacheSector(int side, int track, int sector);
+    void unmapImage();
+    void writePages(bool durable);
+
+    static const int headerLen_c    = 128;
+    static const int syncInterval_c = 5;
 
   protected:
 
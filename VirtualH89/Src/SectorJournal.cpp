@@ -0,0 +1,349 @@
+/// \file SectorJournal.cpp
+///
+///  Append-only log of rewritten sectors, used to keep guest writes to disk
+///  image formats that can't be updated in place.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#include "SectorJournal.h"
+
+#include "Sector.h"
+#include "logger.h"
+
+/// \cond
+#include <errno.h>
+#include <fcntl.h>
+#include <map>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+/// \endcond
+
+const char SectorJournal::magic_c[8] = {'V', 'H', '8', '9', 'S', 'J', '1', '\n'};
+
+SectorJournal::SectorJournal(std::string path): path_m(path),
+                                                fd_m(-1),
+                                                unsynced_m(false)
+{
+
+}
+
+SectorJournal::~SectorJournal()
+{
+    closeJournal();
+}
+
+WORD
+SectorJournal::checksum(const BYTE* data,
+                        size_t      len)
+{
+    WORD sum = 0;
+
+    for (size_t x = 0; x < len; ++x)
+    {
+        sum = ((sum << 1) | (sum >> 15)) + data[x];
+    }
+
+    return sum;
+}
+
+void
+SectorJournal::addRecord(std::vector<BYTE>& buf,
+                         Sector*            sect)
+{
+    size_t start = buf.size();
+    WORD   len   = sect->getSectorLength();
+
+    buf.push_back('S');
+    buf.push_back(sect->getHeadNum());
+    buf.push_back(sect->getTrackNum());
+    buf.push_back(sect->getSectorNum());
+    buf.push_back((sect->getDeletedDataAddressMark() ? 0x01 : 0) |
+                  (sect->getReadError() ? 0x02 : 0));
+    buf.push_back(len & 0xff);
+    buf.push_back(len >> 8);
+
+    buf.insert(buf.end(), sect->getData(), sect->getData() + len);
+
+    WORD sum = checksum(&buf[start], buf.size() - start);
+    buf.push_back(sum & 0xff);
+    buf.push_back(sum >> 8);
+}
+
+bool
+SectorJournal::exists()
+{
+    return (access(path_m.c_str(), F_OK) == 0);
+}
+
+std::vector<std::shared_ptr<Sector> >
+SectorJournal::load()
+{
+    std::vector<std::shared_ptr<Sector> >           sectors;
+    std::map<unsigned, std::shared_ptr<Sector> >    latest;
+    std::vector<BYTE>                               buf;
+    int                                             fd = open(path_m.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return sectors;
+    }
+
+    struct stat st;
+    bool        readOk = false;
+
+    if (fstat(fd, &st) == 0)
+    {
+        buf.resize(st.st_size);
+
+        readOk = (buf.empty() || read(fd, &buf[0], buf.size()) == (ssize_t) buf.size());
+    }
+
+    close(fd);
+
+    if (!readOk)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to read journal %s (%d)\n", path_m.c_str(), errno);
+        return sectors;
+    }
+
+    if (buf.size() < sizeof(magic_c) || memcmp(&buf[0], magic_c, sizeof(magic_c)) != 0)
+    {
+        // e.g. a crash right after it was created. Empty it, so appending starts
+        // again with the magic instead of adding records no one can read.
+        debugss(ssFloppyDisk, ERROR, "Discarding invalid journal %s\n", path_m.c_str());
+
+        if (truncate(path_m.c_str(), 0) < 0)
+        {
+            debugss(ssFloppyDisk, ERROR, "Unable to truncate %s (%d)\n", path_m.c_str(), errno);
+        }
+
+        return sectors;
+    }
+
+    size_t pos = sizeof(magic_c);
+
+    while (pos + recordHeaderLen_c <= buf.size())
+    {
+        const BYTE* rec = &buf[pos];
+        WORD        len = rec[5] | (rec[6] << 8);
+
+        if (rec[0] != 'S' || pos + recordHeaderLen_c + len + 2 > buf.size())
+        {
+            break;
+        }
+
+        WORD sum = rec[recordHeaderLen_c + len] | (rec[recordHeaderLen_c + len + 1] << 8);
+
+        if (sum != checksum(rec, recordHeaderLen_c + len))
+        {
+            break;
+        }
+
+        std::shared_ptr<Sector> sect = std::make_shared<Sector>(rec[1], rec[2], rec[3], len,
+                                                                (BYTE*) rec + recordHeaderLen_c);
+        sect->setDeletedDataAddressMark((rec[4] & 0x01) != 0);
+        sect->setReadError((rec[4] & 0x02) != 0);
+
+        latest[(rec[1] << 16) | (rec[2] << 8) | rec[3]] = sect;
+
+        pos += recordHeaderLen_c + len + 2;
+    }
+
+    if (pos != buf.size())
+    {
+        // the tail of the last write before a crash, drop it so new records follow
+        // valid ones.
+        debugss(ssFloppyDisk, WARNING, "Discarding %d bytes at end of journal %s\n",
+                (int) (buf.size() - pos), path_m.c_str());
+
+        if (truncate(path_m.c_str(), pos) < 0)
+        {
+            debugss(ssFloppyDisk, ERROR, "Unable to truncate %s (%d)\n", path_m.c_str(), errno);
+        }
+    }
+
+    for (std::map<unsigned, std::shared_ptr<Sector> >::iterator it = latest.begin();
+         it != latest.end(); ++it)
+    {
+        sectors.push_back(it->second);
+    }
+
+    return sectors;
+}
+
+bool
+SectorJournal::openJournal()
+{
+    if (fd_m >= 0)
+    {
+        return true;
+    }
+
+    fd_m = open(path_m.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+    if (fd_m < 0)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to open journal %s (%d)\n", path_m.c_str(), errno);
+        return false;
+    }
+
+    if (lseek(fd_m, 0, SEEK_END) == 0 &&
+        write(fd_m, magic_c, sizeof(magic_c)) != sizeof(magic_c))
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to write journal %s (%d)\n", path_m.c_str(), errno);
+        closeJournal();
+        return false;
+    }
+
+    return true;
+}
+
+void
+SectorJournal::closeJournal()
+{
+    if (fd_m >= 0)
+    {
+        sync();
+        close(fd_m);
+        fd_m = -1;
+    }
+}
+
+///
+/// The record goes out in a single write(), which survives the emulator
+/// crashing; sync() is needed to survive the host crashing.
+///
+bool
+SectorJournal::append(Sector* sect)
+{
+    std::vector<BYTE> rec;
+
+    if (!openJournal())
+    {
+        return false;
+    }
+
+    addRecord(rec, sect);
+
+    if (write(fd_m, &rec[0], rec.size()) != (ssize_t) rec.size())
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to write journal %s (%d)\n", path_m.c_str(), errno);
+        return false;
+    }
+
+    unsynced_m = true;
+
+    return true;
+}
+
+void
+SectorJournal::sync()
+{
+    if (fd_m >= 0 && unsynced_m)
+    {
+        fsync(fd_m);
+        unsynced_m = false;
+    }
+}
+
+bool
+SectorJournal::rewrite(const std::vector<Sector*>& sectors)
+{
+    std::vector<BYTE> buf(magic_c, magic_c + sizeof(magic_c));
+
+    for (size_t x = 0; x < sectors.size(); ++x)
+    {
+        addRecord(buf, sectors[x]);
+    }
+
+    // the old fd would keep appending to the replaced file.
+    closeJournal();
+
+    return replaceFile(path_m, &buf[0], buf.size());
+}
+
+void
+SectorJournal::discard()
+{
+    closeJournal();
+
+    if (unlink(path_m.c_str()) < 0 && errno != ENOENT)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to remove journal %s (%d)\n", path_m.c_str(), errno);
+    }
+}
+
+bool
+SectorJournal::replaceFile(const std::string& path,
+                           const BYTE*        data,
+                           size_t             len)
+{
+    // unique, other processes may be replacing the same file, e.g. in a shared
+    // cache directory.
+    std::string       tmp = path + ".XXXXXX";
+    std::vector<char> name(tmp.begin(), tmp.end());
+
+    name.push_back('\0');
+
+    int fd = mkstemp(&name[0]);
+
+    tmp = &name[0];
+
+    if (fd < 0)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to create %s (%d)\n", tmp.c_str(), errno);
+        return false;
+    }
+
+    // mkstemp() creates it private.
+    struct stat st;
+
+    fchmod(fd, (stat(path.c_str(), &st) == 0) ? (st.st_mode & 07777) : 0644);
+
+    size_t pos = 0;
+
+    while (pos < len)
+    {
+        ssize_t num = write(fd, data + pos, len - pos);
+
+        if (num < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (num <= 0)
+        {
+            break;
+        }
+
+        pos += num;
+    }
+
+    bool ok = (pos == len && fsync(fd) == 0);
+
+    close(fd);
+
+    if (!ok || rename(tmp.c_str(), path.c_str()) < 0)
+    {
+        debugss(ssFloppyDisk, ERROR, "Unable to replace %s (%d)\n", path.c_str(), errno);
+        unlink(tmp.c_str());
+        return false;
+    }
+
+    // make the rename itself durable.
+    size_t      slash = path.rfind('/');
+    std::string dir   = (slash == std::string::npos) ? "." : path.substr(0, slash + 1);
+    int         dfd   = open(dir.c_str(), O_RDONLY);
+
+    if (dfd >= 0)
+    {
+        fsync(dfd);
+        close(dfd);
+    }
+
+    return true;
+}
@@ -0,0 +1,74 @@
+/// \file SectorJournal.h
+///
+///  Append-only log of rewritten sectors, used to keep guest writes to disk
+///  image formats that can't be updated in place.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#ifndef SECTORJOURNAL_H_
+#define SECTORJOURNAL_H_
+
+#include "h89Types.h"
+
+/// \cond
+#include <memory>
+#include <string>
+#include <vector>
+/// \endcond
+
+class Sector;
+
+///
+/// \class SectorJournal
+///
+/// \brief Crash-safe record of sector writes.
+///
+/// Each record holds a complete sector, identified by head, cylinder and
+/// sector number, and ends with a checksum, so a record torn by a crash is
+/// dropped when the journal is loaded. Later records for the same sector
+/// replace earlier ones. The journal file is only created on the first write.
+///
+class SectorJournal
+{
+  public:
+    SectorJournal(std::string path);
+    ~SectorJournal();
+
+    /// returns the latest copy of each sector in the journal.
+    std::vector<std::shared_ptr<Sector> > load();
+    bool append(Sector* sect);
+    /// forces appended records to the host disk.
+    void sync();
+    /// atomically replaces the journal with just the given sectors.
+    bool rewrite(const std::vector<Sector*>& sectors);
+    /// removes the journal, once its contents are stored elsewhere.
+    void discard();
+    bool exists();
+
+    /// writes a uniquely named temporary file next to path, syncs it and renames it
+    /// over path, so path always holds either the old or the new contents.
+    static bool replaceFile(const std::string& path,
+                            const BYTE*        data,
+                            size_t             len);
+
+  private:
+    bool openJournal();
+    void closeJournal();
+
+    static void addRecord(std::vector<BYTE>& buf,
+                          Sector*            sect);
+    static WORD checksum(const BYTE* data,
+                         size_t      len);
+
+    std::string       path_m;
+    int               fd_m;
+    bool              unsynced_m;
+
+    static const char magic_c[8];
+    /// type, head, cylinder, sector, flags, length (2).
+    static const int  recordHeaderLen_c = 7;
+};
+
+#endif // SECTORJOURNAL_H_
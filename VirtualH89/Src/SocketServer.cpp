@@ -0,0 +1,608 @@
+/// \file SocketServer.cpp
+///
+///  CP/Net server reached over a TCP or Unix domain socket.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#include "SocketServer.h"
+
+#include "logger.h"
+
+/// \cond
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+/// \endcond
+
+
+std::vector<SocketServer*> SocketServer::servers_m;
+pthread_mutex_t            SocketServer::serversMutex_m = PTHREAD_MUTEX_INITIALIZER;
+
+SocketServer::SocketServer(PropertyUtil::PropertyMapT& props,
+                           std::vector<std::string> args, uint8_t srvId, uint8_t cltId):
+    NetworkServer(),
+    serverId_m(srvId),
+    clientId_m(cltId),
+    nextAddr_m(0),
+    connectWanted_m(false),
+    fd_m(-1),
+    connecting_m(false),
+    connectFd_m(-1),
+    writeBlocked_m(false),
+    numResponses_m(0),
+    cancelled_m(0),
+    startTime_m(now()),
+    numRequests_m(0),
+    replies_m(0),
+    bytesOut_m(0),
+    bytesIn_m(0),
+    totalLatency_m(0),
+    maxLatency_m(0)
+{
+    pthread_mutex_init(&mutex_m, nullptr);
+
+    pthread_mutex_lock(&serversMutex_m);
+    servers_m.push_back(this);
+    pthread_mutex_unlock(&serversMutex_m);
+
+    if (args.size() > 1)
+    {
+        addr_m = args[1];
+    }
+    else
+    {
+        debugss(ssCPNetDevice, ERROR, "Socket server %02x: no address given\n", srvId);
+        return;
+    }
+
+    // connect now, so the server is usually ready by the first request.
+    connectWanted_m = true;
+    HostIOThread::instance()->addListener(this);
+    HostIOThread::instance()->wakeup(this);
+}
+
+SocketServer::~SocketServer()
+{
+    pthread_mutex_lock(&serversMutex_m);
+    servers_m.erase(std::remove(servers_m.begin(), servers_m.end(), this), servers_m.end());
+    pthread_mutex_unlock(&serversMutex_m);
+
+    debugss(ssCPNetDevice, ERROR, "Socket server %02x: %s\n", serverId_m, getStats().c_str());
+
+    HostIOThread::instance()->removeListener(this);
+    closeServer();
+
+    if (connectFd_m >= 0)
+    {
+        close(connectFd_m);
+    }
+
+    pthread_mutex_destroy(&mutex_m);
+}
+
+unsigned long long
+SocketServer::now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+std::string
+SocketServer::getStats()
+{
+    pthread_mutex_lock(&mutex_m);
+
+    double secs = (now() - startTime_m) / 1e9;
+    std::string s = PropertyUtil::sprintf(
+        "requests=%llu replies=%llu avg_us=%.1f max_us=%.1f req_per_sec=%.1f "
+        "bytes_out=%llu bytes_in=%llu",
+        numRequests_m, replies_m,
+        replies_m ? totalLatency_m / 1e3 / replies_m : 0.0, maxLatency_m / 1e3,
+        secs > 0 ? replies_m / secs : 0.0,
+        bytesOut_m, bytesIn_m);
+
+    pthread_mutex_unlock(&mutex_m);
+
+    return s;
+}
+
+std::string
+SocketServer::getAllStats()
+{
+    std::string s;
+
+    pthread_mutex_lock(&serversMutex_m);
+
+    for (SocketServer* server : servers_m)
+    {
+        s += PropertyUtil::sprintf("socket %02x ", server->serverId_m) + server->getStats() + "\n";
+    }
+
+    pthread_mutex_unlock(&serversMutex_m);
+
+    return s;
+}
+
+///
+/// Called on the HostIOThread. Resolves the address and starts a non-blocking
+/// connect, finished by finishConnect() once the socket is writable.
+///
+void
+SocketServer::connectServer()
+{
+    pthread_mutex_lock(&mutex_m);
+
+    bool busy = (fd_m >= 0 || connecting_m);
+
+    connecting_m = true;
+
+    pthread_mutex_unlock(&mutex_m);
+
+    if (busy)
+    {
+        return;
+    }
+
+    size_t colon;
+
+    addrs_m.clear();
+    nextAddr_m = 0;
+
+    if (addr_m.find('/') == std::string::npos &&
+        (colon = addr_m.rfind(':')) != std::string::npos)
+    {
+        struct addrinfo  hints;
+        struct addrinfo* res;
+        std::string      host = addr_m.substr(0, colon);
+        std::string      port = addr_m.substr(colon + 1);
+
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        if (getaddrinfo(host.empty() ? "localhost" : host.c_str(), port.c_str(), &hints, &res) == 0)
+        {
+            for (struct addrinfo* ai = res; ai != nullptr; ai = ai->ai_next)
+            {
+                addrs_m.push_back({ai->ai_family,
+                                   std::string((const char*) ai->ai_addr, ai->ai_addrlen)});
+            }
+
+            freeaddrinfo(res);
+        }
+        else
+        {
+            debugss(ssCPNetDevice, ERROR, "Socket server: unknown address %s\n", addr_m.c_str());
+        }
+    }
+    else
+    {
+        struct sockaddr_un sa;
+
+        if (addr_m.length() < sizeof(sa.sun_path))
+        {
+            memset(&sa, 0, sizeof(sa));
+            sa.sun_family = AF_UNIX;
+            strncpy(sa.sun_path, addr_m.c_str(), sizeof(sa.sun_path) - 1);
+
+            addrs_m.push_back({AF_UNIX, std::string((const char*) &sa, sizeof(sa))});
+        }
+        else
+        {
+            debugss(ssCPNetDevice, ERROR, "socket path too long: %s\n", addr_m.c_str());
+        }
+    }
+
+    tryConnect();
+}
+
+/// Called on the HostIOThread, starts connecting to the next address.
+void
+SocketServer::tryConnect()
+{
+    while (nextAddr_m < addrs_m.size())
+    {
+        const Address& addr = addrs_m[nextAddr_m++];
+        int            fd   = socket(addr.family, SOCK_STREAM, 0);
+
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        if (connect(fd, (const struct sockaddr*) addr.sa.data(), addr.sa.length()) == 0)
+        {
+            HostIOThread::instance()->addSource(fd, HostIOThread::ioRead, this);
+            connected(fd);
+            return;
+        }
+
+        if (errno == EINPROGRESS)
+        {
+            connectFd_m = fd;
+            HostIOThread::instance()->addSource(fd, HostIOThread::ioWrite, this);
+            return;
+        }
+
+        close(fd);
+    }
+
+    debugss(ssCPNetDevice, ERROR, "Socket server %02x: unable to connect to %s (%d)\n",
+            serverId_m, addr_m.c_str(), errno);
+
+    pthread_mutex_lock(&mutex_m);
+
+    connecting_m = false;
+    failRequests();
+
+    pthread_mutex_unlock(&mutex_m);
+}
+
+/// Called on the HostIOThread when a connect in progress completes.
+void
+SocketServer::finishConnect(int fd)
+{
+    int       err = 0;
+    socklen_t len = sizeof(err);
+
+    connectFd_m = -1;
+
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0)
+    {
+        HostIOThread::instance()->modifySource(fd, HostIOThread::ioRead);
+        connected(fd);
+        return;
+    }
+
+    HostIOThread::instance()->removeSource(fd);
+    close(fd);
+
+    errno = err;
+    tryConnect();
+}
+
+/// Called on the HostIOThread, sends any requests queued while connecting.
+void
+SocketServer::connected(int fd)
+{
+    if (addrs_m[nextAddr_m - 1].family != AF_UNIX)
+    {
+        int one = 1;
+        // requests are small and latency bound.
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    debugss(ssCPNetDevice, INFO, "Socket server %02x: connected to %s\n", serverId_m,
+            addr_m.c_str());
+
+    pthread_mutex_lock(&mutex_m);
+
+    fd_m           = fd;
+    connecting_m   = false;
+    writeBlocked_m = false;
+    in_m.clear();
+
+    pthread_mutex_unlock(&mutex_m);
+
+    flushServer();
+}
+
+void
+SocketServer::closeServer()
+{
+    pthread_mutex_lock(&mutex_m);
+
+    int fd = fd_m;
+
+    fd_m = -1;
+    failRequests();
+    in_m.clear();
+
+    pthread_mutex_unlock(&mutex_m);
+
+    // HostIOThread calls back with its lock held, so don't take it while holding ours.
+    if (fd >= 0)
+    {
+        HostIOThread::instance()->removeSource(fd);
+        close(fd);
+    }
+}
+
+///
+/// Answers every outstanding request with a CP/Net error, so the guest doesn't
+/// wait forever. Must be called with mutex_m held.
+///
+void
+SocketServer::failRequests()
+{
+    // no one is waiting for the cancelled ones.
+    requests_m.erase(requests_m.begin(), requests_m.begin() + cancelled_m);
+    cancelled_m = 0;
+
+    if (!requests_m.empty())
+    {
+        debugss(ssCPNetDevice, ERROR, "Socket server %02x: failed %d requests\n", serverId_m,
+                (int) requests_m.size());
+    }
+
+    for (const Request& req : requests_m)
+    {
+        // same as CPNetDevice's own error response, a single 0xff byte.
+        uint8_t resp[ndosLen + 1] = {(uint8_t) (req.header.mcode | 0x01), req.header.msid,
+                                     req.header.mdid, req.header.mfunc, 0, 0xff};
+
+        responses_m.push_back(std::string((const char*) resp, sizeof(resp)));
+        ++numResponses_m;
+    }
+
+    requests_m.clear();
+    out_m.clear();
+}
+
+///
+/// Called on the CPU thread. Queues the request and returns 0, the response
+/// comes from checkRecvMsg().
+///
+int
+SocketServer::sendMsg(uint8_t* msgbuf, int len)
+{
+    if (addr_m.empty() || len < ndosLen)
+    {
+        return -1;
+    }
+
+    bool    connect = false;
+    Request req;
+
+    memcpy(&req.header, msgbuf, ndosLen);
+    req.sendTime = now();
+
+    pthread_mutex_lock(&mutex_m);
+
+    bool ok = (requests_m.size() < maxPending_c);
+
+    if (ok)
+    {
+        out_m.append((const char*) msgbuf, len);
+        requests_m.push_back(req);
+        ++numRequests_m;
+        bytesOut_m += len;
+
+        // server may have been restarted.
+        connect     = (fd_m < 0 && !connecting_m);
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    if (!ok)
+    {
+        return -1;
+    }
+
+    if (connect)
+    {
+        connectWanted_m = true;
+    }
+
+    HostIOThread::instance()->wakeup(this);
+
+    return 0;
+}
+
+///
+/// Called on the CPU thread. Requests already queued still go to the server,
+/// as it may have read part of them, but their responses are dropped.
+///
+void
+SocketServer::cancelMsgs()
+{
+    pthread_mutex_lock(&mutex_m);
+
+    cancelled_m    = requests_m.size();
+    responses_m.clear();
+    numResponses_m = 0;
+
+    pthread_mutex_unlock(&mutex_m);
+}
+
+///
+/// Polled on the CPU thread, must not block.
+///
+int
+SocketServer::checkRecvMsg(uint8_t clientId, uint8_t* msgbuf, int len)
+{
+    if (numResponses_m == 0)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&mutex_m);
+
+    std::string resp = responses_m.front();
+    responses_m.pop_front();
+    --numResponses_m;
+
+    pthread_mutex_unlock(&mutex_m);
+
+    if ((int) resp.length() > len)
+    {
+        resp.resize(len);
+    }
+
+    memcpy(msgbuf, resp.data(), resp.length());
+
+    return resp.length();
+}
+
+void
+SocketServer::ioReady(int  fd,
+                      bool readable,
+                      bool writable,
+                      bool hangup)
+{
+    if (fd == connectFd_m)
+    {
+        finishConnect(fd);
+        return;
+    }
+
+    if (writable)
+    {
+        flushServer();
+    }
+
+    if (readable || hangup)
+    {
+        readServer();
+    }
+}
+
+void
+SocketServer::ioWakeup()
+{
+    if (connectWanted_m.exchange(false))
+    {
+        connectServer();
+    }
+
+    flushServer();
+}
+
+void
+SocketServer::readServer()
+{
+    char buf[1024];
+    bool failed = false;
+
+    pthread_mutex_lock(&mutex_m);
+
+    while (fd_m >= 0)
+    {
+        ssize_t num = read(fd_m, buf, sizeof(buf));
+
+        if (num < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (num < 0 && errno == EAGAIN)
+        {
+            break;
+        }
+
+        if (num <= 0)
+        {
+            failed = true;
+            break;
+        }
+
+        bytesIn_m += num;
+        in_m.append(buf, num);
+
+        // split into frames, msize is the last header byte.
+        while (in_m.length() >= ndosLen)
+        {
+            size_t frameLen = ndosLen + (uint8_t) in_m[ndosLen - 1] + 1;
+
+            if (in_m.length() < frameLen)
+            {
+                break;
+            }
+
+            if (cancelled_m > 0)
+            {
+                --cancelled_m;
+            }
+            else
+            {
+                responses_m.push_back(in_m.substr(0, frameLen));
+                ++numResponses_m;
+            }
+
+            in_m.erase(0, frameLen);
+
+            if (!requests_m.empty())
+            {
+                unsigned long long latency = now() - requests_m.front().sendTime;
+                requests_m.pop_front();
+                totalLatency_m += latency;
+                maxLatency_m    = std::max(maxLatency_m, latency);
+            }
+
+            ++replies_m;
+        }
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    if (failed)
+    {
+        debugss(ssCPNetDevice, ERROR, "Socket server %02x: connection closed\n", serverId_m);
+        closeServer();
+    }
+}
+
+void
+SocketServer::flushServer()
+{
+    bool failed  = false;
+    bool blocked = false;
+
+    pthread_mutex_lock(&mutex_m);
+
+    while (fd_m >= 0 && !out_m.empty())
+    {
+        ssize_t num = write(fd_m, out_m.data(), out_m.length());
+
+        if (num > 0)
+        {
+            out_m.erase(0, num);
+        }
+        else if (num < 0 && errno == EAGAIN)
+        {
+            blocked = true;
+            break;
+        }
+        else if (num < 0 && errno != EINTR)
+        {
+            failed = true;
+            break;
+        }
+    }
+
+    int  fd     = fd_m;
+    bool modify = (fd >= 0 && !failed && blocked != writeBlocked_m);
+
+    if (modify)
+    {
+        writeBlocked_m = blocked;
+    }
+
+    pthread_mutex_unlock(&mutex_m);
+
+    if (modify)
+    {
+        HostIOThread::instance()->modifySource(fd, HostIOThread::ioRead |
+                                               (blocked ? HostIOThread::ioWrite : 0));
+    }
+
+    if (failed)
+    {
+        closeServer();
+    }
+}
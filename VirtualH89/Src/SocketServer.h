@@ -0,0 +1,136 @@
+/// \file SocketServer.h
+///
+///  CP/Net server reached over a TCP or Unix domain socket.
+///
+///  \date Oct 18, 2026
+///  \author Mark Garlanger
+///
+
+#ifndef SOCKETSERVER_H_
+#define SOCKETSERVER_H_
+
+#include "NetworkServer.h"
+#include "HostIOThread.h"
+#include "propertyutil.h"
+
+/// \cond
+#include <atomic>
+#include <deque>
+#include <pthread.h>
+#include <string>
+#include <vector>
+/// \endcond
+
+///
+/// \class SocketServer
+///
+/// \brief Forwards CP/Net messages to an external server process.
+///
+/// Messages are sent as-is, the 5 byte ndos header followed by msize+1 bytes,
+/// and responses are expected in the same form, in request order. Requests may
+/// be pipelined; sendMsg() never blocks and returns 0 (response pending) unless
+/// too many requests are outstanding. Connecting, reconnecting after the server
+/// went away, and all socket I/O are done on the HostIOThread. Requests that
+/// can't be delivered, or are outstanding when the connection is lost, get a
+/// CP/Net error response.
+///
+/// Property syntax:
+///
+///     cpnetdevice_serverNN = Socket <host>:<port>
+///     cpnetdevice_serverNN = Socket <unix-socket-path>
+///
+class SocketServer: public NetworkServer, public HostIOListener
+{
+  public:
+    SocketServer(PropertyUtil::PropertyMapT& props,
+                 std::vector<std::string> args, uint8_t srvId, uint8_t cltId);
+    virtual ~SocketServer() override;
+
+    virtual int checkRecvMsg(uint8_t clientId, uint8_t* msgbuf, int len) override;
+    virtual int sendMsg(uint8_t* msgbuf, int len) override;
+    virtual void cancelMsgs() override;
+
+    virtual void ioReady(int  fd,
+                         bool readable,
+                         bool writable,
+                         bool hangup) override;
+    virtual void ioWakeup() override;
+
+    /// request count, latency and throughput since creation.
+    std::string getStats();
+
+    /// stats of all socket servers, one "socket <sid> <stats>" line each.
+    static std::string getAllStats();
+
+  private:
+    void connectServer();
+    void tryConnect();
+    void finishConnect(int fd);
+    void connected(int fd);
+    void closeServer();
+    void failRequests();
+    void readServer();
+    void flushServer();
+
+    static unsigned long long now();
+
+    /// a request waiting for its response.
+    struct Request
+    {
+        struct NetworkServer::ndos header;
+        unsigned long long         sendTime;
+    };
+
+    /// a resolved server address, sa holds the raw sockaddr.
+    struct Address
+    {
+        int         family;
+        std::string sa;
+    };
+
+    std::string                    addr_m;
+    uint8_t                        serverId_m;
+    uint8_t                        clientId_m;
+
+    /// addresses to try, and the next one, only used on the HostIOThread.
+    std::vector<Address>           addrs_m;
+    size_t                         nextAddr_m;
+    /// set by the CPU thread to have the HostIOThread (re)connect.
+    std::atomic_bool               connectWanted_m;
+
+    /// -1 when not connected, only changed while holding mutex_m.
+    int                            fd_m;
+    bool                           connecting_m;
+    pthread_mutex_t                mutex_m;
+    /// socket with a connect in progress, only used on the HostIOThread.
+    int                            connectFd_m;
+
+    /// frames not yet written to the socket.
+    std::string                    out_m;
+    bool                           writeBlocked_m;
+    /// partial frame read from the socket.
+    std::string                    in_m;
+    /// complete responses, not yet collected.
+    std::deque<std::string>        responses_m;
+    std::atomic_uint               numResponses_m;
+    /// requests still waiting for a response, in order.
+    std::deque<Request>            requests_m;
+    /// the first requests_m, cancelled, their responses are dropped.
+    size_t                         cancelled_m;
+
+    unsigned long long             startTime_m;
+    unsigned long long             numRequests_m;
+    unsigned long long             replies_m;
+    unsigned long long             bytesOut_m;
+    unsigned long long             bytesIn_m;
+    unsigned long long             totalLatency_m;
+    unsigned long long             maxLatency_m;
+
+    static std::vector<SocketServer*> servers_m;
+    static pthread_mutex_t         serversMutex_m;
+
+    static const int               ndosLen       = sizeof(struct NetworkServer::ndos);
+    static const size_t            maxPending_c  = 16;
+};
+
+#endif // SOCKETSERVER_H_
@@ -114,13 +114,25 @@ SoftSectoredDisk::findSector(BYTE sideNum,
 void
 SoftSectoredDisk::addTrack(std::shared_ptr<Track> track)
 {
-    // BYTE sideNumber = track->getSideNumber();
-    // BYTE trackNumber = track->getTrackNumber();
-/*    if ()
-    {
+    BYTE sideNumber = track->getSideNumber();
 
+    if (sideNumber < sideData_m.size())
+    {
+        sideData_m[sideNumber]->addTrack(track);
     }
- */
+    else
+    {
+        debugss(ssFloppyDisk, ERROR, "track for side %d on %d sided disk\n", sideNumber,
+                numSides_m);
+    }
+
+    tracks_m.push_back(track);
+}
+
+void
+SoftSectoredDisk::sectorWritten()
+{
+
 }
 
 
@@ -289,6 +301,11 @@ SoftSectoredDisk::writeData(BYTE track,
                 curSector_m->writeData(sectorPos_m++, data);
 
                 result = data;
+
+                if (sectorPos_m == sectorLength_m)
+                {
+                    sectorWritten();
+                }
             }
             else
             {
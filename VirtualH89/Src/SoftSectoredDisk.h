@@ -11,6 +11,7 @@
 
 // #include "FloppyDisk.h"
 #include "GenericFloppyDisk.h"
+#include "SectorArena.h"
 
 /// \cond
 #include <vector>
@@ -79,15 +80,21 @@ class SoftSectoredDisk: public GenericFloppyDisk
     virtual void eject(const char* name);
  */
   protected:
+    /// data of every sector on the disk.
+    SectorArena                             arena_m;
     std::vector<std::shared_ptr<DiskSide> > sideData_m;
     BYTE                                    numSides_m;
-    std::shared_ptr<Sector>                 curSector_m;
+    Sector*                                 curSector_m;
     unsigned                                sectorPos_m;
     unsigned                                sectorLength_m;
     BYTE                                    secLenCode_m;
     bool                                    ready_m;
+    /// every track, in image order.
+    std::vector<std::shared_ptr<Track> >    tracks_m;
 
     virtual void addTrack(std::shared_ptr<Track> track);
+    /// called once all of curSector_m has been written.
+    virtual void sectorWritten();
 
 /*    static const unsigned int bytesPerTrack_c = 6400;
 
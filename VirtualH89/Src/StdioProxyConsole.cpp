@@ -6,6 +6,17 @@
 /// H19 traffic has the high bit set, while oob traffic has the high bit clear.
 /// Thus, only 7-bit ASSCII is supported for each channel.
 ///
+/// With the -f option, output to the front-end is instead a sequence of frames:
+///
+///     +0  channel (01 = console data, 02 = operator response, 03 = event)
+///     +1  payload length, MSB
+///     +2  payload length, LSB
+///     +3...   payload (8-bit clean)
+///
+/// Console data is collected for up to one 2 mSec timer tick of virtual time
+/// and written with a single writev(), along with any response or event that
+/// follows it. Input from the front-end is unchanged.
+///
 /// \date Feb 6, 2016
 /// \author Douglas Miller
 ///
@@ -16,9 +27,13 @@
 #include "h89-io.h"
 #include "logger.h"
 #include "H89Operator.h"
+#include "WallClock.h"
+#include "WorkloadScript.h"
 
 /// \cond
+#include <errno.h>
 #include <stdio.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <signal.h>
@@ -36,7 +51,11 @@ extern const char* getopts;
 StdioProxyConsole::StdioProxyConsole(int    argc,
                                      char** argv):
     Console(argc, argv),
-    logConsole(false)
+    ClockUser(true),
+    logConsole(false),
+    framed_m(false),
+    conLen_m(0),
+    conClock_m(0)
 {
     int          c;
     extern char* optarg;
@@ -53,10 +72,18 @@ StdioProxyConsole::StdioProxyConsole(int    argc,
             case 'l':
                 logConsole = true;
                 break;
+
+            case 'f':
+                framed_m = true;
+                break;
         }
     }
 
+    pthread_mutex_init(&outMutex_m, nullptr);
+
     op_m = new H89Operator();
+
+    H89Operator::addListener(this);
 }
 
 StdioProxyConsole::~StdioProxyConsole() {
@@ -97,8 +124,33 @@ StdioProxyConsole::keypress(char ch)
 void
 StdioProxyConsole::receiveData(BYTE ch)
 {
-    fputc(ch | 0x80, stdout);
-    fflush(stdout);
+    WorkloadScript::consoleOutput(ch);
+
+    if (framed_m)
+    {
+        // uncontended except when a response is being written.
+        pthread_mutex_lock(&outMutex_m);
+
+        if (conLen_m == sizeof(conBuf_m))
+        {
+            writeFrames(0, nullptr, 0);
+        }
+
+        if (conLen_m == 0)
+        {
+            conClock_m = WallClock::instance()->getClock();
+            WallClock::instance()->requestHostWork();
+        }
+
+        conBuf_m[conLen_m++] = ch;
+        pthread_mutex_unlock(&outMutex_m);
+    }
+    else
+    {
+        fputc(ch | 0x80, stdout);
+        fflush(stdout);
+    }
+
     if (logConsole)
     {
         fputc(ch, console_out);
@@ -115,6 +167,150 @@ StdioProxyConsole::checkUpdated()
     return false;
 }
 
+///
+/// Polled after every instruction while console output is buffered, flushes it
+/// once it is a timer tick old.
+///
+void
+StdioProxyConsole::notification(unsigned int cycleCount)
+{
+    if (conLen_m == 0)
+    {
+        return;
+    }
+
+    if (WallClock::instance()->getElapsedTime(conClock_m) >=
+        WallClock::instance()->getTicksPerSecond() / flushIntervalPerSecond_c)
+    {
+        pthread_mutex_lock(&outMutex_m);
+        writeFrames(0, nullptr, 0);
+        pthread_mutex_unlock(&outMutex_m);
+    }
+    else
+    {
+        WallClock::instance()->requestHostWork();
+    }
+}
+
+///
+/// Write any pending console data, followed by an optional frame on another
+/// channel (channel 0 for none), with one writev(). Must hold outMutex_m.
+///
+void
+StdioProxyConsole::writeFrames(BYTE        channel,
+                               const BYTE* data,
+                               size_t      len)
+{
+    BYTE         conHdr[frameHeaderLen_c];
+    BYTE         hdr[frameHeaderLen_c];
+    struct iovec iov[4];
+    int          cnt    = 0;
+    unsigned int conLen = conLen_m;
+
+    if (conLen > 0)
+    {
+        conHdr[0]          = ch_Console;
+        conHdr[1]          = (conLen >> 8) & 0xff;
+        conHdr[2]          = conLen & 0xff;
+        iov[cnt].iov_base  = conHdr;
+        iov[cnt++].iov_len = sizeof(conHdr);
+        iov[cnt].iov_base  = conBuf_m;
+        iov[cnt++].iov_len = conLen;
+    }
+
+    if (channel != 0)
+    {
+        if (len > 0xffff)
+        {
+            len = 0xffff;
+        }
+
+        hdr[0]             = channel;
+        hdr[1]             = (len >> 8) & 0xff;
+        hdr[2]             = len & 0xff;
+        iov[cnt].iov_base  = hdr;
+        iov[cnt++].iov_len = sizeof(hdr);
+        iov[cnt].iov_base  = (void*) data;
+        iov[cnt++].iov_len = len;
+    }
+
+    struct iovec* vec = iov;
+
+    while (cnt > 0)
+    {
+        ssize_t num = writev(STDOUT_FILENO, vec, cnt);
+
+        if (num < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            debugss(ssStdioConsole, ERROR, "writev failed: %d\n", errno);
+            break;
+        }
+
+        // the CPU thread takes SIGALRM, so partial writes are possible.
+        while (cnt > 0 && (size_t) num >= vec->iov_len)
+        {
+            num -= vec->iov_len;
+            ++vec;
+            --cnt;
+        }
+
+        if (cnt > 0)
+        {
+            vec->iov_base = (BYTE*) vec->iov_base + num;
+            vec->iov_len -= num;
+        }
+    }
+
+    conLen_m = 0;
+}
+
+void
+StdioProxyConsole::sendResponse(std::string resp)
+{
+    if (framed_m)
+    {
+        pthread_mutex_lock(&outMutex_m);
+        writeFrames(ch_Response, (const BYTE*) resp.data(), resp.length());
+        pthread_mutex_unlock(&outMutex_m);
+        return;
+    }
+
+    fputs(resp.c_str(), stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+}
+
+void
+StdioProxyConsole::sendEvent(std::string event)
+{
+    if (!framed_m)
+    {
+        // No separate channel, every line on stdout is the reply to a command. A
+        // headless workload run still needs its results.
+        if (event.compare(0, 9, "workload ") == 0)
+        {
+            fprintf(stderr, "%s\n", event.c_str());
+        }
+
+        return;
+    }
+
+    pthread_mutex_lock(&outMutex_m);
+    writeFrames(ch_Event, (const BYTE*) event.data(), event.length());
+    pthread_mutex_unlock(&outMutex_m);
+}
+
+void
+StdioProxyConsole::operatorEvent(std::string event)
+{
+    sendEvent(event);
+}
+
 unsigned int
 StdioProxyConsole::getBaudRate()
 {
@@ -146,10 +342,7 @@ StdioProxyConsole::run()
 
             buf[x] = '\0';
             x      = 0;
-            std::string resp = op_m->handleCommand(buf);
-            fputs(resp.c_str(), stdout);
-            fputc('\n', stdout);
-            fflush(stdout);
+            sendResponse(op_m->handleCommand(buf));
         }
         else
         {
@@ -159,4 +352,6 @@ StdioProxyConsole::run()
             }
         }
     }
+    // e.g. run headless with stdin from /dev/null, until the workload is done.
+    WorkloadScript::waitDone();
 }
@@ -4,6 +4,7 @@
 /// Also supports a out-of-band channel for command/control messages.
 /// Typically, this is selected by commandline options for main(),
 /// with the parent process as the H19 emulation.
+/// With the -f option, output uses length-prefixed frames (see StdioProxyConsole.cpp).
 ///
 /// \date Feb 6, 2016
 /// \author Douglas Miller
@@ -14,17 +15,20 @@
 
 
 #include "Console.h"
+#include "ClockUser.h"
+#include "H89Operator.h"
 
 /// \cond
 #include <assert.h>
+#include <atomic>
+#include <pthread.h>
+#include <string>
 /// \endcond
 
-class H89Operator;
-
 /// \brief StdioProxyConsole
 ///
 ///
-class StdioProxyConsole: public Console
+class StdioProxyConsole: public Console, public ClockUser, public OperatorEventListener
 {
   public:
     StdioProxyConsole(int    argc,
@@ -41,9 +45,42 @@ class StdioProxyConsole: public Console
     virtual unsigned int getBaudRate() override;
     virtual void run() override;
 
+    virtual void notification(unsigned int cycleCount) override;
+
+    /// Send an asynchronous event to the front-end, from any thread. Only with
+    /// framed output (-f), otherwise it's dropped, except that workload events
+    /// are written to stderr.
+    void sendEvent(std::string event);
+
+    virtual void operatorEvent(std::string event) override;
+
+    /// Frame channels
+    static const BYTE   ch_Console  = 0x01;
+    static const BYTE   ch_Response = 0x02;
+    static const BYTE   ch_Event    = 0x03;
+
   private:
-    H89Operator* op_m;
-    bool         logConsole;
+    void sendResponse(std::string resp);
+    void writeFrames(BYTE        channel,
+                     const BYTE* data,
+                     size_t      len);
+
+    H89Operator*        op_m;
+    bool                logConsole;
+    bool                framed_m;
+
+    /// protects the console buffer and the output stream.
+    pthread_mutex_t     outMutex_m;
+
+    /// console output not yet written, appended to by the CPU thread.
+    BYTE                conBuf_m[4096];
+    std::atomic_uint    conLen_m;
+    unsigned long long  conClock_m;
+
+    static const size_t frameHeaderLen_c         = 3;
+
+    /// flush console output once per 2 mSec timer tick.
+    static const int    flushIntervalPerSecond_c = 500;
 };
 
 #endif // STDIOPROXYCONSOLE_H_
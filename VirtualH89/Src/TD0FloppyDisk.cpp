@@ -10,6 +10,7 @@
 #include "TD0FloppyDisk.h"
 
 #include "DiskSide.h"
+#include "DiskImageCache.h"
 #include "Track.h"
 #include "Sector.h"
 
@@ -18,6 +19,7 @@
 
 /// \cond
 #include <fstream>
+#include <utility>
 /// \endcond
 
 using namespace std;
@@ -347,7 +349,10 @@ TD0FloppyDisk::getDiskette(vector<string> argv)
 }
 
 
-TD0FloppyDisk::TD0FloppyDisk(vector<string> argv): SoftSectoredDisk()
+TD0FloppyDisk::TD0FloppyDisk(vector<string> argv): SoftSectoredDisk(),
+                                                   overlay_m(argv.size() > 0 ?
+                                                             argv[0] + ".journal" : ""),
+                                                   overlayDirty_m(false)
 {
     if (argv.size() < 1)
     {
@@ -368,17 +373,128 @@ TD0FloppyDisk::TD0FloppyDisk(vector<string> argv): SoftSectoredDisk()
     }
 
 
-    if (!readTD0(name.c_str()))
+    DiskImageCache                    cache(name);
+    DiskImageCache::Geometry          geom;
+    vector<shared_ptr<Track> >        tracks;
+    vector<DiskImageCache::SourceRef> refs;
+
+    if (cache.load(geom, tracks, refs, arena_m))
+    {
+        numSides_m      = geom.numSides;
+        numTracks_m     = geom.numTracks;
+        doubleDensity_m = geom.doubleDensity;
+
+        for (BYTE side = 0; side < numSides_m; side++)
+        {
+            sideData_m.push_back(make_shared<DiskSide>(side));
+        }
+
+        for (size_t x = 0; x < tracks.size(); ++x)
+        {
+            addTrack(tracks[x]);
+        }
+    }
+    else if (readTD0(name.c_str()))
+    {
+        geom.numSides      = numSides_m;
+        geom.numTracks     = numTracks_m;
+        geom.doubleDensity = doubleDensity_m;
+        cache.store(geom, tracks_m, refs);
+    }
+    else
     {
         ready_m = false;
         debugss(ssFloppyDisk, ERROR, "Read of file %s failed\n", name.c_str());
+        return;
     }
 
+    applyOverlay();
 }
 
 TD0FloppyDisk::~TD0FloppyDisk()
 {
+    compactOverlay();
+}
 
+void
+TD0FloppyDisk::eject(const string name)
+{
+    compactOverlay();
+}
+
+void
+TD0FloppyDisk::sync()
+{
+    overlay_m.sync();
+}
+
+void
+TD0FloppyDisk::applyOverlay()
+{
+    vector<shared_ptr<Sector> > saved = overlay_m.load();
+
+    for (size_t x = 0; x < saved.size(); ++x)
+    {
+        shared_ptr<Sector> src = saved[x];
+        Sector*            dst = nullptr;
+
+        if (src->getHeadNum() < numSides_m)
+        {
+            dst = sideData_m[src->getHeadNum()]->findSector(src->getTrackNum(),
+                                                            src->getSectorNum());
+        }
+
+        if (!dst || dst->getHeadNum() != src->getHeadNum() ||
+            dst->getSectorLength() != src->getSectorLength())
+        {
+            debugss(ssFloppyDisk, ERROR, "%s: overlay sector %d/%d/%d not on disk\n",
+                    imageName_m.c_str(), src->getHeadNum(), src->getTrackNum(),
+                    src->getSectorNum());
+            continue;
+        }
+
+        for (WORD pos = 0; pos < src->getSectorLength(); ++pos)
+        {
+            dst->writeData(pos, src->getData()[pos]);
+        }
+
+        dst->setDeletedDataAddressMark(src->getDeletedDataAddressMark());
+        dst->setReadError(src->getReadError());
+        written_m.insert(dst);
+    }
+
+    if (!written_m.empty())
+    {
+        debugss(ssFloppyDisk, INFO, "%s: %d sectors from overlay\n", imageName_m.c_str(),
+                (int) written_m.size());
+    }
+}
+
+void
+TD0FloppyDisk::sectorWritten()
+{
+    written_m.insert(curSector_m);
+    overlayDirty_m = true;
+    overlay_m.append(curSector_m);
+}
+
+///
+/// Drops superseded records, leaving one per written sector.
+///
+void
+TD0FloppyDisk::compactOverlay()
+{
+    if (!overlayDirty_m)
+    {
+        return;
+    }
+
+    vector<Sector*> sectors(written_m.begin(), written_m.end());
+
+    if (overlay_m.rewrite(sectors))
+    {
+        overlayDirty_m = false;
+    }
 }
 
 bool
@@ -661,22 +777,21 @@ TD0FloppyDisk::readTD0(const char* name)
 
                     }
                     // create sector
-                    shared_ptr<Sector> sect = make_shared<Sector>(secHead, secCyl, secNum, secSize,
-                                                                  block);
+                    Sector sect(secHead, secCyl, secNum, secSize, block, arena_m);
 
                     // set flags
-                    sect->setReadError((secFlags & 0x02) == 0x02);
-                    sect->setDeletedDataAddressMark((secFlags & 0x04) == 0x04);
+                    sect.setReadError((secFlags & 0x02) == 0x02);
+                    sect.setDeletedDataAddressMark((secFlags & 0x04) == 0x04);
 
                     // add sector to track
-                    trk->addSector(sect);
+                    trk->addSector(std::move(sect));
 
                 }
 
             }
             // add track to disk
 
-            sideData_m[side]->addTrack(trk);
+            addTrack(trk);
         }
     }
     while (!done);
@@ -10,7 +10,9 @@
 
 #include "GenericFloppyDisk.h"
 #include "SoftSectoredDisk.h"
+#include "SectorJournal.h"
 /// \cond
+#include <set>
 #include <vector>
 #include <memory>
 /// \endcond
@@ -19,12 +21,24 @@ class DiskSide;
 class Track;
 class Sector;
 
+///
+/// \class TD0FloppyDisk
+///
+/// \brief Teledisk (.TD0) media.
+///
+/// The compressed image itself is never written. Sector writes go to a
+/// SectorJournal overlay (<image>.journal) that is applied whenever the
+/// image is mounted, and is rewritten without superseded records on eject.
+///
 class TD0FloppyDisk: public SoftSectoredDisk
 {
   public:
     TD0FloppyDisk(std::vector<std::string> argv);
     virtual ~TD0FloppyDisk() override;
 
+    virtual void eject(const std::string name) override;
+    virtual void sync() override;
+
     static std::shared_ptr<GenericFloppyDisk> getDiskette(std::vector<std::string> argv);
 
   private:
@@ -34,8 +48,17 @@ class TD0FloppyDisk: public SoftSectoredDisk
     // unsigned long writePos_m;
     // bool          trackWrite_m;
 
+    SectorJournal        overlay_m;
+    /// sectors written since mounted, or restored from overlay_m.
+    std::set<Sector*>    written_m;
+    bool                 overlayDirty_m;
+
+    void applyOverlay();
+    void compactOverlay();
+
   protected:
     bool readTD0(const char* name);
+    void sectorWritten() override;
 
     // LZSS parameters
     static const int     SB_SIZE   = 4096; // Size of Ring buffer
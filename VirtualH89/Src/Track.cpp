@@ -8,11 +8,16 @@
 
 #include "Track.h"
 
-#include "Sector.h"
 #include "logger.h"
 
+/// \cond
+#include <utility>
+/// \endcond
+
 using namespace std;
 
+const short Track::noSector_c;
+
 Track::Track(BYTE sideNum,
              BYTE trackNum): sideNum_m(sideNum),
                              trackNum_m(trackNum),
@@ -31,6 +36,7 @@ void
 Track::startFormat()
 {
     sectors_m.clear();
+    index_m.clear();
     formattingMode_m = fs_waitingForIndex;
 
 }
@@ -50,9 +56,22 @@ Track::getSideNumber()
 }
 
 bool
-Track::addSector(shared_ptr<Sector> sector)
+Track::addSector(Sector&& sector)
 {
-    sectors_m.push_back(sector);
+    BYTE sectorNum = sector.getSectorNum();
+
+    if (sectorNum >= index_m.size())
+    {
+        index_m.resize(sectorNum + 1, noSector_c);
+    }
+
+    // first one wins, as the linear search used to do.
+    if (index_m[sectorNum] == noSector_c)
+    {
+        index_m[sectorNum] = sectors_m.size();
+    }
+
+    sectors_m.push_back(std::move(sector));
 
     return false;
 }
@@ -64,10 +83,10 @@ Track::dump()
             trackNum_m);
 
 
-    for (shared_ptr<Sector> sector : sectors_m)
+    for (Sector& sector : sectors_m)
     {
-        debugss(ssFloppyDisk, INFO, "  Sector: %d\n", sector->getSectorNum());
-        sector->dump();
+        debugss(ssFloppyDisk, INFO, "  Sector: %d\n", sector.getSectorNum());
+        sector.dump();
     }
 }
 
@@ -83,19 +102,20 @@ Track::setDataRate(DataRate datarate)
     dataRate_m = datarate;
 }
 
-
-shared_ptr<Sector>
-Track::findSector(BYTE sectorNum)
+Track::Density
+Track::getDensity()
 {
-    for (shared_ptr<Sector> sector : sectors_m)
-    {
-        if (sector->getSectorNum() == sectorNum)
-        {
-            debugss(ssFloppyDisk, INFO, "found\n");
+    return density_m;
+}
 
-            return sector;
-        }
-    }
+Track::DataRate
+Track::getDataRate()
+{
+    return dataRate_m;
+}
 
-    return nullptr;
+vector<Sector>&
+Track::getSectors()
+{
+    return sectors_m;
 }
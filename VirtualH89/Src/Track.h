@@ -10,14 +10,13 @@
 #define TRACK_H_
 
 #include "h89Types.h"
+#include "Sector.h"
 
 /// \cond
 #include <vector>
 #include <memory>
 /// \endcond
 
-class Sector;
-
 class Track
 {
   public:
@@ -42,7 +41,12 @@ class Track
     BYTE                                   sideNum_m;
     BYTE                                   trackNum_m;
 
-    std::vector <std::shared_ptr<Sector> > sectors_m;
+    /// sectors in the order they are on the track.
+    std::vector<Sector>                    sectors_m;
+    /// position in sectors_m by sector number, or noSector_c.
+    std::vector<short>                     index_m;
+
+    static const short                     noSector_c = -1;
 
     Density                                density_m;
     DataRate                               dataRate_m;
@@ -67,14 +71,27 @@ class Track
     BYTE getTrackNumber();
     BYTE getSideNumber();
 
-    bool addSector(std::shared_ptr<Sector> sector);
+    /// pointers to a track's sectors stay valid once it is fully built.
+    bool addSector(Sector&& sector);
 
     void setDensity(Density density);
     void setDataRate(DataRate datarate);
+    Density getDensity();
+    DataRate getDataRate();
+
+    std::vector<Sector>& getSectors();
 
     void dump();
 
-    std::shared_ptr<Sector> findSector(BYTE sector);
+    inline Sector* findSector(BYTE sector)
+    {
+        if (sector < index_m.size() && index_m[sector] != noSector_c)
+        {
+            return &sectors_m[index_m[sector]];
+        }
+
+        return nullptr;
+    }
 
     void startFormat();
 
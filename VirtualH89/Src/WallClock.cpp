@@ -20,7 +20,8 @@ WallClock* WallClock::_inst = nullptr;
 
 
 WallClock::WallClock(): clock_m(0),
-                        ticks_m(0)
+                        ticks_m(0),
+                        hostWork_m(false)
 {
 
 }
@@ -70,6 +71,17 @@ WallClock::addTicks(unsigned ticks)
     {
         clockUser->notification(ticks);;
     }
+
+    if (hostWork_m)
+    {
+        // cleared first, so a request made while they run isn't lost.
+        hostWork_m = false;
+
+        for (ClockUser* hostUser : hostUsers_m)
+        {
+            hostUser->notification(ticks);
+        }
+    }
 }
 
 long long unsigned int
@@ -113,6 +125,20 @@ WallClock::unregisterUser(ClockUser* user)
     return true;
 }
 
+bool
+WallClock::registerHostUser(ClockUser* user)
+{
+    hostUsers_m.push_back(user);
+    return true;
+}
+
+bool
+WallClock::unregisterHostUser(ClockUser* user)
+{
+    hostUsers_m.remove(user);
+    return true;
+}
+
 void
 WallClock::updateTicksPerSecond(unsigned long ticks)
 {
@@ -45,10 +45,23 @@ class WallClock
 
     std::list<ClockUser*> users_m;
 
+    /// users with work from the host threads, only polled when some is pending.
+    std::list<ClockUser*> hostUsers_m;
+    std::atomic_bool      hostWork_m;
+
   public:
     bool registerUser(ClockUser* user);
     bool unregisterUser(ClockUser* user);
 
+    bool registerHostUser(ClockUser* user);
+    bool unregisterHostUser(ClockUser* user);
+
+    /// from any thread, the host users are notified before the next instruction.
+    void requestHostWork()
+    {
+        hostWork_m = true;
+    }
+
     static WallClock* instance(void);
 
     void addTimerEvent();
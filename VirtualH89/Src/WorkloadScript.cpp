@@ -0,0 +1,584 @@
+/// \file WorkloadScript.cpp
+///
+/// Scripted console sessions, timed phase by phase, for benchmarking whole
+/// workloads on the emulated machine.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#include "WorkloadScript.h"
+
+#include "SerialPortDevice.h"
+#include "WallClock.h"
+#include "logger.h"
+
+/// \cond
+#include <ctype.h>
+#include <fstream>
+#include <stdlib.h>
+#include <time.h>
+/// \endcond
+
+WorkloadScript*   WorkloadScript::_inst       = nullptr;
+WorkloadScript*   WorkloadScript::active_m    = nullptr;
+SerialPortDevice* WorkloadScript::console_m   = nullptr;
+pthread_mutex_t   WorkloadScript::doneMutex_m = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t    WorkloadScript::doneCond_m  = PTHREAD_COND_INITIALIZER;
+
+WorkloadScript*
+WorkloadScript::install_WorkloadScript(PropertyUtil::PropertyMapT& props,
+                                       SerialPortDevice*           console)
+{
+    console_m = console;
+
+    std::string script = props["workload"];
+
+    if (script.empty())
+    {
+        return nullptr;
+    }
+
+    WorkloadScript* workload = instance();
+
+    if (!workload->start(script, props["workload_results"]))
+    {
+        return nullptr;
+    }
+
+    return workload;
+}
+
+///
+/// Only called to start a script.
+///
+WorkloadScript*
+WorkloadScript::instance(void)
+{
+    if (!_inst)
+    {
+        _inst = new WorkloadScript();
+    }
+
+    return _inst;
+}
+
+WorkloadScript::WorkloadScript(): ClockUser(true),
+                                  line_m(0),
+                                  results_m(nullptr),
+                                  wait_m(wt_none),
+                                  deadline_m(0),
+                                  timeout_m(defTimeout_c),
+                                  nextKey_m(0),
+                                  result_m("none")
+{
+    pthread_mutex_init(&eventMutex_m, nullptr);
+    H89Operator::addListener(this);
+}
+
+WorkloadScript::~WorkloadScript()
+{
+    H89Operator::removeListener(this);
+    stop();
+}
+
+bool
+WorkloadScript::start(std::string script,
+                      std::string results)
+{
+    stop();
+
+    if (console_m == nullptr)
+    {
+        debugss(ssH89, ERROR, "No console for workload %s\n", script.c_str());
+        return false;
+    }
+
+    std::ifstream file(script.c_str());
+
+    if (!file.is_open())
+    {
+        debugss(ssH89, ERROR, "Unable to open workload %s\n", script.c_str());
+        return false;
+    }
+
+    std::string line;
+
+    lines_m.clear();
+
+    while (std::getline(file, line))
+    {
+        lines_m.push_back(line);
+    }
+
+    if (!results.empty())
+    {
+        results_m = fopen(results.c_str(), "w");
+
+        if (results_m == nullptr)
+        {
+            debugss(ssH89, ERROR, "Unable to create workload results %s\n", results.c_str());
+            return false;
+        }
+
+        fprintf(results_m, "phase,status,wall_s,cycles,mhz,cpu_s\n");
+    }
+
+    script_m  = script;
+    line_m    = 0;
+    wait_m    = wt_none;
+    timeout_m = defTimeout_c;
+    nextKey_m = 0;
+    keys_m.clear();
+    output_m.clear();
+    phase_m.clear();
+
+    pthread_mutex_lock(&eventMutex_m);
+    events_m.clear();
+    pthread_mutex_unlock(&eventMutex_m);
+
+    now(scriptStart_m);
+
+    pthread_mutex_lock(&doneMutex_m);
+    active_m = this;
+    pthread_mutex_unlock(&doneMutex_m);
+
+    WallClock::instance()->requestHostWork();
+
+    debugss(ssH89, INFO, "Running workload %s\n", script.c_str());
+
+    return true;
+}
+
+/// must be called with the system mutex held.
+void
+WorkloadScript::stop()
+{
+    if (active_m == this)
+    {
+        finish("stopped", "");
+    }
+}
+
+bool
+WorkloadScript::running()
+{
+    return active_m == this;
+}
+
+std::string
+WorkloadScript::status()
+{
+    if (!running())
+    {
+        return result_m;
+    }
+
+    return PropertyUtil::sprintf("running %s line=%u phase=%s", script_m.c_str(), line_m,
+                                 phase_m.empty() ? "-" : phase_m.c_str());
+}
+
+void
+WorkloadScript::waitDone()
+{
+    pthread_mutex_lock(&doneMutex_m);
+
+    while (active_m)
+    {
+        pthread_cond_wait(&doneCond_m, &doneMutex_m);
+    }
+
+    pthread_mutex_unlock(&doneMutex_m);
+}
+
+///
+/// Polled after every instruction while a script runs, since its waits end on a
+/// cycle count or on console output.
+///
+void
+WorkloadScript::notification(unsigned int cycleCount)
+{
+    if (active_m != this)
+    {
+        return;
+    }
+
+    WallClock::instance()->requestHostWork();
+
+    if (!keys_m.empty() && !sendKeys())
+    {
+        return;
+    }
+
+    if (wait_m != wt_none)
+    {
+        if (wait_m == wt_event)
+        {
+            pthread_mutex_lock(&eventMutex_m);
+
+            while (!events_m.empty() && events_m.front().compare(0, waitText_m.size(),
+                                                                 waitText_m) != 0)
+            {
+                events_m.pop_front();
+            }
+
+            if (!events_m.empty())
+            {
+                events_m.pop_front();
+                wait_m = wt_none;
+            }
+
+            pthread_mutex_unlock(&eventMutex_m);
+        }
+
+        if (wait_m != wt_none)
+        {
+            if (WallClock::instance()->getClock() < deadline_m)
+            {
+                return;
+            }
+
+            if (wait_m != wt_sleep)
+            {
+                finish("timeout", waitText_m);
+                return;
+            }
+
+            wait_m = wt_none;
+        }
+    }
+
+    step();
+}
+
+void
+WorkloadScript::operatorEvent(std::string event)
+{
+    if (event.compare(0, 9, "workload ") == 0)
+    {
+        // our own.
+        return;
+    }
+
+    pthread_mutex_lock(&eventMutex_m);
+    events_m.push_back(event);
+    pthread_mutex_unlock(&eventMutex_m);
+}
+
+void
+WorkloadScript::output(BYTE ch)
+{
+    ch &= 0x7f;
+
+    if (ch == 0 || ch == 0x7f)
+    {
+        // padding.
+        return;
+    }
+
+    if (output_m.size() >= maxOutput_c)
+    {
+        output_m.erase(0, maxOutput_c / 2);
+    }
+
+    output_m += (char) ch;
+
+    // only new output can complete the text.
+    if (wait_m == wt_output && output_m.size() >= waitText_m.size() &&
+        output_m.compare(output_m.size() - waitText_m.size(), waitText_m.size(), waitText_m) == 0)
+    {
+        wait_m = wt_none;
+    }
+}
+
+///
+/// Runs directives until one has to wait, or the script ends.
+///
+void
+WorkloadScript::step()
+{
+    while (active_m == this && wait_m == wt_none && keys_m.empty())
+    {
+        if (line_m >= lines_m.size())
+        {
+            finish("ok", "");
+            return;
+        }
+
+        std::string line = lines_m[line_m++];
+        size_t      end  = line.find_last_not_of(" \t\r\n");
+
+        line.erase((end == std::string::npos) ? 0 : end + 1);
+
+        size_t start = line.find_first_not_of(" \t");
+
+        if (start == std::string::npos || line[start] == '#')
+        {
+            continue;
+        }
+
+        size_t      sep = line.find_first_of(" \t", start);
+        std::string op  = line.substr(start, sep - start);
+        std::string arg;
+
+        if (sep != std::string::npos)
+        {
+            arg = line.substr(line.find_first_not_of(" \t", sep));
+        }
+
+        std::string  text;
+        unsigned int seconds;
+
+        if (op.compare("phase") == 0 && !arg.empty())
+        {
+            startPhase(arg);
+        }
+        else if (op.compare("end") == 0)
+        {
+            endPhase("ok");
+        }
+        else if (op.compare("send") == 0 && unescape(arg, text) && !text.empty())
+        {
+            keys_m = text;
+            sendKeys();
+        }
+        else if (op.compare("expect") == 0 && unescape(arg, text) && !text.empty())
+        {
+            startWait(wt_output, text);
+        }
+        else if (op.compare("wait") == 0 && !arg.empty())
+        {
+            startWait(wt_event, arg);
+        }
+        else if (op.compare("command") == 0 && !arg.empty())
+        {
+            pthread_mutex_lock(&eventMutex_m);
+            events_m.clear();
+            pthread_mutex_unlock(&eventMutex_m);
+
+            std::string resp = op_m.executeCommand(arg);
+
+            if (resp.compare(0, 5, "error") == 0)
+            {
+                finish("error", arg + ": " + resp);
+            }
+        }
+        else if (op.compare("sleep") == 0 && parseSeconds(arg, seconds))
+        {
+            startWait(wt_sleep, arg);
+        }
+        else if (op.compare("timeout") == 0 && parseSeconds(arg, seconds) && seconds != 0)
+        {
+            timeout_m = seconds;
+        }
+        else
+        {
+            finish("error", "syntax: " + line.substr(start));
+        }
+    }
+}
+
+///
+/// \retval true once all the keys have been typed.
+///
+bool
+WorkloadScript::sendKeys()
+{
+    unsigned long long clock = WallClock::instance()->getClock();
+
+    if (clock >= nextKey_m && console_m->sendReady())
+    {
+        console_m->sendData(keys_m[0]);
+        keys_m.erase(0, 1);
+        nextKey_m = clock + keyDelay_c;
+    }
+
+    return keys_m.empty();
+}
+
+void
+WorkloadScript::startWait(WaitType    type,
+                          std::string text)
+{
+    unsigned long long seconds = timeout_m;
+
+    if (type == wt_sleep)
+    {
+        seconds = strtoul(text.c_str(), nullptr, 10);
+    }
+
+    wait_m     = type;
+    waitText_m = text;
+    deadline_m = WallClock::instance()->getClock() +
+                 seconds * WallClock::instance()->getTicksPerSecond();
+}
+
+void
+WorkloadScript::startPhase(std::string name)
+{
+    endPhase("ok");
+
+    phase_m = name;
+    now(phaseStart_m);
+}
+
+void
+WorkloadScript::endPhase(const char* status)
+{
+    if (!phase_m.empty())
+    {
+        record(phase_m, status, phaseStart_m);
+        phase_m.clear();
+    }
+}
+
+void
+WorkloadScript::finish(const char*        status,
+                       const std::string& reason)
+{
+    endPhase(status);
+    record("total", status, scriptStart_m);
+
+    if (results_m)
+    {
+        fclose(results_m);
+        results_m = nullptr;
+    }
+
+    result_m = std::string(status);
+
+    if (!reason.empty())
+    {
+        result_m += PropertyUtil::sprintf(" %u: ", line_m) + reason;
+    }
+
+    keys_m.clear();
+    wait_m = wt_none;
+
+    debugss(ssH89, INFO, "Workload %s %s\n", script_m.c_str(), result_m.c_str());
+
+    H89Operator::notifyListeners("workload done " + result_m);
+
+    pthread_mutex_lock(&doneMutex_m);
+    active_m = nullptr;
+    pthread_cond_broadcast(&doneCond_m);
+    pthread_mutex_unlock(&doneMutex_m);
+}
+
+void
+WorkloadScript::record(const std::string& name,
+                       const char*        status,
+                       const Times&       from)
+{
+    Times to;
+
+    now(to);
+
+    double             wall   = to.wall - from.wall;
+    double             cpu    = to.cpu - from.cpu;
+    unsigned long long cycles = to.cycles - from.cycles;
+    double             mhz    = (wall > 0.0) ? cycles / wall / 1000000.0 : 0.0;
+
+    if (results_m)
+    {
+        fprintf(results_m, "%s,%s,%.6f,%llu,%.3f,%.6f\n", name.c_str(), status, wall, cycles, mhz,
+                cpu);
+        fflush(results_m);
+    }
+
+    H89Operator::notifyListeners(PropertyUtil::sprintf(
+                                     "workload phase %s %s wall=%.3f cycles=%llu mhz=%.3f cpu=%.3f",
+                                     name.c_str(), status, wall, cycles, mhz, cpu));
+}
+
+void
+WorkloadScript::now(Times& times)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    times.wall   = ts.tv_sec + ts.tv_nsec / 1000000000.0;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    times.cpu    = ts.tv_sec + ts.tv_nsec / 1000000000.0;
+
+    times.cycles = WallClock::instance()->getClock();
+}
+
+///
+/// \retval false if text is not a whole, decimal number of seconds.
+///
+bool
+WorkloadScript::parseSeconds(const std::string& text,
+                             unsigned int&      seconds)
+{
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return false;
+    }
+
+    seconds = strtoul(text.c_str(), nullptr, 10);
+
+    return true;
+}
+
+///
+/// \retval false on a \x without hex digits, result is then unchanged.
+///
+bool
+WorkloadScript::unescape(const std::string& text,
+                         std::string&       out)
+{
+    std::string result;
+
+    for (size_t x = 0; x < text.size(); ++x)
+    {
+        if (text[x] != '\\' || x + 1 == text.size())
+        {
+            result += text[x];
+            continue;
+        }
+
+        switch (text[++x])
+        {
+            case 'r':
+                result += '\r';
+                break;
+
+            case 'n':
+                result += '\n';
+                break;
+
+            case 't':
+                result += '\t';
+                break;
+
+            case 'e':
+                result += '\x1b';
+                break;
+
+            case 'x':
+            {
+                std::string digits = text.substr(x + 1, 2);
+                char*       end;
+
+                if (digits.empty() || !isxdigit((unsigned char) digits[0]))
+                {
+                    return false;
+                }
+
+                result += (char) strtoul(digits.c_str(), &end, 16);
+                x      += end - digits.c_str();
+                break;
+            }
+
+            default:
+                result += text[x];
+                break;
+        }
+    }
+
+    out = result;
+
+    return true;
+}
@@ -0,0 +1,176 @@
+/// \file WorkloadScript.h
+///
+/// Scripted console sessions, timed phase by phase, for benchmarking whole
+/// workloads on the emulated machine.
+///
+/// \date Oct 18, 2026
+/// \author Mark Garlanger
+///
+
+#ifndef WORKLOADSCRIPT_H_
+#define WORKLOADSCRIPT_H_
+
+#include "ClockUser.h"
+#include "H89Operator.h"
+#include "h89Types.h"
+#include "propertyutil.h"
+
+/// \cond
+#include <deque>
+#include <pthread.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+/// \endcond
+
+class SerialPortDevice;
+
+///
+/// \class WorkloadScript
+///
+/// \brief Runs a workload script against the console. This is a singleton.
+///
+/// A script is a text file with one directive per line; blank lines and lines
+/// starting with '#' are ignored:
+///
+///     phase <name>        end the current phase and start timing a new one
+///     end                 end the current phase
+///     send <text>         type text on the console
+///     expect <text>       wait for the guest to write text to the console
+///     wait <prefix>       wait for an operator event starting with prefix
+///     command <command>   run an operator command, the script fails on "error"
+///     sleep <seconds>     let the guest run for the given (guest) time
+///     timeout <seconds>   limit on each later wait, in guest seconds (default 300)
+///
+/// send and expect text may contain \\r, \\n, \\t, \\e (escape), \\\\ and \\xNN.
+///
+/// Everything runs on the CPU thread between instructions, and all waits are
+/// measured in CPU cycles, so a script behaves the same throttled or not.
+/// Keystrokes are typed at about the H19's rate, not faster than the UART takes
+/// them.
+///
+/// Each phase ends with a "workload phase <name> <status> wall=<s> cycles=<n>
+/// mhz=<n> cpu=<s>" operator event, giving the host (wall) time, the guest cycles
+/// and the effective speed, and the host CPU time used by the process. The same
+/// is written to the optional results file as CSV. The script ends with
+/// "workload done ok", or "workload done <status> <line>: <reason>" on a failure.
+///
+class WorkloadScript: public ClockUser, public OperatorEventListener
+{
+  public:
+    /// remembers the console the scripts type on, and starts any "workload" script.
+    static WorkloadScript* install_WorkloadScript(PropertyUtil::PropertyMapT& props,
+                                                  SerialPortDevice*           console);
+
+    static WorkloadScript* instance(void);
+
+    /// the instance, or nullptr when no script has been started.
+    static WorkloadScript* current(void)
+    {
+        return _inst;
+    }
+
+    /// must be called with the system mutex held, or before the CPU is started.
+    bool start(std::string script,
+               std::string results);
+    void stop();
+    bool running();
+
+    /// the running script's position, or the last one's result.
+    std::string status();
+
+    /// blocks until no script is running.
+    static void waitDone();
+
+    /// called with every character the guest writes to the console.
+    static inline void consoleOutput(BYTE ch)
+    {
+        if (active_m)
+        {
+            active_m->output(ch);
+        }
+    }
+
+    virtual void notification(unsigned int cycleCount) override;
+    virtual void operatorEvent(std::string event) override;
+
+  private:
+    WorkloadScript();
+    virtual ~WorkloadScript();
+
+    /// use C++11 to avoid having to define copy constructor
+    WorkloadScript(WorkloadScript const&)            = delete;
+    WorkloadScript& operator=(WorkloadScript const&) = delete;
+
+    enum WaitType
+    {
+        wt_none,
+        wt_output,
+        wt_event,
+        wt_sleep
+    };
+
+    struct Times
+    {
+        double             wall;
+        double             cpu;
+        unsigned long long cycles;
+    };
+
+    void output(BYTE ch);
+    void step();
+    bool sendKeys();
+    void startWait(WaitType type,
+                   std::string text);
+    void startPhase(std::string name);
+    void endPhase(const char* status);
+    void finish(const char*        status,
+                const std::string& reason);
+    void record(const std::string& name,
+                const char*        status,
+                const Times&       from);
+
+    static void now(Times& times);
+    static bool parseSeconds(const std::string& text,
+                             unsigned int&      seconds);
+    static bool unescape(const std::string& text,
+                         std::string&       out);
+
+    static WorkloadScript*    _inst;
+    static WorkloadScript*    active_m;
+    static SerialPortDevice*  console_m;
+
+    /// guest cycles between keystrokes, as the H19 sends them.
+    static const unsigned int keyDelay_c     = 2133;
+    static const unsigned int defTimeout_c   = 300;
+    static const size_t       maxOutput_c    = 512;
+
+    H89Operator               op_m;
+    std::string               script_m;
+    std::vector<std::string>  lines_m;
+    unsigned int              line_m;
+    FILE*                     results_m;
+
+    WaitType                  wait_m;
+    std::string               waitText_m;
+    unsigned long long        deadline_m;
+    unsigned int              timeout_m;
+
+    std::string               keys_m;
+    unsigned long long        nextKey_m;
+    std::string               output_m;
+
+    std::string               phase_m;
+    Times                     phaseStart_m;
+    Times                     scriptStart_m;
+    std::string               result_m;
+
+    /// events from any thread, waiting to be matched on the CPU thread.
+    pthread_mutex_t           eventMutex_m;
+    std::deque<std::string>   events_m;
+
+    static pthread_mutex_t    doneMutex_m;
+    static pthread_cond_t     doneCond_m;
+};
+
+#endif // WORKLOADSCRIPT_H_
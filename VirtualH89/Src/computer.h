@@ -38,6 +38,7 @@ class Computer
     virtual void systemMutexRelease()   = 0;
     virtual void systemMutexAcquire()   = 0;
     virtual void waitCPU()              = 0;
+    virtual void addWaitStates(unsigned int cycles) = 0;
 
     virtual AddressBus& getAddressBus() = 0;
 };
@@ -16,4 +16,11 @@
 // all the output -  actually 20x
 #define TEN_X_SLOWER 0
 
+// Counts executions, cycles and taken branches per Z80 opcode, for the operator's
+// "opstats" command. Costs a call per instruction, so it is left out unless built
+// with e.g. make CXXFLAGS="-g -std=c++11 -DZ80_STATS=1".
+#ifndef Z80_STATS
+#define Z80_STATS 0
+#endif
+
 #endif // CONFIG_H_
@@ -18,6 +18,33 @@
 class AddressBus;
 class IOBus;
 
+///
+/// \brief Replaces a routine in ROM with host code.
+///
+/// Called by the CPU before it executes the instruction at a registered
+/// address. The handler performs the whole routine and updates the registers,
+/// including the PC, and the number of cycles to charge. It returns false to
+/// have the CPU run the instruction after all.
+///
+class CPUTrap
+{
+  public:
+    struct Registers
+    {
+        WORD af;
+        WORD bc;
+        WORD de;
+        WORD hl;
+        WORD sp;
+        WORD pc;
+    };
+
+    virtual ~CPUTrap() {}
+
+    virtual bool trap(Registers&    regs,
+                      unsigned int& cycles) = 0;
+};
+
 ///
 /// \brief  Abstract processor.
 ///
@@ -47,9 +74,18 @@ class CPU
     virtual void setAddressBus(AddressBus* ab) = 0;
     virtual void continueRunning(void)         = 0;
     virtual void waitState(void)               = 0;
+    virtual void addWaitStates(unsigned int cycles) = 0;
     virtual std::string dumpDebug()            = 0;
     virtual void setSpeedup(int factor)        = 0;
     virtual void enableFast(void)              = 0;
+    virtual void addTrap(WORD     addr,
+                         CPUTrap* trap)        = 0;
+    /// may be called from a signal handler, e.g. to sample the PC.
+    virtual WORD getPC(void)                   = 0;
+
+    /// Per-opcode counts as CSV, empty if the CPU wasn't built to keep them.
+    virtual std::string dumpStats()            = 0;
+    virtual void clearStats(void)              = 0;
 
 };
 
@@ -11,6 +11,7 @@
 #include "h17.h"
 
 #include "H89.h"
+#include "AddressBus.h"
 #include "logger.h"
 #include "WallClock.h"
 #include "DiskDrive.h"
@@ -36,7 +37,8 @@ H17::H17(int baseAddr): DiskController(baseAddr, H17_NumPorts_c),
                         transmitterHoldingRegister_m(0),
                         curDrive_m(maxDiskDrive_c),
                         fillChar_m(0),
-                        syncChar_m(0xfd)
+                        syncChar_m(0xfd),
+                        hleCycles_m(2000)
 {
     for (int i = 0; i < maxDiskDrive_c; ++i)
     {
@@ -69,7 +71,8 @@ H17::install_H17(BYTE                        baseAddr,
                  std::string                 slot)
 {
     std::string                   s;
-    H17*                          h17 = new H17(baseAddr);
+    H17*                          h17       = new H17(baseAddr);
+    std::string                   writeBack = props["h17_writeback"];
     debugss(ssH17, INFO, "entering\n");
 
     for (BYTE i = 0; i < maxDiskDrive_c; ++i)
@@ -95,6 +98,11 @@ H17::install_H17(BYTE                        baseAddr,
                 {
                     shared_ptr<HardSectoredDisk> disk = make_shared<HardSectoredDisk>(s.c_str());
 
+                    if (!writeBack.empty())
+                    {
+                        disk->enableWriteBack(strtoul(writeBack.c_str(), nullptr, 0));
+                    }
+
                     drive->insertDisk(disk);
                 }
 
@@ -102,6 +110,19 @@ H17::install_H17(BYTE                        baseAddr,
         }
     }
 
+    if (props["h17_hle"] == "yes")
+    {
+        s = props["h17_hle_cycles"];
+
+        if (!s.empty())
+        {
+            h17->hleCycles_m = strtoul(s.c_str(), nullptr, 0);
+        }
+
+        h89.getCPU().addTrap(romReadEntry_c, h17);
+        h89.getCPU().addTrap(romWriteEntry_c, h17);
+    }
+
     return h17;
 }
 
@@ -121,106 +142,142 @@ H17::in(BYTE addr)
     switch (offset)
     {
         case DataPortOffset_c:
-            /// \todo determine if checking receiveDataAvail_m should be done.
-            val                = receiverOutputRegister_m;
-            receiveDataAvail_m = false;
-            debugss(ssH17, INFO, " h17.in(Data) - 0x%02x\n", val);
+            val = dataIn();
             break;
 
         case StatusPortOffset_c:
-            if (transmitterBufferEmpty_m)
-            {
-                val |= TransmitterBufferEmpty_Flag;
-            }
-
-            if (fillCharTransmitted_m)
-            {
-                val                  |= FillCharTransmitted_Flag;
-                fillCharTransmitted_m = false;
-            }
+            val = statusIn();
+            break;
 
-            if (receiverOverrun_m)
-            {
-                // \todo determine flag should be set to false after the read
-                val |= ReceiverOverrun_Flag;
-            }
+        case SyncPortOffset_c:
+            val = syncIn();
+            break;
 
-            if (receiveDataAvail_m)
-            {
-                val |= ReceiveDataAvail_Flag;
-            }
+        case ControlPortOffset_c:
+            val = controlIn();
+            break;
 
-            debugss(ssH17, INFO, " h17.in(Status) - 0x%02x\n", val);
+        default:
+            debugss(ssH17, ERROR, "h17.in(0x%02x) - invalid port\n", addr);
             break;
+    }
 
-        case SyncPortOffset_c:
-            // SyncPort data terminates at the controller.
-            val                     = syncChar_m;
+    return (val);
+}
 
-            // Based on a comment in the monitor code.. reading the port sets the searching.
-            state_m                 = seekingSyncState;
-            syncCharacterReceived_m = false;
+BYTE
+H17::dataIn()
+{
+    /// \todo determine if checking receiveDataAvail_m should be done.
+    BYTE val = receiverOutputRegister_m;
 
-            debugss(ssH17, INFO, " h17.in(Sync) - 0x%02x\n", val);
-            break;
+    receiveDataAvail_m = false;
+    debugss(ssH17, INFO, " h17.in(Data) - 0x%02x\n", val);
 
-        case ControlPortOffset_c:
+    return (val);
+}
+
+BYTE
+H17::statusIn()
+{
+    BYTE val = 0;
 
-            // Majority of ControlPort is related to the Disk Drive, only sync detect is specific
-            // to the controller.
+    if (transmitterBufferEmpty_m)
+    {
+        val |= TransmitterBufferEmpty_Flag;
+    }
 
-            if (curDrive_m < maxDiskDrive_c)
-            {
-                // get info from the drive - if no drive attached, the auto-detection will
-                // correctly detect no drive.
-                if (drives_m[curDrive_m])
-                {
-                    bool hole, trackZero, writeProtect;
+    if (fillCharTransmitted_m)
+    {
+        val                  |= FillCharTransmitted_Flag;
+        fillCharTransmitted_m = false;
+    }
 
-                    drives_m[curDrive_m]->getControlInfo(spinCycles_m / CPUCyclesPerByte_c,
-                                                         hole, trackZero, writeProtect);
+    if (receiverOverrun_m)
+    {
+        // \todo determine flag should be set to false after the read
+        val |= ReceiverOverrun_Flag;
+    }
 
-                    if (hole)
-                    {
-                        val |= H17::ctrlHoleDetect_Flag;
-                    }
+    if (receiveDataAvail_m)
+    {
+        val |= ReceiveDataAvail_Flag;
+    }
 
-                    if (trackZero)
-                    {
-                        val |= H17::ctrlTrackZeroDetect_Flag;
-                    }
+    debugss(ssH17, INFO, " h17.in(Status) - 0x%02x\n", val);
 
-                    if (writeProtect)
-                    {
-                        // disk is write protected.
-                        val |= H17::ctrlWriteProtect_Flag;
-                    }
-                }
-                else
-                {
-                    debugss(ssH17, INFO, " h17.in(Control) - No drive [%d]\n", curDrive_m);
-                }
-            }
-            else
+    return (val);
+}
+
+BYTE
+H17::syncIn()
+{
+    // SyncPort data terminates at the controller.
+    BYTE val = syncChar_m;
+
+    // Based on a comment in the monitor code.. reading the port sets the searching.
+    state_m                 = seekingSyncState;
+    syncCharacterReceived_m = false;
+
+    debugss(ssH17, INFO, " h17.in(Sync) - 0x%02x\n", val);
+
+    return (val);
+}
+
+BYTE
+H17::controlIn()
+{
+    BYTE val = 0;
+
+    // Majority of ControlPort is related to the Disk Drive, only sync detect is specific
+    // to the controller.
+
+    if (curDrive_m < maxDiskDrive_c)
+    {
+        // get info from the drive - if no drive attached, the auto-detection will
+        // correctly detect no drive.
+        if (drives_m[curDrive_m])
+        {
+            bool hole, trackZero, writeProtect;
+
+            drives_m[curDrive_m]->getControlInfo(spinCycles_m / CPUCyclesPerByte_c,
+                                                 hole, trackZero, writeProtect);
+
+            if (hole)
             {
-                debugss(ssH17, INFO, " h17.in(Control) - Invalid drive [%d]\n", curDrive_m);
+                val |= H17::ctrlHoleDetect_Flag;
             }
 
-            // Get the sync info directly from the controller.
-            if (syncCharacterReceived_m)
+            if (trackZero)
             {
-                val                    |= ctrlSyncDetect_Flag;
-                syncCharacterReceived_m = false;
+                val |= H17::ctrlTrackZeroDetect_Flag;
             }
 
-            debugss(ssH17, INFO, " h17.in(Control) - 0x%02x\n", val);
-            break;
+            if (writeProtect)
+            {
+                // disk is write protected.
+                val |= H17::ctrlWriteProtect_Flag;
+            }
+        }
+        else
+        {
+            debugss(ssH17, INFO, " h17.in(Control) - No drive [%d]\n", curDrive_m);
+        }
+    }
+    else
+    {
+        debugss(ssH17, INFO, " h17.in(Control) - Invalid drive [%d]\n", curDrive_m);
+    }
 
-        default:
-            debugss(ssH17, ERROR, "h17.in(0x%02x) - invalid port\n", addr);
-            break;
+    // Get the sync info directly from the controller.
+    if (syncCharacterReceived_m)
+    {
+        val                    |= ctrlSyncDetect_Flag;
+        syncCharacterReceived_m = false;
     }
 
+    debugss(ssH17, INFO, " h17.in(Control) - 0x%02x\n", val);
+
     return (val);
 }
 
@@ -233,21 +290,7 @@ H17::out(BYTE addr,
     switch (offset)
     {
         case DataPortOffset_c:
-            debugss(ssH17, INFO, " h17.out(Data) - 0x%02x\n", val);
-
-            if (!(curDrive_m < maxDiskDrive_c))
-            {
-                debugss(ssH17, WARNING, " h17.out(Data) - No drive selected\n");
-            }
-
-            if (!transmitterBufferEmpty_m)
-            {
-                debugss(ssH17, ERROR, "Overwriting Transmitter Holding Register\n");
-            }
-
-            /// No error status to indicate that the THR was overwritten.
-            transmitterHoldingRegister_m = val;
-            transmitterBufferEmpty_m     = false;
+            dataOut(val);
             break;
 
         case FillPortOffset_c:
@@ -368,6 +411,80 @@ H17::out(BYTE addr,
     }
 }
 
+void
+H17::dataOut(BYTE val)
+{
+    debugss(ssH17, INFO, " h17.out(Data) - 0x%02x\n", val);
+
+    if (!(curDrive_m < maxDiskDrive_c))
+    {
+        debugss(ssH17, WARNING, " h17.out(Data) - No drive selected\n");
+    }
+
+    if (!transmitterBufferEmpty_m)
+    {
+        debugss(ssH17, ERROR, "Overwriting Transmitter Holding Register\n");
+    }
+
+    /// No error status to indicate that the THR was overwritten.
+    transmitterHoldingRegister_m = val;
+    transmitterBufferEmpty_m     = false;
+}
+
+///
+/// Port handlers for the registers polled a byte at a time by the ROM.
+///
+BYTE
+H17::dataPortIn(IODevice* dev,
+                BYTE      addr)
+{
+    return static_cast<H17*>(dev)->dataIn();
+}
+
+BYTE
+H17::statusPortIn(IODevice* dev,
+                  BYTE      addr)
+{
+    return static_cast<H17*>(dev)->statusIn();
+}
+
+BYTE
+H17::controlPortIn(IODevice* dev,
+                   BYTE      addr)
+{
+    return static_cast<H17*>(dev)->controlIn();
+}
+
+void
+H17::dataPortOut(IODevice* dev,
+                 BYTE      addr,
+                 BYTE      val)
+{
+    static_cast<H17*>(dev)->dataOut(val);
+}
+
+void
+H17::getPortHandlers(BYTE        offset,
+                     InHandler&  in,
+                     OutHandler& out)
+{
+    switch (offset)
+    {
+        case DataPortOffset_c:
+            in  = dataPortIn;
+            out = dataPortOut;
+            break;
+
+        case StatusPortOffset_c:
+            in = statusPortIn;
+            break;
+
+        case ControlPortOffset_c:
+            in = controlPortIn;
+            break;
+    }
+}
+
 
 
 bool
@@ -425,6 +542,18 @@ H17::removeDrive(BYTE unitNum)
     return (retVal);
 }
 
+void
+H17::sync()
+{
+    for (int i = 0; i < maxDiskDrive_c; i++)
+    {
+        if (drives_m[i])
+        {
+            drives_m[i]->sync();
+        }
+    }
+}
+
 void
 H17::selectSide(BYTE side)
 {
@@ -539,3 +668,324 @@ H17::notification(unsigned int cycleCount)
     }
 
 }
+
+///
+/// \brief Trapped entry to the ROM's D.READ or D.WRITE.
+///
+/// Anything unexpected (no disk, a bad header or checksum, write protect) returns false, so
+/// the ROM runs the routine itself, with its retries and error reporting.
+///
+bool
+H17::trap(CPUTrap::Registers& regs,
+          unsigned int&       cycles)
+{
+    AddressBus& ab = h89.getAddressBus();
+
+    // with ORG0 enabled, RAM may be mapped over the ROM. PUSH H; CALL D.SDT
+    if (ab.readByte(regs.pc) != 0xe5 || ab.readByte(regs.pc + 1) != 0xcd ||
+        ab.readByte(regs.pc + 2) != 0x85 || ab.readByte(regs.pc + 3) != 0x20)
+    {
+        return false;
+    }
+
+    if (regs.pc == romReadEntry_c)
+    {
+        return romRead(ab, regs, cycles);
+    }
+
+    if (regs.pc == romWriteEntry_c)
+    {
+        return romWrite(ab, regs, cycles);
+    }
+
+    return false;
+}
+
+DiskDrive*
+H17::romSelect(AddressBus& ab,
+               BYTE&       unit)
+{
+    unit = ab.readByte(romUnit_c);
+
+    // the same drive select bits D.SDT sends to the control port.
+    BYTE select = ((unit + 1) << 1) & 0x7f;
+
+    if (select & DriveSelect0_Ctrl)
+    {
+        return drives_m[ds0].get();
+    }
+    else if (select & DriveSelect1_Ctrl)
+    {
+        return drives_m[ds1].get();
+    }
+    else if (select & DriveSelect2_Ctrl)
+    {
+        return drives_m[ds2].get();
+    }
+
+    return nullptr;
+}
+
+bool
+H17::romSeek(AddressBus& ab,
+             DiskDrive*  drive,
+             BYTE        unit,
+             BYTE        track)
+{
+    // like the ROM, steps relative to where it last left the unit.
+    WORD trackAddr = romTrackTable_c + 2 * unit;
+    BYTE cur       = ab.readByte(trackAddr);
+
+    if (cur >= 80 || track >= 80)
+    {
+        return false;
+    }
+
+    while (cur != track)
+    {
+        drive->step(track > cur);
+        cur += (track > cur) ? 1 : -1;
+        ab.writeByte(trackAddr, cur);
+    }
+
+    return true;
+}
+
+bool
+H17::findSync(DiskDrive*     drive,
+              unsigned long  start,
+              unsigned long  len,
+              unsigned long& pos)
+{
+    for (pos = start; pos < start + len && pos < BytesPerTrack_c; ++pos)
+    {
+        if (drive->readData(pos) == 0xfd)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool
+H17::romLocate(DiskDrive*     drive,
+               BYTE           volume,
+               BYTE           track,
+               BYTE           sector,
+               unsigned long& hdrPos)
+{
+    for (unsigned int slot = 0; slot < sectorsPerTrack_c; ++slot)
+    {
+        unsigned long pos;
+
+        if (!findSync(drive, slot * bytesPerSlot_c + hdrSyncStart_c, hdrSyncWindow_c, pos))
+        {
+            return false;
+        }
+
+        BYTE hdr[4];
+        BYTE chk = 0;
+
+        for (int x = 0; x < 4; ++x)
+        {
+            hdr[x] = drive->readData(pos + 1 + x);
+        }
+
+        for (int x = 0; x < 3; ++x)
+        {
+            chk = ((chk ^ hdr[x]) << 1) | ((chk ^ hdr[x]) >> 7);
+        }
+
+        if (chk != hdr[3] || hdr[0] != volume || hdr[1] != track)
+        {
+            return false;
+        }
+
+        if (hdr[2] == sector)
+        {
+            hdrPos = pos;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+///
+/// \brief Leave the ROM's work area as D.SDT and the read/write loop would have.
+///
+void
+H17::romDone(AddressBus& ab,
+             BYTE        unit,
+             WORD        lastBlock,
+             WORD        counter)
+{
+    BYTE ctrl  = ab.readByte(romControl_c);
+    WORD track = romTrackTable_c + 2 * unit;
+    WORD count = ab.readByte(counter) | (ab.readByte(counter + 1) << 8);
+
+    ++count;
+    ab.writeByte(counter, count & 0xff);
+    ab.writeByte(counter + 1, count >> 8);
+
+    ab.writeByte(romTrack_c, lastBlock / sectorsPerTrack_c);
+    ab.writeByte(romSector_c, lastBlock % sectorsPerTrack_c);
+    ab.writeByte(romControl_c, (ctrl & WriteEnableRAM_Ctrl) | (((unit + 1) << 1) & 0x7f) |
+                 MotorOn_Ctrl);
+    ab.writeByte(romMotorTimer_c, 0);
+    ab.writeByte(romTrackPtr_c, track & 0xff);
+    ab.writeByte(romTrackPtr_c + 1, track >> 8);
+    ab.writeByte(romVolumePtr_c, (track + 1) & 0xff);
+    ab.writeByte(romVolumePtr_c + 1, (track + 1) >> 8);
+    ab.writeByte(romRetries_c, 10);
+}
+
+///
+/// \brief D.READ - HL = block, DE = buffer, BC = byte count.
+///
+bool
+H17::romRead(AddressBus&         ab,
+             CPUTrap::Registers& regs,
+             unsigned int&       cycles)
+{
+    BYTE       unit;
+    DiskDrive* drive = romSelect(ab, unit);
+
+    if (!drive)
+    {
+        return false;
+    }
+
+    BYTE         volume  = ab.readByte(romTrackTable_c + 2 * unit + 1);
+    unsigned int count   = regs.bc;
+    unsigned int sectors = (count + 255) >> 8;
+    WORD         block   = regs.hl;
+    WORD         buf     = regs.de;
+    BYTE         chk     = 0;
+
+    if (sectors == 0)
+    {
+        return false;
+    }
+
+    for (unsigned int x = 0; x < sectors; ++x, ++block)
+    {
+        unsigned long hdr, pos;
+        unsigned int  len = (count > 256) ? 256 : count;
+
+        if (!romSeek(ab, drive, unit, block / sectorsPerTrack_c) ||
+            !romLocate(drive, volume, block / sectorsPerTrack_c, block % sectorsPerTrack_c, hdr) ||
+            !findSync(drive, hdr + 5, dataSyncWindow_c, pos))
+        {
+            return false;
+        }
+
+        chk = 0;
+
+        for (unsigned int y = 0; y < 256; ++y)
+        {
+            BYTE data = drive->readData(pos + 1 + y);
+
+            if (y < len)
+            {
+                ab.writeByte(buf++, data);
+            }
+
+            chk = ((chk ^ data) << 1) | ((chk ^ data) >> 7);
+        }
+
+        if (drive->readData(pos + 257) != chk)
+        {
+            return false;
+        }
+
+        count -= len;
+    }
+
+    romDone(ab, unit, block - 1, romReadCount_c);
+
+    regs.bc = regs.bc & 0x00ff;
+    regs.de = chk;
+    regs.pc = romExit_c;
+    cycles  = sectors * hleCycles_m;
+
+    return true;
+}
+
+///
+/// \brief D.WRITE - HL = block, DE = buffer, BC = byte count, written as whole sectors.
+///
+bool
+H17::romWrite(AddressBus&         ab,
+              CPUTrap::Registers& regs,
+              unsigned int&       cycles)
+{
+    BYTE       unit;
+    DiskDrive* drive = romSelect(ab, unit);
+
+    if (!drive)
+    {
+        return false;
+    }
+
+    bool hole, trackZero, writeProtect;
+
+    drive->getControlInfo(0, hole, trackZero, writeProtect);
+
+    BYTE         volume  = ab.readByte(romTrackTable_c + 2 * unit + 1);
+    BYTE         lead    = ab.readByte(romWriteLead_c);
+    unsigned int sectors = (regs.bc + 255) >> 8;
+    WORD         block   = regs.hl;
+    WORD         buf     = regs.de;
+
+    if (writeProtect || sectors == 0)
+    {
+        return false;
+    }
+
+    for (unsigned int x = 0; x < sectors; ++x, ++block)
+    {
+        unsigned long hdr;
+
+        if (!romSeek(ab, drive, unit, block / sectorsPerTrack_c) ||
+            !romLocate(drive, volume, block / sectorsPerTrack_c, block % sectorsPerTrack_c, hdr))
+        {
+            return false;
+        }
+
+        unsigned long pos = hdr + writeStart_c;
+        BYTE          chk = 0;
+
+        for (BYTE y = 0; y < lead; ++y)
+        {
+            drive->writeData(pos++, 0);
+        }
+
+        drive->writeData(pos++, 0xfd);
+
+        for (unsigned int y = 0; y < 256; ++y)
+        {
+            BYTE data = ab.readByte(buf++);
+
+            drive->writeData(pos++, data);
+            chk = ((chk ^ data) << 1) | ((chk ^ data) >> 7);
+        }
+
+        drive->writeData(pos++, chk);
+
+        for (int y = 0; y < 3; ++y)
+        {
+            drive->writeData(pos++, 0);
+        }
+    }
+
+    romDone(ab, unit, block - 1, romWriteCount_c);
+
+    regs.bc = 0;
+    regs.de = 0;
+    regs.pc = romExit_c;
+    cycles  = sectors * hleCycles_m;
+
+    return true;
+}
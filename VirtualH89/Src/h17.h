@@ -13,12 +13,14 @@
 #include "DiskController.h"
 #include "ClockUser.h"
 #include "GppListener.h"
+#include "cpu.h"
 #include "propertyutil.h"
 
 /// \cond
 #include <memory>
 /// \endcond
 
+class AddressBus;
 class DiskDrive;
 
 ///
@@ -28,7 +30,11 @@ class DiskDrive;
 /// at 102k per disk. Later (third-party) software upgrades supported disks up to 408k per
 /// disk, by using a double-sided 96 tpi drive (H-17-4 or H-17-5).
 ///
-class H17: public DiskController, public ClockUser, public GppListener
+/// Optionally (h17_hle), the sector read and write routines in the H17 ROM are trapped
+/// and the transfer is done directly against the raw track, instead of the ROM polling
+/// the controller one byte at a time.
+///
+class H17: public DiskController, public ClockUser, public GppListener, public CPUTrap
 {
   public:
     H17(int BaseAddr);
@@ -41,6 +47,9 @@ class H17: public DiskController, public ClockUser, public GppListener
     virtual BYTE in(BYTE addr) override;
     virtual void out(BYTE addr,
                      BYTE val) override;
+    virtual void getPortHandlers(BYTE        offset,
+                                 InHandler&  in,
+                                 OutHandler& out) override;
 
     virtual bool connectDrive(BYTE                       unitNum,
                               std::shared_ptr<DiskDrive> drive);
@@ -50,6 +59,9 @@ class H17: public DiskController, public ClockUser, public GppListener
 
     virtual void notification(unsigned int cycleCount) override;
 
+    virtual bool trap(CPUTrap::Registers& regs,
+                      unsigned int&       cycles) override;
+
     // TODO: implement this
     std::vector<GenericDiskDrive*> getDiskDrives() override
     {
@@ -75,9 +87,52 @@ class H17: public DiskController, public ClockUser, public GppListener
     void reset()  override
     {
     }
+    void sync() override;
 
   private:
     virtual void gppNewValue(BYTE gpo) override;
+
+    BYTE dataIn();
+    BYTE statusIn();
+    BYTE syncIn();
+    BYTE controlIn();
+    void dataOut(BYTE val);
+
+    static BYTE dataPortIn(IODevice* dev,
+                           BYTE      addr);
+    static BYTE statusPortIn(IODevice* dev,
+                             BYTE      addr);
+    static BYTE controlPortIn(IODevice* dev,
+                              BYTE      addr);
+    static void dataPortOut(IODevice* dev,
+                            BYTE      addr,
+                            BYTE      val);
+
+    bool romRead(AddressBus&         ab,
+                 CPUTrap::Registers& regs,
+                 unsigned int&       cycles);
+    bool romWrite(AddressBus&         ab,
+                  CPUTrap::Registers& regs,
+                  unsigned int&       cycles);
+    DiskDrive* romSelect(AddressBus& ab,
+                         BYTE&       unit);
+    bool romSeek(AddressBus& ab,
+                 DiskDrive*  drive,
+                 BYTE        unit,
+                 BYTE        track);
+    bool romLocate(DiskDrive*     drive,
+                   BYTE           volume,
+                   BYTE           track,
+                   BYTE           sector,
+                   unsigned long& hdrPos);
+    bool findSync(DiskDrive*     drive,
+                  unsigned long  start,
+                  unsigned long  len,
+                  unsigned long& pos);
+    void romDone(AddressBus& ab,
+                 BYTE        unit,
+                 WORD        lastBlock,
+                 WORD        counter);
     static const BYTE h17_gppSideSelectBit_c = 0b01000000;
 
     enum State
@@ -124,6 +179,40 @@ class H17: public DiskController, public ClockUser, public GppListener
     BYTE                        fillChar_m;
     BYTE                        syncChar_m;
 
+    /// cycles charged for each sector transferred by trap().
+    unsigned int                hleCycles_m;
+
+    ///
+    /// H17 ROM entry points and RAM work area used by trap(). The volume and track
+    /// of each unit are kept as pairs starting at romTrackTable_c.
+    ///
+    static const WORD romReadEntry_c   = 0x1c3f; // D.READ
+    static const WORD romWriteEntry_c  = 0x1cde; // D.WRITE
+    static const WORD romExit_c        = 0x205e; // D.XOK
+    static const WORD romWriteLead_c   = 0x204b; // zero bytes before the data sync
+    static const WORD romTrack_c       = 0x20a0;
+    static const WORD romSector_c      = 0x20a1;
+    static const WORD romControl_c     = 0x20a2;
+    static const WORD romMotorTimer_c  = 0x20a4;
+    static const WORD romTrackPtr_c    = 0x20a5;
+    static const WORD romVolumePtr_c   = 0x20a7;
+    static const WORD romTrackTable_c  = 0x20a9;
+    static const WORD romRetries_c     = 0x20b4;
+    static const WORD romReadCount_c   = 0x20bb;
+    static const WORD romWriteCount_c  = 0x20bd;
+    static const WORD romUnit_c        = 0x2131;
+
+    ///
+    /// Where the ROM finds the sync characters, relative to the start of the sector hole
+    /// and to the end of the header, and where its writes start relative to the header.
+    ///
+    static const unsigned int hdrSyncStart_c    = 2;
+    static const unsigned int hdrSyncWindow_c   = 28;
+    static const unsigned int dataSyncWindow_c  = 26;
+    static const unsigned int writeStart_c      = 10;
+    static const unsigned int bytesPerSlot_c    = 320;
+    static const unsigned int sectorsPerTrack_c = 10;
+
     ///
     /// Ports
     ///
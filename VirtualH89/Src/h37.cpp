@@ -74,6 +74,8 @@ Z_89_37::install_H37(Computer*                   computer,
 
     debugss(ssH37, INFO, "entering\n");
 
+    z37->wd1797_m->setTurbo(props["h37_turbo"] == "yes");
+
     for (BYTE i = 0; i < numDisks_c; ++i)
     {
 
@@ -279,6 +281,72 @@ Z_89_37::out(BYTE addr,
     }
 }
 
+///
+/// Port handlers for the WD1797 registers polled during every transfer. With
+/// sector/track access selected, they take the generic path.
+///
+BYTE
+Z_89_37::statusPortIn(IODevice* dev,
+                      BYTE      addr)
+{
+    Z_89_37* h37 = static_cast<Z_89_37*>(dev);
+
+    if (h37->sectorTrackAccess_m)
+    {
+        return h37->in(addr);
+    }
+
+    return h37->wd1797_m->statusIn();
+}
+
+BYTE
+Z_89_37::dataPortIn(IODevice* dev,
+                    BYTE      addr)
+{
+    Z_89_37* h37 = static_cast<Z_89_37*>(dev);
+
+    if (h37->sectorTrackAccess_m)
+    {
+        return h37->in(addr);
+    }
+
+    return h37->wd1797_m->dataIn();
+}
+
+void
+Z_89_37::dataPortOut(IODevice* dev,
+                     BYTE      addr,
+                     BYTE      val)
+{
+    Z_89_37* h37 = static_cast<Z_89_37*>(dev);
+
+    if (h37->sectorTrackAccess_m)
+    {
+        h37->out(addr, val);
+        return;
+    }
+
+    h37->wd1797_m->dataOut(val);
+}
+
+void
+Z_89_37::getPortHandlers(BYTE        offset,
+                         InHandler&  in,
+                         OutHandler& out)
+{
+    switch (offset)
+    {
+        case StatusPort_Offset_c:
+            in = statusPortIn;
+            break;
+
+        case DataPort_Offset_c:
+            in  = dataPortIn;
+            out = dataPortOut;
+            break;
+    }
+}
+
 void
 Z_89_37::motorOn(bool motor)
 {
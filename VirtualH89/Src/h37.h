@@ -38,6 +38,9 @@ class Z_89_37: public DiskController, public WD179xUserIf
     virtual BYTE in(BYTE addr) override;
     virtual void out(BYTE addr,
                      BYTE val) override;
+    virtual void getPortHandlers(BYTE        offset,
+                                 InHandler&  in,
+                                 OutHandler& out) override;
 
     virtual bool connectDrive(BYTE                unitNum,
                               GenericFloppyDrive* drive);
@@ -79,6 +82,14 @@ class Z_89_37: public DiskController, public WD179xUserIf
   private:
     void motorOn(bool motor);
 
+    static BYTE statusPortIn(IODevice* dev,
+                             BYTE      addr);
+    static BYTE dataPortIn(IODevice* dev,
+                           BYTE      addr);
+    static void dataPortOut(IODevice* dev,
+                            BYTE      addr,
+                            BYTE      val);
+
     Computer*            computer_m;
     WD1797*              wd1797_m;
     InterruptController* ic_m;
@@ -9,6 +9,8 @@
 
 #include "computer.h"
 #include "cpu.h"
+#include "GuestProfiler.h"
+#include "InputJournal.h"
 #include "SignalHandler.h"
 #include "WallClock.h"
 #include "logger.h"
@@ -22,6 +24,8 @@
 
 static const int TimerInterval_c = 2000;
 
+H89Timer*        H89Timer::unthrottled_m = nullptr;
+
 
 H89Timer::H89Timer(Computer*     computer,
                    CPU*          cpu,
@@ -41,20 +45,26 @@ H89Timer::H89Timer(Computer*     computer,
 
     SignalHandler::instance()->registerHandler(SIGALRM, this);
     GppListener::addListener(this);
+
+    if (InputJournal::active())
+    {
+        InputJournal::active()->setTimer(this);
+    }
 }
 
 
 H89Timer::~H89Timer()
 {
-    static struct itimerval tim;
-
     debugss(ssTimer, INFO, "\n");
 
     SignalHandler::instance()->removeHandler(SIGALRM);
 
-    tim.it_value.tv_sec  = 0;
-    tim.it_value.tv_usec = 0;
-    setitimer(ITIMER_REAL, &tim, nullptr);
+    if (unthrottled_m == this)
+    {
+        unthrottled_m = nullptr;
+    }
+
+    setTimer(0);
 }
 
 void
@@ -67,23 +77,73 @@ H89Timer::reset()
 void
 H89Timer::start()
 {
-    static struct itimerval tim;
+    thread = pthread_self();
 
-    thread                   = pthread_self();
+    // when replaying, the journal supplies the ticks until it runs out.
+    if (InputJournal::active() && InputJournal::active()->replaying())
+    {
+        return;
+    }
 
-    tim.it_value.tv_sec      = 0;
-    tim.it_value.tv_usec     = TimerInterval_c;
+    // unthrottled, the CPU supplies them.
+    if (unthrottled_m == this)
+    {
+        return;
+    }
 
-    tim.it_interval.tv_sec   = 0;
-    tim.it_interval.tv_usec  = TimerInterval_c;
+    setTimer(TimerInterval_c);
+}
+
+bool
+H89Timer::setThrottle(bool on)
+{
+    if (on)
+    {
+        if (unthrottled_m == this)
+        {
+            unthrottled_m = nullptr;
+
+            if (thread != 0)
+            {
+                setTimer(TimerInterval_c);
+            }
+        }
+
+        return true;
+    }
+
+    // the journal must see every tick.
+    if (InputJournal::active())
+    {
+        debugss(ssTimer, ERROR, "unable to run unthrottled with a journal\n");
+        return false;
+    }
+
+    unthrottled_m = this;
+    setTimer(0);
+
+    return true;
+}
+
+///
+/// interval in uSec, 0 stops the timer.
+///
+void
+H89Timer::setTimer(int interval)
+{
+    static struct itimerval tim;
 
 #if TEN_X_SLOWER
-    tim.it_value.tv_usec    *= 20;
-    tim.it_interval.tv_usec *= 20;
+    interval                *= 20;
 #endif
 
-    setitimer(ITIMER_REAL, &tim, nullptr);
+    tim.it_value.tv_sec      = 0;
+    tim.it_value.tv_usec     = interval;
+
+    tim.it_interval.tv_sec   = 0;
+    tim.it_interval.tv_usec  = interval;
 
+    setitimer(ITIMER_REAL, &tim, nullptr);
 }
 
 int
@@ -109,8 +169,25 @@ H89Timer::handleSignal(int signum)
         return 0;
     }
 
+    if (InputJournal::active())
+    {
+        // applied between instructions.
+        InputJournal::active()->timerSignal();
+        return 0;
+    }
+
+    tick();
+
+    return 0;
+}
+
+void
+H89Timer::tick()
+{
     count_m++;
 
+    GuestProfiler::timerTick();
+
     WallClock::instance()->addTimerEvent();
 
     if (cpu_m)
@@ -132,8 +209,6 @@ H89Timer::handleSignal(int signum)
     {
         debugss(ssTimer, ERROR, "cpu_m is NULL\n");
     }
-
-    return 0;
 }
 
 void
@@ -38,8 +38,27 @@ class H89Timer: public EventHandler, public GppListener
     void reset();
     void start();
 
+    /// off stops the host timer, and the CPU ticks this timer itself whenever a
+    /// period's cycles have been used up, so the guest runs as fast as the host
+    /// allows with the guest's time still advancing per cycle. Refused (false)
+    /// while an InputJournal is active.
+    bool setThrottle(bool on);
+
+    /// the timer to tick when the CPU runs out of cycles, nullptr when throttled.
+    static inline H89Timer* unthrottled()
+    {
+        return unthrottled_m;
+    }
+
+    /// one timer period: add the CPU's cycles and raise the interrupt, if enabled.
+    void tick();
+
   private:
     virtual void gppNewValue(BYTE gpo) override;
+    void setTimer(int interval);
+
+    static H89Timer*  unthrottled_m;
+
     static const BYTE h89timer_gpp2msIntEnBit_c = 0b00000010;
     Computer*         computer_m;
     CPU*              cpu_m;
@@ -68,6 +68,7 @@ setDebugLevel()
     debugLevel[ssHostFileBdos]           = defaultLevel;
     debugLevel[ssCPNetDevice]            = defaultLevel;
     debugLevel[ssSectorFloppyImage]      = defaultLevel;
+    debugLevel[ssHostIO]                 = defaultLevel; // Host I/O thread and serial bridges
 }
 
 void
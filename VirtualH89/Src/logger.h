@@ -70,6 +70,7 @@ enum subSystems
     ssHostFileBdos,
     ssCPNetDevice,
     ssSectorFloppyImage,
+    ssHostIO,
     ssMax
 };
 
@@ -16,6 +16,10 @@
 #include "h19.h"
 #include "StdioConsole.h"
 #include "StdioProxyConsole.h"
+#include "OperatorServer.h"
+#include "DiskImageCache.h"
+#include "InputJournal.h"
+#include "WorkloadScript.h"
 #include "logger.h"
 #include "propertyutil.h"
 
@@ -121,11 +125,12 @@ cpuThreadFunc(void* v)
 // Right now, it must be manually kept up to date.
 //
 //	option		owner
+//	-f		StdioProxyConsole.cpp
 //	-g <gui>	main.cpp
 //	-l		StdioProxyConsole.cpp
 //	-q		main.cpp
 //
-const char* getopts = "g:lq";
+const char* getopts = "fg:lq";
 
 #if defined(__GUIwx__)
 int
@@ -242,8 +247,20 @@ main(int   argc,
         console = new H19(sw401.c_str(), sw402.c_str());
     }
 
+    // must be set before any media is mounted.
+    DiskImageCache::setCacheDir(props["image_cache"]);
+
+    // must be installed first, the devices register with it as they are built.
+    InputJournal::install_InputJournal(props);
+
     h89.buildSystem(console, props);
 
+    // optional control socket, in addition to any console's command channel.
+    OperatorServer::install_OperatorServer(props);
+
+    // optional scripted session on the console, for benchmarks.
+    WorkloadScript::install_WorkloadScript(props, console);
+
     pthread_t cpuThread;
     pthread_create(&cpuThread, nullptr, cpuThreadFunc, &h89);
     h89.init();
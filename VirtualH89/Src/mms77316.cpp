@@ -109,6 +109,8 @@ MMS77316::install_MMS77316(InterruptController*        ic,
     std::string                        s;
     MMS77316*                          m316 = new MMS77316(BasePort_c, ic);
 
+    m316->wd1797_m->setTurbo(props["mms77316_turbo"] == "yes");
+
     // First identify what drives are installed.
     for (int x = 0; x < numDisks_c; ++x)
     {
@@ -192,22 +194,7 @@ MMS77316::in(BYTE addr)
         offset -= Wd1797_Offset_c;
         if (offset == WD1797::DataPort_Offset_c)
         {
-            // might need to simulate WAIT states...
-            // Must NOT wait too long - this blocks all other progress.
-            // TODO: redesign this to return to execute() loop and
-            // stall there... requires in() to return a status or
-            // some other way inform the CPU to stall. The MMS77316
-            // has a built-in timeout on the WAIT hardware anyway,
-            // so, insure we don't stay here forever. The hardware
-            // timed out after 16 busclk (2MHz, i.e. CPU clock) cycles,
-            // really should count those but this is probably close enough.
-            int timeout = 0;
-
-            while (burstMode() && !drqRaised_m && !intrqRaised_m && ++timeout < 16)
-            {
-                // TODO: this stalls
-                wd1797_m->waitForData();
-            }
+            waitBurst();
         }
 
         val = wd1797_m->in(offset);
@@ -235,13 +222,7 @@ MMS77316::out(BYTE addr,
 
         if (offset == WD1797::DataPort_Offset_c)
         {
-            // See notes for MMS77316::in()...
-            int timeout = 0;
-
-            while (burstMode() && !drqRaised_m && !intrqRaised_m && ++timeout < 16)
-            {
-                wd1797_m->waitForData();
-            }
+            waitBurst();
         }
 
         wd1797_m->out(offset, val);
@@ -278,6 +259,80 @@ MMS77316::out(BYTE addr,
     }
 }
 
+///
+/// In burst mode, the data port holds the CPU until the WD1797 has the next byte.
+///
+void
+MMS77316::waitBurst()
+{
+    // might need to simulate WAIT states...
+    // Must NOT wait too long - this blocks all other progress.
+    // TODO: redesign this to return to execute() loop and
+    // stall there... requires in() to return a status or
+    // some other way inform the CPU to stall. The MMS77316
+    // has a built-in timeout on the WAIT hardware anyway,
+    // so, insure we don't stay here forever. The hardware
+    // timed out after 16 busclk (2MHz, i.e. CPU clock) cycles,
+    // really should count those but this is probably close enough.
+    int timeout = 0;
+
+    while (burstMode() && !drqRaised_m && !intrqRaised_m && ++timeout < 16)
+    {
+        // TODO: this stalls
+        wd1797_m->waitForData();
+    }
+}
+
+///
+/// Port handlers for the WD1797 registers polled during every transfer.
+///
+BYTE
+MMS77316::statusPortIn(IODevice* dev,
+                       BYTE      addr)
+{
+    return static_cast<MMS77316*>(dev)->wd1797_m->statusIn();
+}
+
+BYTE
+MMS77316::dataPortIn(IODevice* dev,
+                     BYTE      addr)
+{
+    MMS77316* mms = static_cast<MMS77316*>(dev);
+
+    mms->waitBurst();
+
+    return mms->wd1797_m->dataIn();
+}
+
+void
+MMS77316::dataPortOut(IODevice* dev,
+                      BYTE      addr,
+                      BYTE      val)
+{
+    MMS77316* mms = static_cast<MMS77316*>(dev);
+
+    mms->waitBurst();
+    mms->wd1797_m->dataOut(val);
+}
+
+void
+MMS77316::getPortHandlers(BYTE        offset,
+                          InHandler&  in,
+                          OutHandler& out)
+{
+    switch (offset)
+    {
+        case Wd1797_Offset_c + WD1797::StatusPort_Offset_c:
+            in = statusPortIn;
+            break;
+
+        case Wd1797_Offset_c + WD1797::DataPort_Offset_c:
+            in  = dataPortIn;
+            out = dataPortOut;
+            break;
+    }
+}
+
 GenericFloppyDrive*
 MMS77316::getDrive(BYTE unitNum)
 {
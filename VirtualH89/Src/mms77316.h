@@ -41,6 +41,9 @@ class MMS77316: public DiskController, public WD179xUserIf
     virtual BYTE in(BYTE addr) override;
     virtual void out(BYTE addr,
                      BYTE val) override;
+    virtual void getPortHandlers(BYTE        offset,
+                                 InHandler&  in,
+                                 OutHandler& out) override;
 
     virtual bool connectDrive(BYTE                unitNum,
                               GenericFloppyDrive* drive);
@@ -73,6 +76,16 @@ class MMS77316: public DiskController, public WD179xUserIf
     void lowerIntrq() override;
     void lowerDrq() override;
 
+    void waitBurst();
+
+    static BYTE statusPortIn(IODevice* dev,
+                             BYTE      addr);
+    static BYTE dataPortIn(IODevice* dev,
+                           BYTE      addr);
+    static void dataPortOut(IODevice* dev,
+                            BYTE      addr,
+                            BYTE      val);
+
     static const BYTE    MMS77316_NumPorts_c  = 8;
 
     static const BYTE    BasePort_c           = 0x38;
@@ -162,7 +162,8 @@ MMS77320::install_MMS77320(PropertyUtil::PropertyMapT& props,
         if (!s.empty())
         {
             // TODO: handle removable media case...
-            m320->connectDrive(x, GenericSASIDrive::getInstance(s, media, x));
+            m320->connectDrive(x, GenericSASIDrive::getInstance(PropertyUtil::splitArgs(s), media,
+                                                                 x));
         }
     }
 
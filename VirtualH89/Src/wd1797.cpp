@@ -61,7 +61,8 @@ WD1797::WD1797(int baseAddr): ClockUser(),
                               cycleCount_m(0),
                               formattingState_m(fs_none),
                               doubleDensity_m(false),
-                              immediateInterruptSet_m(false)
+                              immediateInterruptSet_m(false),
+                              turbo_m(false)
 {
 
 }
@@ -124,14 +125,7 @@ WD1797::in(BYTE addr)
     switch (offset)
     {
         case StatusPort_Offset_c:
-            debugss(ssWD1797, INFO, "(StatusPort) (0x%02x) trk=%d sec=%d dat=0x%02x\n",
-                    statusReg_m, trackReg_m, sectorReg_m, dataReg_m);
-
-            val = statusReg_m;
-            if (!immediateInterruptSet_m)
-            {
-                lowerIntrq();
-            }
+            val = statusIn();
             break;
 
         case TrackPort_Offset_c:
@@ -145,12 +139,7 @@ WD1797::in(BYTE addr)
             break;
 
         case DataPort_Offset_c:
-            // TODO - should this check dataReady_m first?
-            debugss(ssWD1797, VERBOSE, "(DataPort) - %d\n", dataReg_m);
-            val          = dataReg_m;
-            dataReady_m  = false;
-            statusReg_m &= ~stat_DataRequest_c;
-            lowerDrq();
+            val = dataIn();
             break;
 
         default:
@@ -162,6 +151,52 @@ WD1797::in(BYTE addr)
     return (val);
 }
 
+///
+/// The registers polled during every transfer, also called directly by the
+/// controllers' port handlers.
+///
+BYTE
+WD1797::statusIn()
+{
+    debugss(ssWD1797, INFO, "(StatusPort) (0x%02x) trk=%d sec=%d dat=0x%02x\n",
+            statusReg_m, trackReg_m, sectorReg_m, dataReg_m);
+
+    BYTE val = statusReg_m;
+
+    if (!immediateInterruptSet_m)
+    {
+        lowerIntrq();
+    }
+
+    return val;
+}
+
+BYTE
+WD1797::dataIn()
+{
+    BYTE val = dataReg_m;
+
+    // TODO - should this check dataReady_m first?
+    debugss(ssWD1797, VERBOSE, "(DataPort) - %d\n", dataReg_m);
+    dataReady_m  = false;
+    statusReg_m &= ~stat_DataRequest_c;
+    lowerDrq();
+
+    return val;
+}
+
+void
+WD1797::dataOut(BYTE val)
+{
+    debugss(ssWD1797, INFO, "(DataPort): %02x\n", val);
+
+    // unpredictable results if !dataReady_m... (data changed while being written).
+    // other mechanisms detect lostData, which is different.
+    dataReg_m   = val;
+    dataReady_m = true;
+    lowerDrq();
+}
+
 void
 WD1797::out(BYTE addr,
             BYTE val)
@@ -193,13 +228,7 @@ WD1797::out(BYTE addr,
             break;
 
         case DataPort_Offset_c:
-            debugss(ssWD1797, INFO, "(DataPort): %02x\n", val);
-
-            // unpredictable results if !dataReady_m... (data changed while being written).
-            // other mechanisms detect lostData, which is different.
-            dataReg_m   = val;
-            dataReady_m = true;
-            lowerDrq();
+            dataOut(val);
             break;
 
         default:
@@ -711,7 +740,7 @@ WD1797::cmdTypeI_Notification(unsigned int cycleCount)
                         currentDrive_m->step(false);
                     }
 
-                    stepSettle_m = HeadSettleTimeInTicks_c;
+                    stepSettle_m = stepTicks();
                 }
                 else
                 {
@@ -734,7 +763,7 @@ WD1797::cmdTypeI_Notification(unsigned int cycleCount)
                     currentDrive_m->step(dir);
                 }
                 trackReg_m  += (dir ? 1 : -1);
-                stepSettle_m = HeadSettleTimeInTicks_c;
+                stepSettle_m = stepTicks();
             }
             else
             {
@@ -771,7 +800,7 @@ WD1797::cmdTypeI_Notification(unsigned int cycleCount)
                         currentDrive_m->step(false);
                     }
 
-                    stepSettle_m = HeadSettleTimeInTicks_c;
+                    stepSettle_m = stepTicks();
 
                     if (stepUpdate_m)
                     {
@@ -787,7 +816,7 @@ WD1797::cmdTypeI_Notification(unsigned int cycleCount)
                     currentDrive_m->step(true);
                 }
                 statusReg_m &= ~stat_TrackZero_c;
-                stepSettle_m = HeadSettleTimeInTicks_c;
+                stepSettle_m = stepTicks();
 
                 if (stepUpdate_m)
                 {
@@ -877,15 +906,11 @@ WD1797::cmdTypeII_Notification(unsigned int cycleCount)
         return;
     }
 
-    unsigned long charPos = currentDrive_m->getCharPos(doubleDensity_m);
-
-    if (charPos == curPos_m)
+    if (!nextCharPos())
     {
         // Position hasn't changed just return
         return;
     }
-    debugss(ssWD1797, ALL, "New character Pos - old: %ld, new: %ld\n", curPos_m, charPos);
-    curPos_m = charPos;
 
     int data;
     int result;
@@ -1100,17 +1125,12 @@ WD1797::cmdTypeIII_Notification(unsigned int cycleCount)
         return;
     }
 
-    unsigned long charPos = currentDrive_m->getCharPos(doubleDensity_m);
-
-    if (charPos == curPos_m)
+    if (!nextCharPos())
     {
         // Position hasn't changed just return
         return;
     }
 
-    debugss(ssWD1797, ALL, "New character Pos - old: %ld, new: %ld\n", curPos_m, charPos);
-    curPos_m = charPos;
-
     int data;
     int result;
 
@@ -1362,6 +1382,48 @@ WD1797::setDoubleDensity(bool dd)
     doubleDensity_m = dd;
 }
 
+void
+WD1797::setTurbo(bool turbo)
+{
+    debugss(ssWD1797, INFO, "turbo: %d\n", turbo);
+    turbo_m = turbo;
+}
+
+///
+/// Returns true when the disk has moved on to the next byte. In turbo mode it
+/// doesn't have to wait for that, just for the host to take the last byte read.
+/// While the host is behind, real byte times are still used, so lost data is
+/// detected after the same delay as without turbo.
+///
+bool
+WD1797::nextCharPos()
+{
+    unsigned long charPos = currentDrive_m->getCharPos(doubleDensity_m);
+
+    if (charPos != curPos_m)
+    {
+        debugss(ssWD1797, ALL, "New character Pos - old: %ld, new: %ld\n", curPos_m, charPos);
+        curPos_m = charPos;
+        return true;
+    }
+
+    if (!turbo_m)
+    {
+        return false;
+    }
+
+    // writes already wait for the host, the drive returns NO_DATA until it
+    // supplies the byte.
+    return (!dataReady_m || curCommand_m == writeSectorCmd || curCommand_m == writeTrackCmd);
+}
+
+/// time between steps of a type I command.
+unsigned long
+WD1797::stepTicks()
+{
+    return (turbo_m ? 0 : HeadSettleTimeInTicks_c);
+}
+
 unsigned long
 WD1797::millisecToTicks(unsigned long ms)
 {
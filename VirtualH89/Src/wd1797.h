@@ -33,6 +33,10 @@ class WD1797: public ClockUser
     virtual void out(BYTE addr,
                      BYTE val);
 
+    BYTE statusIn();
+    BYTE dataIn();
+    void dataOut(BYTE val);
+
     virtual void setCurrentDrive(GenericFloppyDrive* drive);
 
     virtual void reset(void);
@@ -52,6 +56,9 @@ class WD1797: public ClockUser
 
     void setDoubleDensity(bool dd);
 
+    /// skip rotational and stepping delays, transfers then only wait on the host.
+    void setTurbo(bool turbo);
+
   protected:
     WD1797(int baseAddr = 0);
     BYTE              basePort_m;
@@ -356,8 +363,11 @@ class WD1797: public ClockUser
 
     bool            doubleDensity_m;
     bool            immediateInterruptSet_m;
+    bool            turbo_m;
 
     void updateStatusTypeI(GenericFloppyDrive* drive);
+    bool nextCharPos();
+    unsigned long stepTicks();
     void transferData(int data);
     // bool checkAddr(BYTE addr[6]);
     // int  sectorLen(BYTE addr[6]);
@@ -15,6 +15,8 @@
 #include "WallClock.h"
 #include "disasm.h"
 #include "IOBus.h"
+#include "h89-timer.h"
+#include "InputJournal.h"
 #include "propertyutil.h"
 
 #include "config.h"
@@ -22,6 +24,7 @@
 /// \cond
 #include <ctime>
 #include <cassert>
+#include <string.h>
 #include <strings.h>
 #include <unistd.h>
 /// \endcond
@@ -1449,9 +1452,11 @@ Z80::Z80(Computer* computer,
                                     curInstByte(0),
                                     mode(cm_reset),
                                     prefix(ip_none),
+                                    IM(0),
                                     speedUpFactor_m(40),
                                     fast_m(false),
-                                    IM(0)
+                                    trapLow_m(0xffff),
+                                    trapHigh_m(0)
 
 {
     debugss(ssZ80, INFO, "Creating Z80 proc, clock (%d), ticks(%d)\n", clockRate, ticksPerSecond);
@@ -1473,6 +1478,7 @@ Z80::Z80(Computer* computer,
 
     WallClock::instance()->updateTicksPerSecond(ClockRate_m);
 
+    clearStats();
     reset();
 
 }
@@ -1549,6 +1555,201 @@ Z80::enableFast() {
     GppListener::addListener(this);
 }
 
+void
+Z80::addTrap(WORD     addr,
+             CPUTrap* trap)
+{
+    traps_m[addr] = trap;
+
+    if (addr < trapLow_m)
+    {
+        trapLow_m = addr;
+    }
+
+    if (addr > trapHigh_m)
+    {
+        trapHigh_m = addr;
+    }
+}
+
+///
+/// \brief Run the host handler for the current PC, if there is one.
+///
+/// \retval true if the handler took the place of the instruction.
+///
+bool
+Z80::runTrap()
+{
+    std::map<WORD, CPUTrap*>::iterator it = traps_m.find(PC);
+
+    if (it == traps_m.end())
+    {
+        return false;
+    }
+
+    CPUTrap::Registers regs   = {AF, BC, DE, HL, SP, PC};
+    unsigned int       cycles = 0;
+
+    if (!it->second->trap(regs, cycles))
+    {
+        return false;
+    }
+
+    AF             = regs.af;
+    BC             = regs.bc;
+    DE             = regs.de;
+    HL             = regs.hl;
+    SP             = regs.sp;
+    PC             = regs.pc;
+
+    ticks         -= cycles;
+    lastInstTicks  = ticks;
+    WallClock::instance()->addTicks(cycles);
+
+    return true;
+}
+
+WORD
+Z80::getPC(void)
+{
+    return PC;
+}
+
+#if Z80_STATS
+///
+/// \retval length of the instruction, if op is a conditional jump, call or return
+///         or a repeating block instruction, which is taken when it doesn't
+///         continue with the next instruction. Otherwise 0.
+///
+WORD
+Z80::branchLength(OpSpace space,
+                  BYTE    op)
+{
+    if (space == os_base)
+    {
+        if ((op & 0xc7) == 0xc0)
+        {
+            // RET cc
+            return 1;
+        }
+
+        if ((op & 0xc7) == 0xc2 || (op & 0xc7) == 0xc4)
+        {
+            // JP cc and CALL cc
+            return 3;
+        }
+
+        if ((op & 0xe7) == 0x20 || op == 0x10)
+        {
+            // JR cc and DJNZ
+            return 2;
+        }
+    }
+    else if (space == os_ed && (op & 0xf4) == 0xb0)
+    {
+        // LDIR, CPIR, INIR, OTIR, LDDR, CPDR, INDR and OTDR
+        return 2;
+    }
+
+    return 0;
+}
+
+void
+Z80::countInstruction(WORD         startPC,
+                      unsigned int cycles)
+{
+    OpSpace space = os_base;
+    BYTE    op    = curInst[0];
+
+    switch (op)
+    {
+        case 0xcb:
+            space = os_cb;
+            op    = curInst[1];
+            break;
+
+        case 0xed:
+            space = os_ed;
+            op    = curInst[1];
+            break;
+
+        case 0xdd:
+        case 0xfd:
+            if (curInst[1] == 0xcb)
+            {
+                space = (op == 0xdd) ? os_ddcb : os_fdcb;
+                op    = curInst[3];
+            }
+            else
+            {
+                space = (op == 0xdd) ? os_dd : os_fd;
+                op    = curInst[1];
+            }
+
+            break;
+    }
+
+    OpStats& stats = opStats_m[space][op];
+    WORD     len   = branchLength(space, op);
+
+    stats.count++;
+    stats.cycles += cycles;
+
+    if (len != 0 && PC != (WORD) (startPC + len))
+    {
+        stats.taken++;
+    }
+}
+#endif
+
+std::string
+Z80::dumpStats()
+{
+    std::string csv;
+
+#if Z80_STATS
+    static const char* spaces[os_num] = {"base", "cb", "ed", "dd", "fd", "ddcb", "fdcb"};
+
+    csv = "space,opcode,count,cycles,taken,not_taken\n";
+
+    for (int space = 0; space < os_num; ++space)
+    {
+        for (int op = 0; op < 256; ++op)
+        {
+            OpStats& stats = opStats_m[space][op];
+
+            if (stats.count == 0)
+            {
+                continue;
+            }
+
+            csv += PropertyUtil::sprintf("%s,%02x,%llu,%llu", spaces[space], op,
+                                         stats.count, stats.cycles);
+
+            if (branchLength((OpSpace) space, op) != 0)
+            {
+                csv += PropertyUtil::sprintf(",%llu,%llu\n", stats.taken,
+                                             stats.count - stats.taken);
+            }
+            else
+            {
+                csv += ",,\n";
+            }
+        }
+    }
+#endif
+
+    return csv;
+}
+
+void
+Z80::clearStats(void)
+{
+#if Z80_STATS
+    memset(opStats_m, 0, sizeof(opStats_m));
+#endif
+}
+
 void
 Z80::gppNewValue(BYTE gpo) {
     fast_m = ((gpo & z80_gppSpeedSelBit_c) != 0);
@@ -1630,6 +1831,16 @@ Z80::waitState(void)
     // TODO: anything else needs to make progress?
 }
 
+///
+/// Stalls the CPU for the given number of clock cycles, charged to the
+/// current instruction (e.g. a device holding the bus for a DMA transfer).
+///
+void
+Z80::addWaitStates(unsigned int cycles)
+{
+    ticks -= cycles;
+}
+
 ///
 /// Links the address bus object to the virtual CPU.
 ///
@@ -1851,6 +2062,24 @@ Z80::execute(WORD numInst)
         // check to see if the clock has any ticks left
         if (ticks <= 0)
         {
+            InputJournal* journal = InputJournal::active();
+
+            // the journal being replayed has the next tick, no need to wait for it.
+            if (journal && journal->replaying())
+            {
+                journal->idle();
+                continue;
+            }
+
+            // unthrottled, the next tick is due as soon as this one's cycles are used.
+            H89Timer* timer = H89Timer::unthrottled();
+
+            if (timer)
+            {
+                timer->tick();
+                continue;
+            }
+
             // No virtual time left in this timer tick, wait for the next one.
             static struct timespec sp;
             static struct timespec act;
@@ -1862,6 +2091,12 @@ Z80::execute(WORD numInst)
             computer_m->systemMutexRelease();
             nanosleep(&sp, &act);
             computer_m->systemMutexAcquire();
+
+            if (journal)
+            {
+                journal->idle();
+            }
+
             continue;
         }
 
@@ -1877,12 +2112,20 @@ Z80::execute(WORD numInst)
             continue;
         }
 
-
-        lastInstByte  = curInst[0] = readInst();
-        (this->*op_code[curInst[0]])();
-        unsigned int val = lastInstTicks - ticks;
-        lastInstTicks = ticks;
-        WallClock::instance()->addTicks(val);
+        if (PC < trapLow_m || PC > trapHigh_m || processingIntr || !runTrap())
+        {
+#if Z80_STATS
+            WORD startPC = PC;
+#endif
+            lastInstByte  = curInst[0] = readInst();
+            (this->*op_code[curInst[0]])();
+            unsigned int val = lastInstTicks - ticks;
+            lastInstTicks = ticks;
+#if Z80_STATS
+            countInstruction(startPC, val);
+#endif
+            WallClock::instance()->addTicks(val);
+        }
 
 
 #ifdef WANT_GUI
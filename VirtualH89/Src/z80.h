@@ -15,9 +15,11 @@
 
 #include "cpu.h"
 #include "GppListener.h"
+#include "config.h"
 
 /// \cond
 #include <csignal>
+#include <map>
 #include <pthread.h>
 /// \endcond
 
@@ -198,6 +200,7 @@ class Z80: public CPU, public GppListener
 
     virtual void continueRunning(void) override;
     virtual void waitState(void) override;
+    virtual void addWaitStates(unsigned int cycles) override;
 
     virtual void reset(void) override;
 
@@ -210,6 +213,11 @@ class Z80: public CPU, public GppListener
     virtual void setIOBus(IOBus* io) override;
     virtual void setSpeedup(int factor) override;
     virtual void enableFast() override;
+    virtual void addTrap(WORD     addr,
+                         CPUTrap* trap) override;
+    virtual WORD getPC(void) override;
+    virtual std::string dumpStats() override;
+    virtual void clearStats(void) override;
 
     virtual void raiseINT() override;
     virtual void lowerINT() override;
@@ -334,6 +342,45 @@ class Z80: public CPU, public GppListener
     unsigned int speedUpFactor_m;
     bool         fast_m;
 
+    /// ROM routines handled by the host, keyed by entry point. The bounds keep
+    /// the check cheap for the (common) PC outside all of them.
+    std::map<WORD, CPUTrap*> traps_m;
+    WORD                     trapLow_m;
+    WORD                     trapHigh_m;
+
+    bool runTrap(void);
+
+#if Z80_STATS
+    /// opcode tables, DD CB and FD CB instructions are counted by their last byte.
+    enum OpSpace
+    {
+        os_base,
+        os_cb,
+        os_ed,
+        os_dd,
+        os_fd,
+        os_ddcb,
+        os_fdcb,
+        os_num
+    };
+
+    struct OpStats
+    {
+        unsigned long long count;
+        unsigned long long cycles;
+        /// only for conditional jumps, calls, returns and the repeating block
+        /// instructions.
+        unsigned long long taken;
+    };
+
+    OpStats opStats_m[os_num][256];
+
+    void countInstruction(WORD         startPC,
+                          unsigned int cycles);
+    static WORD branchLength(OpSpace space,
+                             BYTE    op);
+#endif
+
     // -------------------------
     //
     // generic routines (i.e. multiple opcodes call them )